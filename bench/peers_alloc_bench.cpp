@@ -0,0 +1,192 @@
+/**
+ *
+ *  @file peers_alloc_bench.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.
+ *  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+// Heap allocations per GET /peers request, server side. The routes are
+// served on the admin socket and a client in the same process calls them;
+// operator new is counted on every thread but the client's. A window of
+// the same length without requests is measured after each run and
+// subtracted, so node and ticker activity do not show up as request cost.
+//
+// Run:
+//   p2p_http_peers_alloc_bench [peers] [requests] [runtimes] [base_port]
+//
+// Defaults: 64 2000 1 9400. The runtime nodes listen on base_port.. and
+// the target nodes they connect to on the ports after them. Each query is
+// run uncached (peers_cache_ttl_ms = 0), so every request rebuilds rows.
+
+#include "detail/ScratchArena.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/p2p/Node.hpp>
+#include <vix/p2p/P2P.hpp>
+#include <vix/p2p_http/P2PHttp.hpp>
+#include <vix/p2p_http/P2PHttpClient.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+  std::atomic<std::uint64_t> g_allocs{0};
+  thread_local bool t_uncounted = false;
+
+  void *counted_alloc(std::size_t n)
+  {
+    if (!t_uncounted)
+      g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1))
+      return p;
+    throw std::bad_alloc();
+  }
+}
+
+void *operator new(std::size_t n) { return counted_alloc(n); }
+void *operator new[](std::size_t n) { return counted_alloc(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+  struct Args
+  {
+    std::size_t peers = 64;
+    std::size_t requests = 2000;
+    std::size_t runtimes = 1;
+    int base_port = 9400;
+  };
+
+  std::shared_ptr<vix::p2p::Node> make_node(const std::string &id, int port)
+  {
+    vix::p2p::NodeConfig cfg;
+    cfg.node_id = id;
+    cfg.listen_port = static_cast<std::uint16_t>(port);
+    cfg.on_log = [](std::string_view) {};
+    return vix::p2p::make_tcp_node(cfg);
+  }
+
+  // Server-side allocations per request for `target`, idle noise removed.
+  void run(vix::p2p_http::P2PHttpClient &client, const char *target, std::size_t requests)
+  {
+    // Warm the connection and the worker's arena block.
+    for (int i = 0; i < 8; ++i)
+      client.request("GET", target);
+
+    const auto idle_a = g_allocs.load();
+    const auto t0 = std::chrono::steady_clock::now();
+    std::size_t bytes = 0;
+    int status = 0;
+    for (std::size_t i = 0; i < requests; ++i)
+    {
+      const auto r = client.request("GET", target);
+      bytes = r.body.size();
+      status = r.status;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - t0;
+    const auto busy = g_allocs.load() - idle_a;
+
+    const auto idle_b = g_allocs.load();
+    std::this_thread::sleep_for(elapsed);
+    const auto idle = g_allocs.load() - idle_b;
+
+    const double per_req = ((double)busy - (double)idle) / (double)requests;
+    std::printf("%-22s %3d %9zu B  %8.2f allocs/request  (%llu idle)\n",
+                target, status, bytes, per_req, (unsigned long long)idle);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  t_uncounted = true;
+
+  Args a;
+  if (argc > 1)
+    a.peers = std::strtoull(argv[1], nullptr, 10);
+  if (argc > 2)
+    a.requests = std::strtoull(argv[2], nullptr, 10);
+  if (argc > 3)
+    a.runtimes = std::max<std::size_t>(1, std::strtoull(argv[3], nullptr, 10));
+  if (argc > 4)
+    a.base_port = std::atoi(argv[4]);
+
+  std::vector<std::unique_ptr<vix::p2p::P2PRuntime>> runtimes;
+  std::vector<vix::p2p_http::NamedRuntime> named;
+  for (std::size_t i = 0; i < a.runtimes; ++i)
+  {
+    auto node = make_node("bench-rt" + std::to_string(i), a.base_port + (int)i);
+    runtimes.push_back(std::make_unique<vix::p2p::P2PRuntime>(node));
+    runtimes.back()->start();
+    named.push_back({a.runtimes > 1 ? "rt" + std::to_string(i) : "", runtimes.back().get()});
+  }
+
+  std::vector<std::unique_ptr<vix::p2p::P2PRuntime>> targets;
+  for (std::size_t i = 0; i < a.peers; ++i)
+  {
+    const int port = a.base_port + (int)a.runtimes + (int)i;
+    targets.push_back(std::make_unique<vix::p2p::P2PRuntime>(make_node("bench-peer" + std::to_string(i), port)));
+    targets.back()->start();
+
+    vix::p2p::PeerEndpoint ep;
+    ep.host = "127.0.0.1";
+    ep.port = static_cast<std::uint16_t>(port);
+    ep.scheme = "tcp";
+    runtimes[i % a.runtimes]->node()->connect(ep);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  const std::string sock = "/tmp/p2p_http_peers_alloc_bench." + std::to_string(::getpid()) + ".sock";
+
+  vix::p2p_http::P2PHttpOptions opt;
+  opt.admin_socket_path = sock;
+  opt.admin_socket_threads = 1;
+  opt.stats_every_ms = 60000;
+  opt.enable_live_logs = false;
+
+  vix::App app;
+  vix::p2p_http::registerRuntimes(app, named, opt);
+
+  vix::p2p_http::ClientOptions copt;
+  copt.unix_socket = sock;
+  vix::p2p_http::P2PHttpClient client(copt);
+
+  std::printf("%zu peers over %zu runtime(s), %zu requests per query\n",
+              a.peers, a.runtimes, a.requests);
+
+  const auto spills0 = vix::p2p_http::detail::scratch_spills();
+  run(client, "/peers", a.requests);
+  run(client, "/peers?compact=1", a.requests);
+  run(client, "/peers?state=connected", a.requests);
+  run(client, "/peers.arrow", a.requests);
+  std::printf("arena spills: %llu\n",
+              (unsigned long long)(vix::p2p_http::detail::scratch_spills() - spills0));
+
+  for (auto &t : targets)
+    t->stop();
+  for (auto &rt : runtimes)
+    rt->stop();
+  vix::p2p_http::shutdown_live_logs();
+  return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ *
+ *  @file peers_body_dump.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.
+ *  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+// Writes the GET /peers and GET /peers?compact=1 bodies of a synthetic
+// peer table, so the two layouts can be compared without a live mesh.
+// Rows look like a settled node: connected tcp peers with a finished
+// handshake and 32-byte keys.
+//
+// Run:
+//   p2p_http_peers_body_dump [peers] [dir]
+//   python3 bench/peers_compact_loads.py [dir]
+//
+// Defaults: 2000 /tmp. Writes {dir}/peers.json and {dir}/peers_compact.json.
+
+#include "detail/Interner.hpp"
+#include "detail/PeerIndex.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace vix::p2p_http::detail;
+
+namespace
+{
+  PeerRows synthetic_rows(std::size_t n)
+  {
+    auto &names = interner();
+    const Symbol tcp = names.intern("tcp");
+
+    PeerRows rows;
+    rows.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      char id[40];
+      std::snprintf(id, sizeof(id), "%016llx%016llx",
+                    (unsigned long long)(i * 0x9E3779B97F4A7C15ull),
+                    (unsigned long long)(i + 1));
+      char host[24];
+      std::snprintf(host, sizeof(host), "10.0.%zu.%zu", (i / 250) % 256, i % 250 + 1);
+
+      PeerRow &r = rows.emplace_back();
+      r.peer_id = names.intern(id);
+      r.state = vix::p2p::PeerState::Connected;
+      r.has_endpoint = true;
+      r.scheme = tcp;
+      r.host = names.intern(host);
+      r.port = static_cast<std::uint16_t>(9000 + i % 1000);
+      r.secure = true;
+      r.capabilities_count = 3;
+      r.public_key_fp = std::string(id, 8) + "..(32)";
+      r.session_key_fp = std::string(id + 8, 8) + "..(32)";
+      r.last_seen_ms_ago = (long long)(i * 37 % 5000);
+      r.has_handshake = true;
+      r.handshake_stage = vix::p2p::HandshakeState::Stage::Finished;
+      r.handshake_age_ms = (long long)(60000 + i * 13 % 10000);
+      r.nonce_a = (long long)(i * 0x5851F42D4C957F2Dull >> 1);
+      r.nonce_b = (long long)(i * 0x14057B7EF767814Full >> 1);
+      r.ts_ms = 1760000000000ll + (long long)i;
+    }
+    return rows;
+  }
+
+  bool write_file(const std::string &path, const std::string &body)
+  {
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+    {
+      std::perror(path.c_str());
+      return false;
+    }
+    const bool ok = std::fwrite(body.data(), 1, body.size(), f) == body.size();
+    return std::fclose(f) == 0 && ok;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+  const std::string dir = argc > 2 ? argv[2] : "/tmp";
+
+  const PeerRows rows = synthetic_rows(n);
+  const std::string full = peers_body(rows);
+  const std::string compact = peers_body_compact(rows);
+
+  if (!write_file(dir + "/peers.json", full) || !write_file(dir + "/peers_compact.json", compact))
+    return 1;
+
+  std::printf("%zu peers: /peers %zu B, /peers?compact=1 %zu B (%.0f%%)\n",
+              n, full.size(), compact.size(), 100.0 * (double)compact.size() / (double)full.size());
+  return 0;
+}
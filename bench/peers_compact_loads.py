@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+# Body size and json.loads() time of the /peers object and compact layouts.
+#
+# Run:
+#   python3 bench/peers_compact_loads.py [dir] [repeats]
+#   python3 bench/peers_compact_loads.py http://127.0.0.1:8080/p2p [repeats]
+#
+# A directory is read as written by p2p_http_peers_body_dump (peers.json,
+# peers_compact.json). A URL is fetched from a live server instead:
+# {url}/peers and {url}/peers?compact=1. Times are the median of
+# `repeats` parses (default 50).
+
+import json
+import statistics
+import sys
+import time
+import urllib.request
+
+
+def load(source, compact):
+    if source.startswith("http://") or source.startswith("https://"):
+        url = source.rstrip("/") + ("/peers?compact=1" if compact else "/peers")
+        with urllib.request.urlopen(url) as r:
+            return r.read()
+    name = "peers_compact.json" if compact else "peers.json"
+    with open(source.rstrip("/") + "/" + name, "rb") as f:
+        return f.read()
+
+
+def median_loads_ms(body, repeats):
+    times = []
+    for _ in range(repeats):
+        t0 = time.perf_counter()
+        json.loads(body)
+        times.append((time.perf_counter() - t0) * 1000.0)
+    return statistics.median(times)
+
+
+def main():
+    source = sys.argv[1] if len(sys.argv) > 1 else "/tmp"
+    repeats = int(sys.argv[2]) if len(sys.argv) > 2 else 50
+
+    full = load(source, False)
+    compact = load(source, True)
+    rows = len(json.loads(compact)["rows"])
+
+    full_ms = median_loads_ms(full, repeats)
+    compact_ms = median_loads_ms(compact, repeats)
+
+    print(f"{rows} peers, python {sys.version.split()[0]}")
+    print(f"/peers            {len(full) / 1024:8.1f} KB  json.loads {full_ms:6.2f} ms")
+    print(f"/peers?compact=1  {len(compact) / 1024:8.1f} KB  json.loads {compact_ms:6.2f} ms"
+          f"  ({100.0 * len(compact) / len(full):.0f}% of the size)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,130 @@
+/**
+ *
+ *  @file persist_io_bench.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.
+ *  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+// Sustained write throughput and CPU per MB of the persistence backends,
+// driven the way LogFileWriter drives them: slot-sized appends in round
+// robin, with a data sync linked to every Nth batch.
+//
+// Run:
+//   p2p_http_persist_io_bench [dir] [total_mb] [batch_kb] [sync_every_batches]
+//
+// Defaults: /tmp 512 256 16. CPU is user + system time of the whole
+// process, io_uring and pool workers included.
+
+#include "detail/PersistIo.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using vix::p2p_http::detail::make_persist_io;
+using vix::p2p_http::detail::PersistIoKind;
+
+namespace
+{
+  double cpu_seconds()
+  {
+    rusage ru{};
+    ::getrusage(RUSAGE_SELF, &ru);
+    return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 +
+           (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec / 1e6;
+  }
+
+  struct Args
+  {
+    std::string dir = "/tmp";
+    std::size_t total_mb = 512;
+    std::size_t batch_kb = 256;
+    std::size_t sync_every = 16;
+  };
+
+  void run(const Args &a, PersistIoKind kind)
+  {
+    std::string note;
+    auto io = make_persist_io(kind, 4, a.batch_kb * 1024, note);
+
+    const std::string path = a.dir + "/p2p_http_persist_bench." + io->name();
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+      std::perror(path.c_str());
+      std::exit(1);
+    }
+
+    const std::size_t chunk = io->slot_bytes();
+    const std::size_t batches = a.total_mb * 1024 * 1024 / chunk;
+    for (std::size_t s = 0; s < io->slots(); ++s)
+      std::memset(io->slot_data(s), 'x', chunk);
+
+    const double cpu0 = cpu_seconds();
+    const auto t0 = std::chrono::steady_clock::now();
+
+    int errors = 0;
+    std::uint64_t offset = 0;
+    for (std::size_t i = 0; i < batches; ++i)
+    {
+      const std::size_t slot = i % io->slots();
+      errors += io->wait(slot) != 0;
+      // Touch the slot so every batch differs.
+      io->slot_data(slot)[0] = (char)('a' + i % 26);
+      const bool sync = a.sync_every > 0 && (i + 1) % a.sync_every == 0;
+      io->submit(fd, slot, chunk, offset, sync);
+      offset += chunk;
+    }
+    errors += io->wait(batches % io->slots()) != 0;
+    io->submit(fd, batches % io->slots(), 0, 0, true);
+    errors += io->drain() != 0;
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const double cpu = cpu_seconds() - cpu0;
+    const double mb = (double)offset / (1024.0 * 1024.0);
+
+    std::printf("%-9s %8.1f MB/s  %7.3f ms CPU/MB  %8llu syscalls  %d errors%s%s\n",
+                io->name(), mb / wall, cpu * 1000.0 / mb,
+                (unsigned long long)io->syscalls(), errors,
+                note.empty() ? "" : "  ", note.c_str());
+
+    io.reset();
+    ::close(fd);
+    ::unlink(path.c_str());
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Args a;
+  if (argc > 1)
+    a.dir = argv[1];
+  if (argc > 2)
+    a.total_mb = std::strtoull(argv[2], nullptr, 10);
+  if (argc > 3)
+    a.batch_kb = std::strtoull(argv[3], nullptr, 10);
+  if (argc > 4)
+    a.sync_every = std::strtoull(argv[4], nullptr, 10);
+
+  std::printf("%zu MB in %zu KB batches, sync every %zu batches, in %s\n",
+              a.total_mb, a.batch_kb, a.sync_every, a.dir.c_str());
+
+  run(a, PersistIoKind::Blocking);
+  run(a, PersistIoKind::Threads);
+  run(a, PersistIoKind::IoUring);
+  return 0;
+}
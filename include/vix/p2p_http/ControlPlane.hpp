@@ -0,0 +1,115 @@
+/**
+ *
+ *  @file ControlPlane.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_CONTROL_PLANE_HPP
+#define VIX_P2P_HTTP_CONTROL_PLANE_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+namespace vix
+{
+  class App;
+}
+
+namespace vix::p2p
+{
+  class P2PRuntime;
+}
+
+namespace vix::p2p_http
+{
+  /**
+   * @brief Options for a dedicated control-plane listener.
+   */
+  struct ControlPlaneOptions
+  {
+    /** @brief Port of the control-plane App (separate from the business API). */
+    int port = 0;
+
+    /**
+     * @brief CPUs for the control-plane threads (empty = not pinned).
+     *
+     * The launcher thread is pinned before the App is created, so the
+     * App's I/O and worker threads inherit the mask.
+     */
+    std::vector<int> cpus;
+
+    /** @brief Extra routes to mount on the control-plane App (optional). */
+    std::function<void(vix::App &)> setup = nullptr;
+  };
+
+  /**
+   * @brief Runs the p2p_http routes on their own App, port and threads.
+   *
+   * Keeps dashboard and admin traffic off the business App's accept queue
+   * and thread pool, so control-plane bursts cannot add data-plane
+   * latency. Module-wide state (logs, ticker, caches) is shared with any
+   * other registration.
+   */
+  class ControlPlane
+  {
+  public:
+    ControlPlane(vix::p2p::P2PRuntime &runtime, P2PHttpOptions opt, ControlPlaneOptions cp);
+    ~ControlPlane();
+
+    ControlPlane(const ControlPlane &) = delete;
+    ControlPlane &operator=(const ControlPlane &) = delete;
+
+    /**
+     * @brief Start listening from a dedicated thread.
+     *
+     * Returns once the routes are mounted and the port accepts
+     * connections.
+     * @return false when already running, the port is invalid, or route
+     *         setup or the listener failed (see error()).
+     */
+    bool start();
+
+    /** @brief Close the App and join its thread. */
+    void stop();
+
+    bool running() const;
+
+    /** @brief Why the last start() failed or serving stopped, if it did. */
+    std::string error() const;
+
+    /** @brief Pinning error reported by the launcher thread, if any. */
+    std::string affinity_error() const;
+
+  private:
+    void run();
+
+    vix::p2p::P2PRuntime &runtime_;
+    P2PHttpOptions opt_;
+    ControlPlaneOptions cp_;
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::unique_ptr<vix::App> app_;
+    std::thread thread_;
+    bool running_ = false;
+    bool ready_ = false;
+    std::string error_;
+    std::string affinity_error_;
+  };
+}
+
+#endif // VIX_P2P_HTTP_CONTROL_PLANE_HPP
@@ -0,0 +1,142 @@
+/**
+ *
+ *  @file Features.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_FEATURES_HPP
+#define VIX_P2P_HTTP_FEATURES_HPP
+
+#include <memory>
+#include <vector>
+
+#include <vix/p2p_http/P2PHttp.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+namespace vix::p2p_http
+{
+  /**
+   * @brief Route groups selectable at compile time.
+   *
+   * Combine with `|` and pass to registerRoutes<F>(). A group left out is
+   * never referenced, so with the static library its code (and what it
+   * starts at registration) is not linked in at all.
+   */
+  namespace feature
+  {
+    /** @brief GET /ping. */
+    inline constexpr unsigned ping = 1u << 0;
+
+    /** @brief GET /status and /ready. */
+    inline constexpr unsigned status = 1u << 1;
+
+    /** @brief GET /peers, /peers.arrow, /peers/delta, POST /connect; peer cache and journal. */
+    inline constexpr unsigned peers = 1u << 2;
+
+    /** @brief GET /logs; log ring, p2p log sink, stats ticker and history. */
+    inline constexpr unsigned logs = 1u << 3;
+
+    /** @brief PATCH /config, GET /debug/memory, /admin/drain, /admin/bundle, /admin/hook. */
+    inline constexpr unsigned admin = 1u << 4;
+
+    /** @brief OTLP/HTTP push of metrics and log lines (P2PHttpOptions::otlp_endpoint). */
+    inline constexpr unsigned otlp = 1u << 5;
+
+    /** @brief StatsD/UDP emitter on its own timer (P2PHttpOptions::statsd_host). */
+    inline constexpr unsigned statsd = 1u << 6;
+
+    /** @brief Rolling on-disk log file (P2PHttpOptions::log_file_path). */
+    inline constexpr unsigned log_file = 1u << 7;
+
+    inline constexpr unsigned all = ping | status | peers | logs | admin | otlp | statsd | log_file;
+  }
+
+  namespace detail
+  {
+    class Registration;
+
+    std::shared_ptr<Registration> begin_registration(
+        vix::App &app,
+        std::vector<NamedRuntime> runtimes,
+        const P2PHttpOptions &opt,
+        bool per_runtime);
+
+    void mount_logs(Registration &reg);
+    void mount_log_file(Registration &reg);
+    void mount_otlp(Registration &reg);
+    void mount_statsd(Registration &reg);
+    void mount_ping(Registration &reg);
+    void mount_status(Registration &reg);
+    void mount_peers(Registration &reg);
+    void mount_admin(Registration &reg);
+
+    void end_registration(Registration &reg);
+
+    template <unsigned Features>
+    void register_features(std::shared_ptr<Registration> reg)
+    {
+      static_assert((Features & ~feature::all) == 0, "unknown p2p_http feature bit");
+
+      if (!reg)
+        return;
+
+      // Log consumers first: lines logged by the other units land in their buffers.
+      if constexpr ((Features & feature::logs) != 0)
+        mount_logs(*reg);
+      if constexpr ((Features & feature::log_file) != 0)
+        mount_log_file(*reg);
+      if constexpr ((Features & feature::otlp) != 0)
+        mount_otlp(*reg);
+      if constexpr ((Features & feature::statsd) != 0)
+        mount_statsd(*reg);
+      if constexpr ((Features & feature::ping) != 0)
+        mount_ping(*reg);
+      if constexpr ((Features & feature::status) != 0)
+        mount_status(*reg);
+      if constexpr ((Features & feature::peers) != 0)
+        mount_peers(*reg);
+      if constexpr ((Features & feature::admin) != 0)
+        mount_admin(*reg);
+
+      end_registration(*reg);
+    }
+  }
+
+  /**
+   * @brief registerRoutes() limited to the route groups in `Features`.
+   *
+   * The runtime `enable_*` flags still apply within the selected groups.
+   * Example, for an embedded build:
+   *
+   *   registerRoutes<feature::ping | feature::status>(app, runtime, opt);
+   */
+  template <unsigned Features>
+  void registerRoutes(
+      vix::App &app,
+      vix::p2p::P2PRuntime &runtime,
+      const P2PHttpOptions &opt)
+  {
+    detail::register_features<Features>(
+        detail::begin_registration(app, {NamedRuntime{{}, &runtime}}, opt, false));
+  }
+
+  /** @brief registerRuntimes() limited to the route groups in `Features`. */
+  template <unsigned Features>
+  void registerRuntimes(
+      vix::App &app,
+      const std::vector<NamedRuntime> &runtimes,
+      const P2PHttpOptions &opt)
+  {
+    detail::register_features<Features>(
+        detail::begin_registration(app, runtimes, opt, true));
+  }
+}
+
+#endif // VIX_P2P_HTTP_FEATURES_HPP
@@ -0,0 +1,220 @@
+/**
+ *
+ *  @file KvStore.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_KV_STORE_HPP
+#define VIX_P2P_HTTP_KV_STORE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+namespace vix
+{
+  class App;
+}
+
+namespace vix::p2p_http
+{
+  /** @brief Outbound transport for replication batches (serialized JSON). */
+  using KvReplicator = std::function<void(std::string)>;
+
+  /**
+   * @brief Configuration for the replicated key-value store.
+   */
+  struct KvOptions
+  {
+    /** @brief Origin tag stored with every local write (LWW tie breaker). */
+    std::string node_id;
+
+    /** @brief Memory bound for keys + values + bookkeeping, in bytes. */
+    std::size_t max_bytes = 4 * 1024 * 1024;
+
+    /** @brief Largest accepted value, in bytes. */
+    std::size_t max_value_bytes = 64 * 1024;
+
+    /** @brief Maximum entries per anti-entropy batch. */
+    std::size_t batch_max_entries = 256;
+
+    /** @brief Push interval for outbound batches in milliseconds. */
+    int sync_every_ms = 500;
+
+    /**
+     * @brief Require auth on PUT and merge routes.
+     *
+     * Checked in the handler with P2PHttpOptions::auth_legacy, also in
+     * middleware builds: /kv/{key} has no fixed path to attach a route
+     * middleware to. No hook means 401.
+     */
+    bool require_auth = false;
+
+    /** @brief Transport used to push batches to peers (optional). */
+    KvReplicator replicate = nullptr;
+  };
+
+  /**
+   * @brief Store counters reported by the KV routes.
+   */
+  struct KvStats
+  {
+    std::size_t keys = 0;
+    std::size_t bytes = 0;
+    std::uint64_t seq = 0;
+    std::uint64_t local_writes = 0;
+    std::uint64_t merged = 0;
+    std::uint64_t stale_dropped = 0;
+    std::uint64_t evicted = 0;
+    std::uint64_t batches_pushed = 0;
+  };
+
+  /**
+   * @brief In-memory last-writer-wins map replicated by batched anti-entropy.
+   *
+   * Each entry carries a hybrid logical version (wall ms << 16 | counter)
+   * and its origin node id; merges keep the greater (version, origin).
+   * Every accepted write gets a store-local sequence number so peers can
+   * pull everything newer than a cursor in bounded batches. The push loop
+   * only sends local writes; entries merged from peers are not echoed back.
+   *
+   * Keys starting with '_' are reserved for the routes (`_merge`).
+   *
+   * Reads take a shared lock and never touch the network. When the memory
+   * bound is reached the oldest entries (by sequence) are evicted.
+   */
+  class KvStore
+  {
+  public:
+    explicit KvStore(KvOptions opt = {});
+    ~KvStore();
+
+    KvStore(const KvStore &) = delete;
+    KvStore &operator=(const KvStore &) = delete;
+
+    /** @brief Local read. */
+    std::optional<std::string> get(std::string_view key) const;
+
+    /**
+     * @brief Local write.
+     * @return Assigned version, or 0 when the key is reserved or the value
+     *         exceeds the bounds.
+     */
+    std::uint64_t put(std::string key, std::string value);
+
+    /** @brief Key starting with '_', refused by put() and merge(). */
+    static bool reserved_key(std::string_view key) noexcept;
+
+    /**
+     * @brief Serialize up to batch_max_entries entries newer than `since`.
+     * @param since Sequence cursor (exclusive).
+     * @param next Receives the cursor to use for the following call.
+     */
+    std::string delta_since(std::uint64_t since, std::uint64_t *next = nullptr) const;
+
+    /**
+     * @brief Apply a batch produced by delta_since() on another node.
+     *
+     * Entries with a reserved key, or over max_value_bytes or max_bytes,
+     * are skipped like put() refuses them.
+     * @return Number of entries accepted, or -1 when the batch is malformed.
+     */
+    long long merge(std::string_view batch);
+
+    /** @brief Start the background push loop (no-op without a replicator). */
+    void start_sync();
+
+    /** @brief Stop the background push loop. */
+    void stop_sync();
+
+    KvStats stats() const;
+
+    /**
+     * @brief Evict the oldest entries until about `bytes` are released.
+     * @return Bytes released (memory budget shrink hook).
+     */
+    std::size_t trim(std::size_t bytes);
+
+    const KvOptions &options() const noexcept { return opt_; }
+
+  private:
+    struct Entry
+    {
+      std::string value;
+      std::string origin;
+      std::uint64_t version = 0;
+      std::uint64_t seq = 0;
+      // Merged from a peer (not pushed again).
+      bool remote = false;
+    };
+
+    static std::size_t footprint(const std::string &key, const Entry &e) noexcept;
+
+    // `local_only` skips merged entries; `count` receives the entries sent.
+    std::string batch_since(std::uint64_t since, std::uint64_t *next, bool local_only, std::size_t *count) const;
+
+    std::uint64_t next_version_locked();
+    void upsert_locked(const std::string &key, Entry e);
+    void evict_locked();
+    void evict_oldest_locked();
+    void sync_loop();
+
+    KvOptions opt_;
+
+    mutable std::shared_mutex mu_;
+    std::unordered_map<std::string, Entry> map_;
+    std::map<std::uint64_t, std::string> by_seq_;
+    std::uint64_t seq_ = 0;
+    std::uint64_t last_version_ = 0;
+    std::size_t bytes_ = 0;
+    KvStats counters_{};
+
+    std::mutex sync_mu_;
+    std::condition_variable sync_cv_;
+    std::thread sync_thread_;
+    bool sync_stop_ = false;
+    std::uint64_t pushed_seq_ = 0;
+
+    std::uint64_t budget_id_ = 0;
+  };
+
+  /**
+   * @brief Register KV routes on the application.
+   *
+   *   GET  {prefix}/kv/{key}     local read
+   *   PUT  {prefix}/kv/{key}     local write (raw body is the value)
+   *   GET  {prefix}/kv?since=N   anti-entropy pull (batch + next cursor)
+   *   POST {prefix}/kv/_merge    anti-entropy push target
+   *
+   * The store must outlive the application.
+   *
+   * @param app Application instance used to register routes.
+   * @param store Store backing the routes.
+   * @param opt P2P HTTP options (prefix and auth hooks).
+   */
+  void registerKvRoutes(
+      vix::App &app,
+      KvStore &store,
+      const P2PHttpOptions &opt);
+}
+
+#endif // VIX_P2P_HTTP_KV_STORE_HPP
@@ -14,6 +14,11 @@
 #ifndef VIX_P2P_HTTP_HPP
 #define VIX_P2P_HTTP_HPP
 
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include <vix/p2p_http/P2PHttpOptions.hpp>
 
 namespace vix
@@ -44,6 +49,33 @@ namespace vix::p2p_http
       vix::p2p::P2PRuntime &runtime,
       const P2PHttpOptions &opt);
 
+  /** @brief A runtime mounted by registerRuntimes(). */
+  struct NamedRuntime
+  {
+    /** @brief Path segment under {prefix}/rt/ (must be URL-safe). */
+    std::string name;
+
+    vix::p2p::P2PRuntime *runtime = nullptr;
+  };
+
+  /**
+   * @brief Register routes for several runtimes under one prefix.
+   *
+   * Each runtime gets {prefix}/rt/{name}/status, /peers and /connect.
+   * {prefix}/status sums the counters and lists each runtime, and
+   * {prefix}/peers merges the per-runtime peer indexes (tagged with
+   * "runtime", filterable with ?runtime=). {prefix}/connect targets the
+   * first runtime. Module routes (logs, config, drain, ...) are shared.
+   *
+   * @param app Application instance used to register routes.
+   * @param runtimes Named runtimes; they must outlive the application.
+   * @param opt Configuration options controlling exposed endpoints.
+   */
+  void registerRuntimes(
+      vix::App &app,
+      const std::vector<NamedRuntime> &runtimes,
+      const P2PHttpOptions &opt);
+
   /**
    * @brief Stop live log streaming and release related resources.
    */
@@ -57,6 +89,28 @@ namespace vix::p2p_http
    * @param sink Callback receiving log lines.
    */
   void set_live_log_sink(std::function<void(std::string)> sink);
+
+  /**
+   * @brief Enter or leave drain mode.
+   *
+   * While draining, new /connect requests get 503, /ready reports not
+   * ready and /status reports draining. Requests already in flight
+   * complete normally; /ping keeps answering. Parked /peers/delta long
+   * polls return at once.
+   *
+   * @param on True to start draining, false to accept work again.
+   */
+  void set_draining(bool on);
+
+  /** @brief True while drain mode is active. */
+  bool is_draining();
+
+  /**
+   * @brief Number of p2p_http requests currently being handled.
+   *
+   * Useful to wait for zero before stopping the app during a rollout.
+   */
+  std::uint64_t in_flight_requests();
 }
 
 #endif // VIX_P2P_HTTP_HPP
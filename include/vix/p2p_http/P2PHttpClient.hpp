@@ -0,0 +1,297 @@
+/**
+ *
+ *  @file P2PHttpClient.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_CLIENT_HPP
+#define VIX_P2P_HTTP_CLIENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vix::p2p_http
+{
+  /**
+   * @brief Where and how a P2PHttpClient reaches the p2p_http routes.
+   */
+  struct ClientOptions
+  {
+    /** @brief Server host (name or address). */
+    std::string host = "127.0.0.1";
+
+    /** @brief Server port. */
+    int port = 8080;
+
+    /**
+     * @brief Unix domain socket to use instead of host:port (empty = TCP).
+     *
+     * Point it at P2PHttpOptions::admin_socket_path for local tooling.
+     */
+    std::string unix_socket;
+
+    /** @brief Route prefix configured on the server. */
+    std::string prefix = "/p2p";
+
+    /** @brief Keep-alive connections kept open between calls. */
+    std::size_t max_idle_connections = 4;
+
+    /** @brief Pooled connections idle longer than this are closed, in ms. */
+    int idle_timeout_ms = 4000;
+
+    /** @brief TCP connect timeout in milliseconds. */
+    int connect_timeout_ms = 2000;
+
+    /** @brief Per-read/write timeout in milliseconds. */
+    int io_timeout_ms = 5000;
+
+    /** @brief Extra headers sent on every request (e.g. Authorization). */
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    /**
+     * @brief Fetch peers() as GET /peers.arrow (Arrow IPC) instead of JSON.
+     *
+     * Falls back to GET /peers?compact=1 when the server does not serve
+     * the stream or it does not decode; after a 404 the client stops
+     * asking for it.
+     */
+    bool peers_arrow = false;
+  };
+
+  /**
+   * @brief Raw reply of one request.
+   *
+   * `status` is 0 when no HTTP reply was received; `error` then says why.
+   */
+  struct ClientResponse
+  {
+    int status = 0;
+    std::string content_type;
+    std::string body;
+    std::string error;
+
+    bool ok() const noexcept { return status >= 200 && status < 300; }
+  };
+
+  /** @brief Counters reported by GET /status (summed over runtimes). */
+  struct StatusCounters
+  {
+    long long peers_total = 0;
+    long long peers_connected = 0;
+    long long handshakes_started = 0;
+    long long handshakes_completed = 0;
+    long long connect_attempts = 0;
+    long long connect_deduped = 0;
+    long long connect_failures = 0;
+    long long backoff_skips = 0;
+    long long tracked_endpoints = 0;
+  };
+
+  /** @brief Typed GET /status reply. */
+  struct ClientStatus
+  {
+    bool ready = false;
+    bool draining = false;
+    long long in_flight = 0;
+    StatusCounters counters;
+
+    /** @brief Per-runtime counters when the server aggregates several. */
+    std::vector<std::pair<std::string, StatusCounters>> runtimes;
+  };
+
+  /** @brief Filters for peers(); empty fields are not sent. */
+  struct PeerQuery
+  {
+    std::string state;
+    std::string scheme;
+    std::string host;
+    std::string runtime;
+  };
+
+  /** @brief One row of GET /peers. */
+  struct PeerInfo
+  {
+    std::string peer_id;
+    std::string state;
+    std::string scheme;
+    std::string host;
+    int port = 0;
+    bool secure = false;
+    std::string handshake_stage;
+    long long last_seen_ms_ago = 0;
+    long long handshake_age_ms = 0;
+
+    /** @brief Owning runtime when the server aggregates several. */
+    std::string runtime;
+  };
+
+  /** @brief Endpoint for connect(). */
+  struct ConnectTarget
+  {
+    std::string host;
+    int port = 0;
+    std::string scheme = "tcp";
+  };
+
+  /** @brief Outcome of one connect() entry. */
+  struct ConnectResult
+  {
+    /** @brief HTTP status (0 = no reply, see `error`). */
+    int status = 0;
+    bool started = false;
+    std::string endpoint;
+    std::string error;
+  };
+
+  /** @brief Lines returned by GET /logs?since=. */
+  struct LogBatch
+  {
+    std::vector<std::string> lines;
+
+    /** @brief UTC ingest time of each line, "2026-10-19T12:34:56.123456Z" (empty from older servers). */
+    std::vector<std::string> ts;
+
+    /** @brief Cursor to pass to the next call. */
+    std::uint64_t cursor = 0;
+
+    /** @brief Lines that left the server ring before they were read. */
+    std::uint64_t dropped = 0;
+  };
+
+  /** @brief Pool counters. */
+  struct ClientStats
+  {
+    std::uint64_t requests = 0;
+    std::uint64_t connections_opened = 0;
+    std::uint64_t connections_reused = 0;
+    std::uint64_t retries = 0;
+  };
+
+  /**
+   * @brief Typed client for the p2p_http routes.
+   *
+   * Requests go over HTTP/1.1 keep-alive connections taken from a small
+   * pool, so repeated calls skip the TCP (or Unix socket) handshake. A
+   * pooled connection that the server closed in the meantime is retried
+   * once on a fresh one, for GET and HEAD only unless the caller opts in:
+   * the server may have applied the request before closing. connect()
+   * pipelines its batch on one connection and does replay it, since the
+   * node deduplicates connect attempts.
+   *
+   * Thread-safe: concurrent calls use separate connections. POSIX only;
+   * elsewhere every call fails with an error.
+   */
+  class P2PHttpClient
+  {
+  public:
+    explicit P2PHttpClient(ClientOptions opt = {});
+    ~P2PHttpClient();
+
+    P2PHttpClient(const P2PHttpClient &) = delete;
+    P2PHttpClient &operator=(const P2PHttpClient &) = delete;
+
+    /**
+     * @brief Send one request and read the whole reply.
+     * @param target Path under the prefix, with query (e.g. "/peers?state=connected").
+     * @param replay Also retry a method other than GET/HEAD on a fresh
+     *        connection; only for requests that are safe to apply twice.
+     */
+    ClientResponse request(std::string_view method,
+                           std::string_view target,
+                           std::string_view body = {},
+                           std::string_view content_type = "application/json",
+                           bool replay = false);
+
+    /** @brief GET /status. */
+    std::optional<ClientStatus> status(std::string *error = nullptr);
+
+    /**
+     * @brief GET /peers with optional filters, sorted by peer_id.
+     *
+     * Uses the compact JSON layout, or the Arrow stream when
+     * ClientOptions::peers_arrow is set.
+     */
+    std::optional<std::vector<PeerInfo>> peers(const PeerQuery &query = {}, std::string *error = nullptr);
+
+    /**
+     * @brief POST /connect for each target, pipelined on one connection.
+     * @return One result per target, in order.
+     */
+    std::vector<ConnectResult> connect(const std::vector<ConnectTarget> &batch);
+
+    /** @brief GET /logs?since=cursor (0 = everything still buffered). */
+    std::optional<LogBatch> logs(std::uint64_t cursor, std::string *error = nullptr);
+
+    /**
+     * @brief Poll /logs from `cursor`, calling `on_line` for each new line.
+     *
+     * Runs until `on_line` returns false, `stop` becomes true or a request
+     * fails. Waits `poll_every` between empty polls.
+     * @return The cursor to resume from.
+     */
+    std::uint64_t streamLogs(std::uint64_t cursor,
+                             const std::function<bool(std::string_view)> &on_line,
+                             const std::atomic<bool> *stop = nullptr,
+                             std::chrono::milliseconds poll_every = std::chrono::milliseconds(500));
+
+    /** @brief Close every pooled connection. */
+    void close_idle();
+
+    /**
+     * @brief Abort the calls in progress on other threads.
+     *
+     * Their connections are shut down, so they return at once with an
+     * error (e.g. to stop a long poll).
+     */
+    void interrupt();
+
+    ClientStats stats() const;
+
+    const ClientOptions &options() const noexcept { return opt_; }
+
+  private:
+    struct Conn
+    {
+      int fd = -1;
+      std::chrono::steady_clock::time_point idle_since{};
+    };
+
+    Conn acquire(bool &reused, std::string &error);
+    void release(Conn c);
+    void discard(Conn c);
+    Conn open(std::string &error);
+    std::string head(std::string_view method, std::string_view target, std::size_t body_len,
+                     std::string_view content_type, std::string_view accept = "application/json") const;
+    ClientResponse send(std::string_view method, std::string_view target, std::string_view body,
+                        std::string_view content_type, bool replay, std::string_view accept);
+
+    ClientOptions opt_;
+    std::string base_;
+
+    mutable std::mutex mu_;
+    std::vector<Conn> idle_;
+    std::vector<int> busy_;
+    std::uint64_t interrupts_ = 0;
+    bool peers_arrow_missing_ = false;
+    ClientStats stats_;
+  };
+
+} // namespace vix::p2p_http
+
+#endif // VIX_P2P_HTTP_CLIENT_HPP
@@ -14,8 +14,11 @@
 #ifndef VIX_P2P_HTTP_OPTIONS_HPP
 #define VIX_P2P_HTTP_OPTIONS_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include <vix/http/RequestHandler.hpp>
 #include <vix/mw/context.hpp>
@@ -57,6 +60,173 @@ namespace vix::p2p_http
     /** @brief Statistics emission interval in milliseconds. */
     int stats_every_ms = 1000;
 
+    /** @brief Number of lines kept by the in-memory log buffer. */
+    std::size_t log_capacity = 800;
+
+    /**
+     * @brief Stats samples kept for the diagnostic bundle (one per tick).
+     *
+     * Covers stats_history_len * stats_every_ms of history.
+     */
+    std::size_t stats_history_len = 600;
+
+    /** @brief Reuse the serialized /peers body for this long (0 = off). */
+    int peers_cache_ttl_ms = 0;
+
+    /**
+     * @brief Peer changes kept for GET /peers/delta.
+     *
+     * A consumer further behind than this gets a full snapshot instead.
+     */
+    std::size_t peers_delta_max_changes = 4096;
+
+    /** @brief Max POST /connect requests per second (0 = unlimited). */
+    int connect_rate_per_sec = 0;
+
+    /**
+     * @brief JSON file with tunable fields, watched and re-applied on change.
+     *
+     * Uses the same fields as PATCH /config. Empty disables the watcher.
+     */
+    std::string config_file;
+
+    /**
+     * @brief Defer the stats ticker and global log sink to first use.
+     *
+     * They start on the first /status, /peers, /logs or /connect request
+     * and the ticker exits again after lazy_idle_ms without one.
+     */
+    bool lazy_start = false;
+
+    /** @brief Inactivity before a lazy ticker idles down, in milliseconds. */
+    int lazy_idle_ms = 60000;
+
+    /**
+     * @brief Warm up at registration for a fast first request.
+     *
+     * Builds the peer index, serializes the initial /peers and /status
+     * bodies and reserves the log ring. The bodies serve the first request
+     * regardless of peers_cache_ttl_ms, unless the runtimes changed in
+     * between. Duration is logged and reported as warm_up_us in /status.
+     */
+    bool warm_up = false;
+
+    /**
+     * @brief Memory budget shared by the log ring, caches and KV stores.
+     *
+     * Above it, subsystems shrink in priority order (peers cache, then
+     * log ring, then KV). 0 = account only. Reported by /debug/memory.
+     */
+    std::size_t memory_budget_bytes = 0;
+
+    /**
+     * @brief Also serve the routes on this Unix domain socket (empty = off).
+     *
+     * Local tooling then bypasses the public port and the TCP stack. The
+     * socket is created with mode 0600; auth hooks do not apply there.
+     */
+    std::string admin_socket_path;
+
+    /**
+     * @brief Worker threads for the admin socket listener.
+     *
+     * A /peers/delta long poll holds one for its wait (up to 20 s): count
+     * one per PeerMirror on the socket, plus one for other callers.
+     */
+    int admin_socket_threads = 2;
+
+    /**
+     * @brief CPUs for p2p_http's own threads (empty = inherit).
+     *
+     * Applies to the stats ticker, config watcher, admin socket and KV
+     * sync threads, keeping them off cores reserved for P2P io threads.
+     */
+    std::vector<int> thread_cpus;
+
+    /** @brief Nice value for p2p_http's own threads (0 = unchanged). */
+    int thread_nice = 0;
+
+    /** @brief Run p2p_http's own threads under SCHED_BATCH (Linux). */
+    bool thread_sched_batch = false;
+
+    /**
+     * @brief OTLP/HTTP collector to push metrics and logs to (empty = off).
+     *
+     * "http://host:port[/path]"; payloads are POSTed as protobuf to
+     * {path}/v1/metrics and {path}/v1/logs. Needs feature::otlp.
+     */
+    std::string otlp_endpoint;
+
+    /** @brief Metrics sampling and push interval, in milliseconds. */
+    int otlp_push_every_ms = 10000;
+
+    /** @brief Log records per request; a full batch is pushed early. */
+    std::size_t otlp_batch_size = 512;
+
+    /**
+     * @brief Log records held while the collector is unreachable.
+     *
+     * Past it the oldest records are dropped (reported in /status).
+     */
+    std::size_t otlp_max_buffered_logs = 8192;
+
+    /** @brief Metric samples held while the collector is unreachable. */
+    std::size_t otlp_max_buffered_samples = 60;
+
+    /** @brief `service.name` resource attribute. */
+    std::string otlp_service_name = "p2p_http";
+
+    /**
+     * @brief StatsD agent to emit metrics to over UDP (empty = off).
+     *
+     * Metrics are sent every stats_every_ms from the emitter's own thread.
+     * Needs feature::statsd.
+     */
+    std::string statsd_host;
+
+    int statsd_port = 8125;
+
+    /** @brief Prepended to every metric name, followed by a dot. */
+    std::string statsd_prefix = "p2p_http";
+
+    /** @brief Datagram payload limit; the default fits a 1500-byte MTU. */
+    std::size_t statsd_max_datagram = 1432;
+
+    /**
+     * @brief File every module line is appended to (empty = off).
+     *
+     * Written by a background thread, in addition to the log ring or
+     * `log_sink`. Rotated files are kept as {path}.1 .. {path}.N.
+     * Needs feature::log_file.
+     */
+    std::string log_file_path;
+
+    /** @brief Rotate once the file reaches this size (0 = never). */
+    std::uint64_t log_file_max_bytes = 64ull * 1024 * 1024;
+
+    /** @brief Rotate once the file is this old, in seconds (0 = never). */
+    int log_file_rotate_every_s = 0;
+
+    /** @brief Rotated files kept. */
+    int log_file_keep = 5;
+
+    /** @brief Longest a line waits in memory before it is written. */
+    int log_file_flush_every_ms = 200;
+
+    /** @brief fdatasync() cadence (0 = leave it to the kernel). */
+    int log_file_fsync_every_ms = 1000;
+
+    /** @brief Unwritten bytes past which new lines are dropped. */
+    std::size_t log_file_max_pending_bytes = 8 * 1024 * 1024;
+
+    /**
+     * @brief Log file write path: "auto", "io_uring", "threads" or "blocking".
+     *
+     * "auto" uses io_uring when the kernel allows it, else a small thread
+     * pool; "blocking" writes on the writer thread itself.
+     */
+    std::string log_file_io = "auto";
+
     /** @brief Enable peers listing endpoint. */
     bool enable_peers{true};
 
@@ -0,0 +1,169 @@
+/**
+ *
+ *  @file PeerMirror.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_PEER_MIRROR_HPP
+#define VIX_P2P_HTTP_PEER_MIRROR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <vix/p2p_http/P2PHttpClient.hpp>
+
+namespace vix::p2p_http
+{
+  /**
+   * @brief Options for PeerMirror.
+   */
+  struct PeerMirrorOptions
+  {
+    /** @brief Long-poll wait per GET /peers/delta, in milliseconds. */
+    int wait_ms = 20000;
+
+    /** @brief Delay before retrying after a failed request, in milliseconds. */
+    int retry_ms = 1000;
+  };
+
+  enum class PeerChangeKind
+  {
+    Added,
+    Updated,
+    Removed,
+  };
+
+  /** @brief One change applied to the mirror. */
+  struct PeerChange
+  {
+    PeerChangeKind kind = PeerChangeKind::Added;
+
+    /** @brief New row (Added/Updated) or the last known row (Removed). */
+    PeerInfo peer;
+  };
+
+  using PeerChangeFn = std::function<void(const PeerChange &)>;
+
+  /** @brief Mirror counters. */
+  struct PeerMirrorStats
+  {
+    std::uint64_t snapshots = 0;
+    std::uint64_t deltas = 0;
+    std::uint64_t changes = 0;
+    std::uint64_t errors = 0;
+  };
+
+  /**
+   * @brief Local copy of a node's peer table, kept current by deltas.
+   *
+   * Bootstraps from a full snapshot, then long-polls GET /peers/delta with
+   * the last applied generation, so traffic follows churn rather than
+   * table size. The server sends a new snapshot when the mirror fell too
+   * far behind or the node restarted; it is diffed against the table so
+   * callbacks still see individual changes.
+   *
+   * Reads are local and take a shared lock. Change callbacks run on the
+   * sync thread (or the sync_once() caller) after the table is updated.
+   */
+  class PeerMirror
+  {
+  public:
+    explicit PeerMirror(ClientOptions client, PeerMirrorOptions opt = {});
+    ~PeerMirror();
+
+    PeerMirror(const PeerMirror &) = delete;
+    PeerMirror &operator=(const PeerMirror &) = delete;
+
+    /** @brief Add a change callback. Call before start(). */
+    void on_change(PeerChangeFn fn);
+
+    /** @brief Start the background sync thread. */
+    void start();
+
+    /** @brief Stop the sync thread, aborting a pending long poll. */
+    void stop();
+
+    bool running() const noexcept { return running_.load(); }
+
+    /**
+     * @brief Run one sync step on the calling thread.
+     * @param wait_ms Long-poll wait (0 = answer at once).
+     * @return false with `error` set when the request failed.
+     */
+    bool sync_once(std::string *error = nullptr, int wait_ms = 0);
+
+    /** @brief True once a snapshot has been applied. */
+    bool ready() const;
+
+    /** @brief Wait until ready() or the timeout; returns ready(). */
+    bool wait_ready(std::chrono::milliseconds timeout) const;
+
+    std::optional<PeerInfo> find(std::string_view peer_id, std::string_view runtime = {}) const;
+
+    /** @brief Every peer, sorted by (peer_id, runtime). */
+    std::vector<PeerInfo> snapshot() const;
+
+    /** @brief Peers in `state` (indexed), sorted by (peer_id, runtime). */
+    std::vector<PeerInfo> by_state(std::string_view state) const;
+
+    std::size_t size() const;
+
+    /** @brief Last applied generation of the server journal. */
+    std::uint64_t generation() const;
+
+    PeerMirrorStats stats() const;
+
+  private:
+    // Ordered key: peer_id, '\0', runtime.
+    static std::string key_of(std::string_view peer_id, std::string_view runtime);
+
+    void run();
+    void apply_snapshot_locked(std::vector<PeerInfo> rows, std::vector<PeerChange> &out);
+    void upsert_locked(PeerInfo row, std::vector<PeerChange> &out);
+    void remove_locked(const std::string &key, std::vector<PeerChange> &out);
+
+    P2PHttpClient client_;
+    PeerMirrorOptions opt_;
+    std::vector<PeerChangeFn> callbacks_;
+
+    mutable std::shared_mutex mu_;
+    mutable std::condition_variable_any ready_cv_;
+    std::map<std::string, PeerInfo> rows_;
+    std::unordered_map<std::string, std::set<std::string>> by_state_;
+    std::uint64_t epoch_ = 0;
+    std::uint64_t gen_ = 0;
+    bool ready_ = false;
+    PeerMirrorStats stats_;
+
+    std::mutex sync_mu_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    std::mutex stop_mu_;
+    std::condition_variable stop_cv_;
+    std::thread thread_;
+  };
+
+} // namespace vix::p2p_http
+
+#endif // VIX_P2P_HTTP_PEER_MIRROR_HPP
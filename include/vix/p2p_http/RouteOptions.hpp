@@ -29,6 +29,9 @@ namespace vix::p2p_http
 
     /** @brief Require authentication before executing the route. */
     bool require_auth = false;
+
+    /** @brief Answer 503 while the node is draining (new work only). */
+    bool reject_when_draining = false;
   };
 }
 
@@ -24,8 +24,13 @@
 #define VIX_P2P_HTTP_MODULE_HPP
 
 #include <vix/p2p_http/P2PHttp.hpp>
+#include <vix/p2p_http/Features.hpp>
 #include <vix/p2p_http/P2PHttpOptions.hpp>
 #include <vix/p2p_http/RouteOptions.hpp>
+#include <vix/p2p_http/KvStore.hpp>
+#include <vix/p2p_http/ControlPlane.hpp>
+#include <vix/p2p_http/P2PHttpClient.hpp>
+#include <vix/p2p_http/PeerMirror.hpp>
 
 // middleware
 #include <vix/p2p_http/middleware/AuthHook.hpp>
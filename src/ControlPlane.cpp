@@ -0,0 +1,274 @@
+/**
+ *
+ *  @file ControlPlane.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/ControlPlane.hpp>
+#include <vix/p2p_http/P2PHttp.hpp>
+
+#include "detail/ThreadTuning.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/p2p/P2P.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VIX_P2P_HTTP_HAS_PORT_PROBE 1
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace vix::p2p_http
+{
+  namespace
+  {
+#if defined(VIX_P2P_HTTP_HAS_PORT_PROBE)
+    // Whether the port can be bound, checked before handing it to the App:
+    // a failed bind on the App's own threads would otherwise go unnoticed.
+    bool port_free(int port, std::string &error)
+    {
+      const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+      if (fd < 0)
+        return true;
+      const int one = 1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_ANY);
+      addr.sin_port = htons((uint16_t)port);
+      const bool ok = ::bind(fd, (const sockaddr *)&addr, sizeof(addr)) == 0;
+      if (!ok)
+        error = "bind port " + std::to_string(port) + ": " + std::strerror(errno);
+      ::close(fd);
+      return ok;
+    }
+
+    bool port_accepts(int port)
+    {
+      const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+      if (fd < 0)
+        return false;
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr.sin_port = htons((uint16_t)port);
+      const bool ok = ::connect(fd, (const sockaddr *)&addr, sizeof(addr)) == 0;
+      ::close(fd);
+      return ok;
+    }
+#else
+    bool port_free(int, std::string &) { return true; }
+    bool port_accepts(int) { return true; }
+#endif
+
+    // The App listens from its own threads; give it a moment to come up.
+    bool wait_listening(int port)
+    {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+      for (;;)
+      {
+        if (port_accepts(port))
+          return true;
+        if (std::chrono::steady_clock::now() >= deadline)
+          return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+  }
+
+  ControlPlane::ControlPlane(vix::p2p::P2PRuntime &runtime, P2PHttpOptions opt, ControlPlaneOptions cp)
+      : runtime_(runtime), opt_(std::move(opt)), cp_(std::move(cp))
+  {
+  }
+
+  ControlPlane::~ControlPlane()
+  {
+    stop();
+  }
+
+  bool ControlPlane::start()
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (running_ || cp_.port <= 0 || cp_.port > 65535)
+      return false;
+
+    running_ = true;
+    ready_ = false;
+    error_.clear();
+    thread_ = std::thread([this]()
+                          { run(); });
+
+    // Routes are mounted and the port is listening once start() returns true.
+    cv_.wait(lk, [this]()
+             { return ready_; });
+    if (error_.empty())
+      return true;
+
+    std::thread t = std::move(thread_);
+    running_ = false;
+    lk.unlock();
+    if (t.joinable())
+      t.join();
+    return false;
+  }
+
+  void ControlPlane::run()
+  {
+    std::string error;
+    const bool pinned = detail::pin_current_thread(cp_.cpus, &error);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (!pinned)
+        affinity_error_ = error;
+    }
+
+    // Nothing may escape this thread: report the failure to start() instead.
+    auto fail = [this](std::string why)
+    {
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        error_ = std::move(why);
+        app_.reset();
+        ready_ = true;
+      }
+      cv_.notify_all();
+    };
+
+    std::unique_ptr<vix::App> app;
+    try
+    {
+      // Created on this thread so the App's threads inherit the affinity.
+      app = std::make_unique<vix::App>();
+      registerRoutes(*app, runtime_, opt_);
+      if (cp_.setup)
+        cp_.setup(*app);
+    }
+    catch (const std::exception &e)
+    {
+      fail(std::string("setup: ") + e.what());
+      return;
+    }
+    catch (...)
+    {
+      fail("setup: unknown exception");
+      return;
+    }
+
+    std::string bind_error;
+    if (!port_free(cp_.port, bind_error))
+    {
+      fail(std::move(bind_error));
+      return;
+    }
+
+    vix::App *raw = app.get();
+    bool listening = false;
+    try
+    {
+      raw->listen(cp_.port, []() {});
+      listening = wait_listening(cp_.port);
+    }
+    catch (const std::exception &e)
+    {
+      bind_error = std::string("listen: ") + e.what();
+    }
+    catch (...)
+    {
+      bind_error = "listen: unknown exception";
+    }
+
+    if (!listening)
+    {
+      if (bind_error.empty())
+        bind_error = "listen: port " + std::to_string(cp_.port) + " did not come up";
+      try
+      {
+        raw->close();
+        raw->wait();
+      }
+      catch (...)
+      {
+      }
+      fail(std::move(bind_error));
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      app_ = std::move(app);
+      ready_ = true;
+    }
+    cv_.notify_all();
+
+    try
+    {
+      raw->wait();
+    }
+    catch (const std::exception &e)
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      error_ = std::string("serve: ") + e.what();
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      error_ = "serve: unknown exception";
+    }
+  }
+
+  void ControlPlane::stop()
+  {
+    std::thread t;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (!running_)
+        return;
+
+      if (app_)
+        app_->close();
+      t = std::move(thread_);
+      running_ = false;
+    }
+
+    if (t.joinable())
+      t.join();
+
+    std::lock_guard<std::mutex> lk(mu_);
+    app_.reset();
+  }
+
+  bool ControlPlane::running() const
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return running_;
+  }
+
+  std::string ControlPlane::error() const
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return error_;
+  }
+
+  std::string ControlPlane::affinity_error() const
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return affinity_error_;
+  }
+}
@@ -0,0 +1,477 @@
+/**
+ *
+ *  @file KvStore.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/KvStore.hpp>
+
+#include "detail/MemoryBudget.hpp"
+#include "detail/RouteSupport.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/ThreadTuning.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+#include <utility>
+
+namespace J = vix::json;
+
+namespace vix::p2p_http
+{
+  KvStore::KvStore(KvOptions opt) : opt_(std::move(opt))
+  {
+    if (opt_.batch_max_entries == 0)
+      opt_.batch_max_entries = 1;
+
+    detail::MemoryConsumer c;
+    c.name = "kv:" + opt_.node_id;
+    c.priority = 30;
+    c.usage = [this]()
+    {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      return bytes_;
+    };
+    c.shrink = [this](std::size_t want)
+    { return trim(want); };
+    budget_id_ = detail::memory_budget().add(std::move(c));
+  }
+
+  KvStore::~KvStore()
+  {
+    detail::memory_budget().remove(budget_id_);
+    stop_sync();
+  }
+
+  std::size_t KvStore::footprint(const std::string &key, const Entry &e) noexcept
+  {
+    // key appears twice (map + seq index); 64 bytes approximates node overhead.
+    return key.size() * 2 + e.value.size() + e.origin.size() + 64;
+  }
+
+  std::optional<std::string> KvStore::get(std::string_view key) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    auto it = map_.find(std::string(key));
+    if (it == map_.end())
+      return std::nullopt;
+    return it->second.value;
+  }
+
+  std::uint64_t KvStore::next_version_locked()
+  {
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    const std::uint64_t wall = static_cast<std::uint64_t>(now_ms) << 16;
+    last_version_ = std::max(wall, last_version_ + 1);
+    return last_version_;
+  }
+
+  void KvStore::upsert_locked(const std::string &key, Entry e)
+  {
+    e.seq = ++seq_;
+
+    auto it = map_.find(key);
+    if (it != map_.end())
+    {
+      bytes_ -= footprint(key, it->second);
+      by_seq_.erase(it->second.seq);
+      it->second = std::move(e);
+    }
+    else
+    {
+      it = map_.emplace(key, std::move(e)).first;
+    }
+
+    bytes_ += footprint(key, it->second);
+    by_seq_.emplace(it->second.seq, key);
+    evict_locked();
+  }
+
+  void KvStore::evict_oldest_locked()
+  {
+    auto oldest = by_seq_.begin();
+    auto it = map_.find(oldest->second);
+    if (it != map_.end())
+    {
+      bytes_ -= footprint(it->first, it->second);
+      map_.erase(it);
+    }
+    by_seq_.erase(oldest);
+    ++counters_.evicted;
+  }
+
+  void KvStore::evict_locked()
+  {
+    while (bytes_ > opt_.max_bytes && by_seq_.size() > 1)
+      evict_oldest_locked();
+  }
+
+  std::size_t KvStore::trim(std::size_t bytes)
+  {
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    const std::size_t before = bytes_;
+    while (before - bytes_ < bytes && !by_seq_.empty())
+      evict_oldest_locked();
+    return before - bytes_;
+  }
+
+  bool KvStore::reserved_key(std::string_view key) noexcept
+  {
+    return !key.empty() && key.front() == '_';
+  }
+
+  std::uint64_t KvStore::put(std::string key, std::string value)
+  {
+    if (key.empty() || reserved_key(key) || value.size() > opt_.max_value_bytes)
+      return 0;
+
+    Entry e;
+    e.value = std::move(value);
+    e.origin = opt_.node_id;
+    if (footprint(key, e) > opt_.max_bytes)
+      return 0;
+
+    std::uint64_t version = 0;
+    {
+      std::unique_lock<std::shared_mutex> lock(mu_);
+      version = next_version_locked();
+      e.version = version;
+      upsert_locked(key, std::move(e));
+      ++counters_.local_writes;
+    }
+
+    return version;
+  }
+
+  std::string KvStore::delta_since(std::uint64_t since, std::uint64_t *next) const
+  {
+    return batch_since(since, next, false, nullptr);
+  }
+
+  std::string KvStore::batch_since(std::uint64_t since, std::uint64_t *next, bool local_only, std::size_t *count) const
+  {
+    J::Json entries = J::Json::array();
+    std::uint64_t cursor = since;
+
+    {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      std::size_t n = 0;
+      for (auto it = by_seq_.upper_bound(since);
+           it != by_seq_.end() && n < opt_.batch_max_entries;
+           ++it)
+      {
+        // Skipped entries still move the cursor past them.
+        cursor = it->first;
+        const auto &e = map_.at(it->second);
+        if (local_only && e.remote)
+          continue;
+
+        entries.push_back(J::Json{
+            {"k", it->second},
+            {"v", e.value},
+            {"ver", e.version},
+            {"o", e.origin},
+        });
+        ++n;
+      }
+    }
+
+    if (next)
+      *next = cursor;
+    if (count)
+      *count = entries.size();
+
+    J::Json batch = {
+        {"node", opt_.node_id},
+        {"next", cursor},
+        {"entries", std::move(entries)},
+    };
+    return batch.dump();
+  }
+
+  long long KvStore::merge(std::string_view batch)
+  {
+    J::Json doc;
+    try
+    {
+      doc = J::Json::parse(batch.begin(), batch.end());
+    }
+    catch (...)
+    {
+      return -1;
+    }
+
+    const auto *entries = J::jget(doc, "entries");
+    if (!entries || !entries->is_array())
+      return -1;
+
+    long long accepted = 0;
+    {
+      std::unique_lock<std::shared_mutex> lock(mu_);
+      for (const auto &item : *entries)
+      {
+        if (!item.is_object())
+          continue;
+
+        const auto *k = J::jget(item, "k");
+        const auto *v = J::jget(item, "v");
+        const auto *ver = J::jget(item, "ver");
+        const auto *o = J::jget(item, "o");
+        if (!k || !k->is_string() || !v || !v->is_string() || !ver || !ver->is_number_unsigned())
+          continue;
+
+        Entry e;
+        e.value = v->get<std::string>();
+        e.version = ver->get<std::uint64_t>();
+        e.origin = (o && o->is_string()) ? o->get<std::string>() : std::string{};
+
+        e.remote = true;
+
+        const std::string key = k->get<std::string>();
+        if (key.empty() || reserved_key(key) || e.value.size() > opt_.max_value_bytes ||
+            footprint(key, e) > opt_.max_bytes)
+          continue;
+
+        auto it = map_.find(key);
+        if (it != map_.end() &&
+            std::tie(it->second.version, it->second.origin) >= std::tie(e.version, e.origin))
+        {
+          ++counters_.stale_dropped;
+          continue;
+        }
+
+        last_version_ = std::max(last_version_, e.version);
+        upsert_locked(key, std::move(e));
+        ++accepted;
+      }
+      counters_.merged += static_cast<std::uint64_t>(accepted);
+    }
+
+    return accepted;
+  }
+
+  KvStats KvStore::stats() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    KvStats st = counters_;
+    st.keys = map_.size();
+    st.bytes = bytes_;
+    st.seq = seq_;
+    return st;
+  }
+
+  void KvStore::start_sync()
+  {
+    if (!opt_.replicate)
+      return;
+
+    std::lock_guard<std::mutex> lk(sync_mu_);
+    if (sync_thread_.joinable())
+      return;
+
+    sync_stop_ = false;
+    sync_thread_ = std::thread([this]()
+                               { sync_loop(); });
+  }
+
+  void KvStore::stop_sync()
+  {
+    {
+      std::lock_guard<std::mutex> lk(sync_mu_);
+      sync_stop_ = true;
+    }
+    sync_cv_.notify_all();
+
+    if (sync_thread_.joinable())
+      sync_thread_.join();
+  }
+
+  void KvStore::sync_loop()
+  {
+    const detail::ThreadPolicyScope policy("kv_sync");
+
+    const auto every = std::chrono::milliseconds(opt_.sync_every_ms <= 0 ? 500 : opt_.sync_every_ms);
+
+    std::unique_lock<std::mutex> lk(sync_mu_);
+    while (!sync_stop_)
+    {
+      // Coalesce writes for one interval, then drain everything pending in batches.
+      sync_cv_.wait_for(lk, every, [this]()
+                        { return sync_stop_; });
+      if (sync_stop_)
+        break;
+
+      while (!sync_stop_)
+      {
+        std::uint64_t head = 0;
+        {
+          std::shared_lock<std::shared_mutex> lock(mu_);
+          head = seq_;
+        }
+        if (head <= pushed_seq_)
+          break;
+
+        // Local writes only: merged entries came from peers, and pushing
+        // them back would echo every write around the mesh.
+        std::uint64_t next = pushed_seq_;
+        std::size_t count = 0;
+        std::string batch = batch_since(pushed_seq_, &next, true, &count);
+        if (next == pushed_seq_)
+        {
+          // Everything newer than the cursor was evicted.
+          pushed_seq_ = head;
+          break;
+        }
+        if (count == 0)
+        {
+          pushed_seq_ = next;
+          continue;
+        }
+
+        lk.unlock();
+        opt_.replicate(std::move(batch));
+        lk.lock();
+
+        pushed_seq_ = next;
+        {
+          std::unique_lock<std::shared_mutex> lock(mu_);
+          ++counters_.batches_pushed;
+        }
+      }
+    }
+  }
+
+  void registerKvRoutes(vix::App &app, KvStore &store, const P2PHttpOptions &opt)
+  {
+    const std::string base = detail::base_prefix(opt);
+
+    // Write routes check in the handler, in every build: a route-level
+    // middleware only matches a fixed path, never /kv/{key}.
+    RouteOptions write_ro;
+    write_ro.heavy = false;
+    write_ro.require_auth = store.options().require_auth;
+
+    // GET /p2p/kv/{key}
+    {
+      const std::string path = detail::join_prefix(base, "/kv/{key}");
+
+      app.get(path, [&store](vix::http::Request &req, vix::http::ResponseWrapper &res)
+              {
+        const std::string key = req.param("key");
+        auto value = store.get(key);
+        if (!value)
+        {
+          res.status(404).json(J::obj({
+            "ok", false,
+            "error", "not_found",
+            "key", key
+          }));
+          return;
+        }
+
+        res.type("application/octet-stream");
+        res.send(std::move(*value)); });
+    }
+
+    // PUT /p2p/kv/{key}
+    {
+      const std::string path = detail::join_prefix(base, "/kv/{key}");
+
+      app.put(path, [&store, opt, write_ro](vix::http::Request &req, vix::http::ResponseWrapper &res)
+              {
+        if (!detail::legacy_route_guard(opt, write_ro, req, res))
+          return;
+        const std::string key = req.param("key");
+        if (KvStore::reserved_key(key))
+        {
+          res.status(400).json(J::obj({
+            "ok", false,
+            "error", "reserved_key",
+            "hint", "keys starting with '_' are reserved"
+          }));
+          return;
+        }
+
+        const std::uint64_t version = store.put(key, req.body());
+        if (version == 0)
+        {
+          res.status(413).json(J::obj({
+            "ok", false,
+            "error", "value_rejected",
+            "hint", "empty key or value exceeds kv bounds"
+          }));
+          return;
+        }
+
+        res.json(J::obj({
+          "ok", true,
+          "key", key,
+          "version", (long long)version
+        })); });
+    }
+
+    // GET /p2p/kv?since=N  (anti-entropy pull)
+    {
+      const std::string path = detail::join_prefix(base, "/kv");
+
+      app.get(path, [&store](vix::http::Request &req, vix::http::ResponseWrapper &res)
+              {
+        const std::string since_text = req.query_value("since", "");
+        std::uint64_t since = 0;
+        if (!since_text.empty() && !detail::parse_u64(since_text, since))
+        {
+          res.status(400).type("application/json");
+          res.send(std::string(R"({"error":"invalid_cursor","hint":"since=<next from a previous batch>","ok":false})"));
+          return;
+        }
+
+        res.type("application/json");
+        res.send(store.delta_since(since)); });
+    }
+
+    // POST /p2p/kv/_merge  (anti-entropy push)
+    {
+      const std::string path = detail::join_prefix(base, "/kv/_merge");
+
+      app.post(path, [&store, opt, write_ro](vix::http::Request &req, vix::http::ResponseWrapper &res)
+               {
+        if (!detail::legacy_route_guard(opt, write_ro, req, res))
+          return;
+        const long long accepted = store.merge(req.body());
+        if (accepted < 0)
+        {
+          res.status(400).json(J::obj({
+            "ok", false,
+            "error", "invalid_batch"
+          }));
+          return;
+        }
+
+        const auto st = store.stats();
+        res.json(J::obj({
+          "ok", true,
+          "accepted", accepted,
+          "keys", (long long)st.keys,
+          "bytes", (long long)st.bytes,
+          "seq", (long long)st.seq
+        })); });
+    }
+  }
+
+} // namespace vix::p2p_http
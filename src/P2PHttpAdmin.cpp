@@ -0,0 +1,280 @@
+/**
+ *
+ *  @file P2PHttpAdmin.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+#include <vix/p2p_http/RouteOptions.hpp>
+
+#include "detail/LiveConfig.hpp"
+#include "detail/MemoryBudget.hpp"
+#include "detail/RouteMetrics.hpp"
+#include "detail/RouteSupport.hpp"
+#include "detail/RouteTable.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/RowExport.hpp"
+#include "detail/TarGz.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace J = vix::json;
+
+// Admin unit: PATCH /config, GET /debug/memory, POST /admin/drain,
+// GET /admin/bundle and POST /admin/hook.
+namespace vix::p2p_http
+{
+  using detail::join_prefix;
+
+  // PATCH /config body -> reply. Returns the HTTP status.
+  static int config_patch_reply(const std::string &text, J::Json &out)
+  {
+    J::Json patch;
+    try
+    {
+      patch = J::Json::parse(text);
+    }
+    catch (...)
+    {
+      out = J::Json{{"ok", false}, {"error", "invalid_json"}};
+      return 400;
+    }
+
+    const auto result = detail::apply_config_patch(patch);
+    if (!result.ok)
+    {
+      out = J::Json{{"ok", false}, {"error", result.error}, {"field", result.field}};
+      return 400;
+    }
+
+    out = J::Json{
+        {"ok", true},
+        {"config", detail::live_config_json(*detail::live_config())},
+    };
+    return 200;
+  }
+
+  // POST /admin/drain body -> reply. body: {"drain": true|false}, defaults to true.
+  static int drain_reply(const std::string &text, J::Json &out)
+  {
+    bool drain = true;
+    if (!text.empty())
+    {
+      J::Json body;
+      try
+      {
+        body = J::Json::parse(text);
+      }
+      catch (...)
+      {
+        out = J::Json{{"ok", false}, {"error", "invalid_json"}};
+        return 400;
+      }
+
+      if (const auto *v = vix::json::jget(body, "drain"))
+      {
+        if (!v->is_boolean())
+        {
+          out = J::Json{{"ok", false}, {"error", "invalid_type"}, {"field", "drain"}};
+          return 400;
+        }
+        drain = v->get<bool>();
+      }
+    }
+
+    vix::p2p_http::set_draining(drain);
+    detail::log_line(drain ? "[p2p_http] drain started" : "[p2p_http] drain cancelled");
+
+    // This request is still counted; report the others.
+    out = J::Json{
+        {"ok", true},
+        {"draining", drain},
+        {"in_flight", (long long)(detail::in_flight() - 1)},
+    };
+    return 200;
+  }
+
+  // GET /admin/bundle: node state captured in one go, then written out as
+  // an archive. The peers and logs units add their files when linked in.
+  struct BundleSnapshot
+  {
+    long long captured_ms = 0;
+    std::string status;
+    std::string config;
+    std::vector<detail::BundleFile> files;
+  };
+
+  static std::shared_ptr<const BundleSnapshot> capture_bundle(const detail::RuntimeSet &set)
+  {
+    auto snap = std::make_shared<BundleSnapshot>();
+
+    snap->captured_ms = detail::wall_now_ms();
+    snap->status = detail::build_status_body(set);
+    snap->config = detail::live_config_json(*detail::live_config()).dump(2);
+    snap->files = detail::capture_unit_bundles(set);
+    return snap;
+  }
+
+  // Archive entry whose size is only known once written: `produce` runs
+  // twice on the same snapshot, first to count, then into the archive.
+  static bool bundle_entry(detail::TarGzWriter &tar,
+                           const std::string &name,
+                           long long mtime_s,
+                           const std::function<bool(const detail::ChunkSink &)> &produce)
+  {
+    std::uint64_t size = 0;
+    produce([&size](std::string_view block)
+            { size += block.size(); return true; });
+
+    return tar.begin(name, size, mtime_s) &&
+           produce([&tar](std::string_view block)
+                   { return tar.write(block); }) &&
+           tar.end();
+  }
+
+  static bool write_bundle(const BundleSnapshot &snap, const detail::ChunkSink &sink)
+  {
+    const long long mtime_s = snap.captured_ms / 1000;
+    const std::string dir = "p2p_http-" + std::to_string(snap.captured_ms) + "/";
+
+    J::Json manifest = {
+        {"module", "p2p_http"},
+        {"captured_at_ms", snap.captured_ms},
+    };
+    for (const auto &f : snap.files)
+      manifest[f.manifest_key] = f.count;
+
+    detail::TarGzWriter tar(sink);
+    bool ok = tar.add(dir + "manifest.json", manifest.dump(2), mtime_s) &&
+              tar.add(dir + "status.json", snap.status, mtime_s) &&
+              tar.add(dir + "config.json", snap.config, mtime_s);
+
+    for (const auto &f : snap.files)
+    {
+      if (ok && f.produce)
+        ok = bundle_entry(tar, dir + f.name, mtime_s, f.produce);
+    }
+
+    return ok && tar.finish();
+  }
+
+  static const char *bundle_content_type()
+  {
+    return detail::tar_gz_compressed() ? "application/gzip" : "application/x-tar";
+  }
+
+  namespace detail
+  {
+    void mount_admin(Registration &reg)
+    {
+      const RuntimeSetPtr rts = reg.rts;
+      const std::string &base = reg.base;
+
+      // PATCH /p2p/config (auth)  apply tunables live, reply with the effective config
+      {
+        RouteSpec spec;
+        spec.method = "PATCH";
+        spec.path = join_prefix(base, "/config");
+        spec.id = RouteId::Config;
+        spec.ro.require_auth = true;
+        spec.handler = [](const RouteRequest &req, RouteReply &out)
+        {
+          J::Json reply;
+          const int status = config_patch_reply(req.body(), reply);
+          reply_json(out, status, reply);
+        };
+        mount_route(reg, std::move(spec));
+      }
+
+      // GET /p2p/debug/memory  (budget and per-subsystem usage)
+      {
+        RouteSpec spec;
+        spec.path = join_prefix(base, "/debug/memory");
+        spec.id = RouteId::Debug;
+        spec.handler = [](const RouteRequest &, RouteReply &out)
+        {
+          auto &budget = memory_budget();
+          budget.enforce();
+          reply_json(out, 200, budget.report());
+        };
+        mount_route(reg, std::move(spec));
+      }
+
+      // POST /p2p/admin/drain (auth)  body: {"drain": true|false}, defaults to true
+      {
+        RouteSpec spec;
+        spec.method = "POST";
+        spec.path = join_prefix(base, "/admin/drain");
+        spec.id = RouteId::Admin;
+        spec.ro.require_auth = true;
+        spec.handler = [](const RouteRequest &req, RouteReply &out)
+        {
+          J::Json reply;
+          const int status = drain_reply(req.body(), reply);
+          reply_json(out, status, reply);
+        };
+        mount_route(reg, std::move(spec));
+      }
+
+      // GET /p2p/admin/bundle (heavy + auth)  status, peers, logs, stats history, config
+      {
+        RouteSpec spec;
+        spec.path = join_prefix(base, "/admin/bundle");
+        spec.id = RouteId::Admin;
+        spec.ro.heavy = true;
+        spec.ro.require_auth = true;
+        spec.handler = [rts](const RouteRequest &, RouteReply &out)
+        {
+          // Captured now, written later: the admin socket streams the
+          // archive, the App gathers it into one body.
+          auto snap = capture_bundle(*rts);
+
+          const std::string file = "p2p_http-" + std::to_string(snap->captured_ms) +
+                                   (tar_gz_compressed() ? ".tar.gz" : ".tar");
+          out.headers.emplace_back("Content-Disposition", "attachment; filename=\"" + file + "\"");
+          out.type = bundle_content_type();
+          out.stream = [snap = std::move(snap)](const ChunkSink &sink)
+          { return write_bundle(*snap, sink); };
+        };
+        mount_route(reg, std::move(spec));
+      }
+
+      // POST /p2p/admin/hook (heavy + auth)
+      {
+        RouteSpec spec;
+        spec.method = "POST";
+        spec.path = join_prefix(base, "/admin/hook");
+        spec.id = RouteId::Admin;
+        spec.ro.heavy = true;
+        spec.ro.require_auth = true;
+        spec.handler = [](const RouteRequest &, RouteReply &out)
+        {
+          reply_json(out, 501, J::Json{
+                                   {"ok", false},
+                                   {"status", 501},
+                                   {"error", "not_implemented"},
+                                   {"message", "p2p_http: admin endpoint planned"},
+                               });
+        };
+        mount_route(reg, std::move(spec));
+      }
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
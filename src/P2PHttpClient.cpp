@@ -0,0 +1,909 @@
+/**
+ *
+ *  @file P2PHttpClient.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/P2PHttpClient.hpp>
+
+#include "detail/ClientJson.hpp"
+
+#include <vix/json/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VIX_P2P_HTTP_HAS_CLIENT_SOCKETS 1
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace J = vix::json;
+
+namespace vix::p2p_http
+{
+  using detail::json_bool;
+  using detail::json_ll;
+  using detail::json_str;
+
+  namespace
+  {
+    constexpr std::size_t k_max_head_bytes = 64 * 1024;
+    constexpr std::size_t k_max_body_bytes = 64 * 1024 * 1024;
+
+    // Requests written back to back by connect() before reading replies.
+    constexpr std::size_t k_pipeline_depth = 32;
+
+    // Media type of GET /peers.arrow (ClientOptions::peers_arrow).
+    constexpr std::string_view k_arrow_stream_type = "application/vnd.apache.arrow.stream";
+
+    bool iequals(std::string_view a, std::string_view b) noexcept
+    {
+      return a.size() == b.size() &&
+             std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+                        { return std::tolower((unsigned char)x) == std::tolower((unsigned char)y); });
+    }
+
+    std::string_view trim(std::string_view s) noexcept
+    {
+      while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+      while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+        s.remove_suffix(1);
+      return s;
+    }
+
+    void append_url_encoded(std::string &out, std::string_view s)
+    {
+      static const char hex[] = "0123456789ABCDEF";
+      for (const char c : s)
+      {
+        const auto u = (unsigned char)c;
+        if (std::isalnum(u) || c == '-' || c == '_' || c == '.' || c == '~')
+          out.push_back(c);
+        else
+        {
+          out.push_back('%');
+          out.push_back(hex[u >> 4]);
+          out.push_back(hex[u & 15]);
+        }
+      }
+    }
+
+    void add_query(std::string &target, std::string_view key, std::string_view value)
+    {
+      if (value.empty())
+        return;
+      target.push_back(target.find('?') == std::string::npos ? '?' : '&');
+      target.append(key);
+      target.push_back('=');
+      append_url_encoded(target, value);
+    }
+
+    StatusCounters read_counters(const J::Json &j)
+    {
+      StatusCounters c;
+      c.peers_total = json_ll(j, "peers_total");
+      c.peers_connected = json_ll(j, "peers_connected");
+      c.handshakes_started = json_ll(j, "handshakes_started");
+      c.handshakes_completed = json_ll(j, "handshakes_completed");
+      c.connect_attempts = json_ll(j, "connect_attempts");
+      c.connect_deduped = json_ll(j, "connect_deduped");
+      c.connect_failures = json_ll(j, "connect_failures");
+      c.backoff_skips = json_ll(j, "backoff_skips");
+      c.tracked_endpoints = json_ll(j, "tracked_endpoints");
+      return c;
+    }
+
+#if defined(VIX_P2P_HTTP_HAS_CLIENT_SOCKETS)
+    int send_flags() noexcept
+    {
+#if defined(MSG_NOSIGNAL)
+      return MSG_NOSIGNAL;
+#else
+      return 0;
+#endif
+    }
+
+    bool wait_fd(int fd, short events, int timeout_ms)
+    {
+      pollfd p{};
+      p.fd = fd;
+      p.events = events;
+      for (;;)
+      {
+        const int n = ::poll(&p, 1, timeout_ms);
+        if (n < 0 && errno == EINTR)
+          continue;
+        return n > 0;
+      }
+    }
+
+    bool write_all(int fd, std::string_view data, int timeout_ms)
+    {
+      while (!data.empty())
+      {
+        const ssize_t n = ::send(fd, data.data(), data.size(), send_flags());
+        if (n > 0)
+        {
+          data.remove_prefix(static_cast<std::size_t>(n));
+          continue;
+        }
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && wait_fd(fd, POLLOUT, timeout_ms))
+          continue;
+        return false;
+      }
+      return true;
+    }
+
+    // Sequential HTTP/1.1 reply reader over one connection. Bytes read past
+    // one reply stay buffered for the next (pipelining).
+    class ReplyReader
+    {
+    public:
+      ReplyReader(int fd, int timeout_ms) : fd_(fd), timeout_ms_(timeout_ms) {}
+
+      // Read the reply to a `method` request. `any_bytes` tells whether the
+      // server sent anything, i.e. whether a failed exchange on a reused
+      // connection may be retried.
+      bool read(std::string_view method, ClientResponse &out, bool &keep_alive, bool &any_bytes)
+      {
+        any_bytes = !buf_.empty();
+        keep_alive = false;
+
+        std::size_t head_end;
+        while ((head_end = buf_.find("\r\n\r\n")) == std::string::npos)
+        {
+          if (buf_.size() > k_max_head_bytes)
+            return fail(out, "reply_headers_too_large");
+          if (!fill())
+            return fail(out, buf_.empty() ? "connection_closed" : "truncated_reply");
+          any_bytes = true;
+        }
+
+        const std::string_view head(buf_.data(), head_end);
+        const auto line_end = head.find("\r\n");
+        const std::string_view status_line = head.substr(0, line_end);
+
+        // "HTTP/1.1 200 OK"
+        if (status_line.size() < 12 || status_line.substr(0, 5) != "HTTP/")
+          return fail(out, "invalid_status_line");
+        const bool http10 = status_line.substr(5, 3) == "1.0";
+        int status = 0;
+        const auto sp = status_line.find(' ');
+        if (sp == std::string_view::npos ||
+            std::from_chars(status_line.data() + sp + 1, status_line.data() + status_line.size(), status).ec != std::errc())
+          return fail(out, "invalid_status_line");
+
+        std::optional<std::size_t> content_length;
+        bool chunked = false;
+        keep_alive = !http10;
+
+        std::string_view rest = line_end == std::string_view::npos ? std::string_view{} : head.substr(line_end + 2);
+        while (!rest.empty())
+        {
+          const auto eol = rest.find("\r\n");
+          const std::string_view line = rest.substr(0, eol);
+          rest = eol == std::string_view::npos ? std::string_view{} : rest.substr(eol + 2);
+
+          const auto colon = line.find(':');
+          if (colon == std::string_view::npos)
+            continue;
+          const std::string_view name = trim(line.substr(0, colon));
+          const std::string_view value = trim(line.substr(colon + 1));
+
+          if (iequals(name, "content-length"))
+          {
+            std::size_t n = 0;
+            if (std::from_chars(value.data(), value.data() + value.size(), n).ec != std::errc())
+              return fail(out, "invalid_content_length");
+            content_length = n;
+          }
+          else if (iequals(name, "transfer-encoding"))
+            chunked = value.find("chunked") != std::string_view::npos;
+          else if (iequals(name, "connection"))
+          {
+            if (iequals(value, "close"))
+              keep_alive = false;
+            else if (iequals(value, "keep-alive"))
+              keep_alive = true;
+          }
+          else if (iequals(name, "content-type"))
+            out.content_type = std::string(value);
+        }
+
+        out.status = status;
+        buf_.erase(0, head_end + 4);
+
+        // No body whatever the headers say (RFC 9112 6.3): a HEAD reply
+        // carries the GET reply's Content-Length.
+        if (method == "HEAD" || (status >= 100 && status < 200) || status == 204 || status == 304)
+          return true;
+
+        if (chunked)
+          return read_chunked(out);
+
+        if (content_length)
+        {
+          if (*content_length > k_max_body_bytes)
+            return fail(out, "reply_too_large");
+          while (buf_.size() < *content_length)
+          {
+            if (!fill())
+              return fail(out, "truncated_reply");
+          }
+          out.body.assign(buf_, 0, *content_length);
+          buf_.erase(0, *content_length);
+          return true;
+        }
+
+        // No framing: the body runs until the server closes.
+        keep_alive = false;
+        while (fill())
+        {
+          if (buf_.size() > k_max_body_bytes)
+            return fail(out, "reply_too_large");
+        }
+        out.body = std::move(buf_);
+        buf_.clear();
+        return true;
+      }
+
+      bool drained() const noexcept { return buf_.empty(); }
+
+    private:
+      bool read_chunked(ClientResponse &out)
+      {
+        for (;;)
+        {
+          std::size_t eol;
+          while ((eol = buf_.find("\r\n")) == std::string::npos)
+          {
+            if (!fill())
+              return fail(out, "truncated_reply");
+          }
+
+          std::size_t size = 0;
+          if (std::from_chars(buf_.data(), buf_.data() + eol, size, 16).ec != std::errc())
+            return fail(out, "invalid_chunk");
+          buf_.erase(0, eol + 2);
+
+          if (size == 0)
+          {
+            // Skip trailers up to the blank line.
+            for (;;)
+            {
+              while ((eol = buf_.find("\r\n")) == std::string::npos)
+              {
+                if (!fill())
+                  return fail(out, "truncated_reply");
+              }
+              buf_.erase(0, eol + 2);
+              if (eol == 0)
+                return true;
+            }
+          }
+
+          if (out.body.size() + size > k_max_body_bytes)
+            return fail(out, "reply_too_large");
+          while (buf_.size() < size + 2)
+          {
+            if (!fill())
+              return fail(out, "truncated_reply");
+          }
+          out.body.append(buf_, 0, size);
+          buf_.erase(0, size + 2);
+        }
+      }
+
+      bool fill()
+      {
+        char tmp[16 * 1024];
+        for (;;)
+        {
+          const ssize_t n = ::recv(fd_, tmp, sizeof(tmp), 0);
+          if (n > 0)
+          {
+            buf_.append(tmp, static_cast<std::size_t>(n));
+            return true;
+          }
+          if (n == 0)
+            return false;
+          if (errno == EINTR)
+            continue;
+          if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_fd(fd_, POLLIN, timeout_ms_))
+            continue;
+          return false;
+        }
+      }
+
+      static bool fail(ClientResponse &out, const char *why)
+      {
+        out.status = 0;
+        out.error = why;
+        return false;
+      }
+
+      int fd_;
+      int timeout_ms_;
+      std::string buf_;
+    };
+
+    // The server closed an idle pooled connection if it polls readable.
+    bool looks_closed(int fd)
+    {
+      pollfd p{};
+      p.fd = fd;
+      p.events = POLLIN;
+      return ::poll(&p, 1, 0) != 0;
+    }
+#endif
+  }
+
+  P2PHttpClient::P2PHttpClient(ClientOptions opt) : opt_(std::move(opt))
+  {
+    base_ = opt_.prefix;
+    if (!base_.empty() && base_.front() != '/')
+      base_.insert(base_.begin(), '/');
+    while (!base_.empty() && base_.back() == '/')
+      base_.pop_back();
+  }
+
+  P2PHttpClient::~P2PHttpClient()
+  {
+    close_idle();
+  }
+
+  void P2PHttpClient::close_idle()
+  {
+    std::vector<Conn> idle;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      idle.swap(idle_);
+    }
+#if defined(VIX_P2P_HTTP_HAS_CLIENT_SOCKETS)
+    for (const auto &c : idle)
+      ::close(c.fd);
+#endif
+  }
+
+  ClientStats P2PHttpClient::stats() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    return stats_;
+  }
+
+  std::string P2PHttpClient::head(std::string_view method, std::string_view target, std::size_t body_len,
+                                  std::string_view content_type, std::string_view accept) const
+  {
+    std::string h;
+    h.reserve(160 + target.size());
+    h.append(method).push_back(' ');
+    h.append(base_).append(target).append(" HTTP/1.1\r\nHost: ");
+    h.append(opt_.unix_socket.empty() ? opt_.host : std::string("localhost"));
+    h.append("\r\nConnection: keep-alive\r\nAccept: ").append(accept).append("\r\n");
+    for (const auto &[name, value] : opt_.headers)
+      h.append(name).append(": ").append(value).append("\r\n");
+    if (body_len > 0 || method == "POST" || method == "PUT" || method == "PATCH")
+    {
+      h.append("Content-Type: ").append(content_type).append("\r\n");
+      h.append("Content-Length: ").append(std::to_string(body_len)).append("\r\n");
+    }
+    h.append("\r\n");
+    return h;
+  }
+
+#if defined(VIX_P2P_HTTP_HAS_CLIENT_SOCKETS)
+  P2PHttpClient::Conn P2PHttpClient::open(std::string &error)
+  {
+    Conn c;
+
+    if (!opt_.unix_socket.empty())
+    {
+      sockaddr_un addr{};
+      if (opt_.unix_socket.size() >= sizeof(addr.sun_path))
+      {
+        error = "socket_path_too_long";
+        return c;
+      }
+      addr.sun_family = AF_UNIX;
+      std::memcpy(addr.sun_path, opt_.unix_socket.c_str(), opt_.unix_socket.size() + 1);
+
+      c.fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (c.fd < 0 || ::connect(c.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+      {
+        error = std::string("connect_failed: ") + std::strerror(errno);
+        if (c.fd >= 0)
+          ::close(c.fd);
+        c.fd = -1;
+        return c;
+      }
+    }
+    else
+    {
+      addrinfo hints{};
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      addrinfo *res = nullptr;
+      const std::string port = std::to_string(opt_.port);
+      if (const int rc = ::getaddrinfo(opt_.host.c_str(), port.c_str(), &hints, &res); rc != 0)
+      {
+        error = std::string("resolve_failed: ") + ::gai_strerror(rc);
+        return c;
+      }
+
+      error = "connect_failed";
+      for (addrinfo *ai = res; ai; ai = ai->ai_next)
+      {
+        const int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+          continue;
+
+        // Non-blocking connect bounded by connect_timeout_ms.
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc != 0 && errno == EINPROGRESS && wait_fd(fd, POLLOUT, opt_.connect_timeout_ms))
+        {
+          int err = 0;
+          socklen_t len = sizeof(err);
+          ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+          rc = err == 0 ? 0 : -1;
+          errno = err;
+        }
+        if (rc == 0)
+        {
+          c.fd = fd;
+          break;
+        }
+        error = std::string("connect_failed: ") + std::strerror(errno ? errno : ETIMEDOUT);
+        ::close(fd);
+      }
+      ::freeaddrinfo(res);
+      if (c.fd < 0)
+        return c;
+
+      const int one = 1;
+      ::setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+#if defined(SO_NOSIGPIPE)
+    const int one = 1;
+    ::setsockopt(c.fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    ::fcntl(c.fd, F_SETFL, ::fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+
+    error.clear();
+    std::lock_guard<std::mutex> lock(mu_);
+    ++stats_.connections_opened;
+    return c;
+  }
+
+  P2PHttpClient::Conn P2PHttpClient::acquire(bool &reused, std::string &error)
+  {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<int> stale;
+    Conn c;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      while (!idle_.empty())
+      {
+        Conn top = idle_.back();
+        idle_.pop_back();
+        if (now - top.idle_since > std::chrono::milliseconds(opt_.idle_timeout_ms) || looks_closed(top.fd))
+        {
+          stale.push_back(top.fd);
+          continue;
+        }
+        c = top;
+        ++stats_.connections_reused;
+        break;
+      }
+    }
+    for (const int fd : stale)
+      ::close(fd);
+
+    reused = c.fd >= 0;
+    if (!reused)
+      c = open(error);
+    if (c.fd >= 0)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      busy_.push_back(c.fd);
+    }
+    return c;
+  }
+
+  void P2PHttpClient::release(Conn c)
+  {
+    c.idle_since = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      busy_.erase(std::find(busy_.begin(), busy_.end(), c.fd));
+      if (idle_.size() < opt_.max_idle_connections)
+      {
+        idle_.push_back(c);
+        return;
+      }
+    }
+    ::close(c.fd);
+  }
+
+  void P2PHttpClient::discard(Conn c)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      busy_.erase(std::find(busy_.begin(), busy_.end(), c.fd));
+    }
+    ::close(c.fd);
+  }
+
+  void P2PHttpClient::interrupt()
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    ++interrupts_;
+    for (const int fd : busy_)
+      ::shutdown(fd, SHUT_RDWR);
+  }
+
+  ClientResponse P2PHttpClient::request(std::string_view method,
+                                        std::string_view target,
+                                        std::string_view body,
+                                        std::string_view content_type,
+                                        bool replay)
+  {
+    return send(method, target, body, content_type, replay, "application/json");
+  }
+
+  ClientResponse P2PHttpClient::send(std::string_view method,
+                                     std::string_view target,
+                                     std::string_view body,
+                                     std::string_view content_type,
+                                     bool replay,
+                                     std::string_view accept)
+  {
+    // The server may have acted on a request and then closed before
+    // replying; only resend what is harmless to apply twice.
+    replay = replay || method == "GET" || method == "HEAD";
+
+    std::string wire = head(method, target, body.size(), content_type, accept);
+    wire.append(body);
+
+    std::uint64_t interrupts = 0;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      ++stats_.requests;
+      interrupts = interrupts_;
+    }
+
+    ClientResponse out;
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+      bool reused = false;
+      Conn c = acquire(reused, out.error);
+      if (c.fd < 0)
+        return out;
+
+      out = ClientResponse{};
+      ReplyReader reader(c.fd, opt_.io_timeout_ms);
+      bool keep_alive = false;
+      bool any_bytes = false;
+
+      const bool sent = write_all(c.fd, wire, opt_.io_timeout_ms);
+      if (sent && reader.read(method, out, keep_alive, any_bytes))
+      {
+        if (keep_alive && reader.drained())
+          release(c);
+        else
+          discard(c);
+        return out;
+      }
+
+      discard(c);
+      if (!sent)
+        out.error = "send_failed";
+
+      // A reused connection the server had already closed: try a fresh one.
+      if (!reused || any_bytes || !replay)
+        return out;
+
+      std::lock_guard<std::mutex> lock(mu_);
+      if (interrupts_ != interrupts)
+        return out;
+      ++stats_.retries;
+    }
+    return out;
+  }
+
+  std::vector<ConnectResult> P2PHttpClient::connect(const std::vector<ConnectTarget> &batch)
+  {
+    std::vector<ConnectResult> results(batch.size());
+    std::uint64_t interrupts = 0;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stats_.requests += batch.size();
+      interrupts = interrupts_;
+    }
+
+    std::size_t done = 0;
+    bool retried = false;
+    while (done < batch.size())
+    {
+      const std::size_t n = std::min(k_pipeline_depth, batch.size() - done);
+
+      std::string wire;
+      for (std::size_t i = done; i < done + n; ++i)
+      {
+        const std::string body = J::Json{
+            {"host", batch[i].host},
+            {"port", batch[i].port},
+            {"scheme", batch[i].scheme},
+        }.dump();
+        wire.append(head("POST", "/connect", body.size(), "application/json")).append(body);
+      }
+
+      bool reused = false;
+      std::string error;
+      Conn c = acquire(reused, error);
+      if (c.fd < 0)
+      {
+        for (std::size_t i = done; i < batch.size(); ++i)
+          results[i].error = error;
+        return results;
+      }
+
+      ReplyReader reader(c.fd, opt_.io_timeout_ms);
+      std::size_t got = 0;
+      bool keep_alive = write_all(c.fd, wire, opt_.io_timeout_ms);
+      bool any_bytes = false;
+      if (!keep_alive)
+        error = "send_failed";
+
+      while (keep_alive && got < n)
+      {
+        ClientResponse r;
+        if (!reader.read("POST", r, keep_alive, any_bytes))
+        {
+          error = r.error;
+          keep_alive = false;
+          break;
+        }
+
+        auto &res = results[done + got];
+        res.status = r.status;
+        const J::Json j = J::Json::parse(r.body, nullptr, false);
+        if (!j.is_discarded() && j.is_object())
+        {
+          res.started = json_bool(j, "started");
+          res.endpoint = json_str(j, "endpoint");
+          res.error = json_str(j, "error");
+        }
+        else if (!r.ok())
+          res.error = "HTTP " + std::to_string(r.status);
+        ++got;
+      }
+
+      if (keep_alive && reader.drained())
+        release(c);
+      else
+        discard(c);
+
+      // Nothing came back on a reused connection: replay on a fresh one.
+      // POST /connect may run twice; the node dedupes connect attempts.
+      if (got == 0 && reused && !any_bytes && !retried)
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (interrupts_ == interrupts)
+        {
+          retried = true;
+          ++stats_.retries;
+          continue;
+        }
+      }
+
+      done += got;
+      if (got < n)
+      {
+        for (std::size_t i = done; i < batch.size(); ++i)
+          results[i].error = error.empty() ? "connection_closed" : error;
+        return results;
+      }
+    }
+    return results;
+  }
+#else
+  P2PHttpClient::Conn P2PHttpClient::open(std::string &error)
+  {
+    error = "unsupported_platform";
+    return {};
+  }
+
+  P2PHttpClient::Conn P2PHttpClient::acquire(bool &reused, std::string &error)
+  {
+    reused = false;
+    return open(error);
+  }
+
+  void P2PHttpClient::release(Conn) {}
+
+  void P2PHttpClient::discard(Conn) {}
+
+  void P2PHttpClient::interrupt() {}
+
+  ClientResponse P2PHttpClient::request(std::string_view, std::string_view, std::string_view, std::string_view, bool)
+  {
+    ClientResponse out;
+    out.error = "unsupported_platform";
+    return out;
+  }
+
+  std::vector<ConnectResult> P2PHttpClient::connect(const std::vector<ConnectTarget> &batch)
+  {
+    std::vector<ConnectResult> results(batch.size());
+    for (auto &r : results)
+      r.error = "unsupported_platform";
+    return results;
+  }
+#endif
+
+  std::optional<ClientStatus> P2PHttpClient::status(std::string *error)
+  {
+    const auto j = detail::parse_client_reply(request("GET", "/status"), error);
+    if (!j)
+      return std::nullopt;
+
+    ClientStatus st;
+    st.ready = json_bool(*j, "ready");
+    st.draining = json_bool(*j, "draining");
+    st.in_flight = json_ll(*j, "in_flight");
+    st.counters = read_counters(*j);
+
+    if (const auto *per = J::jget(*j, "runtimes"); per && per->is_array())
+    {
+      for (const auto &one : *per)
+        st.runtimes.emplace_back(json_str(one, "name"), read_counters(one));
+    }
+    return st;
+  }
+
+  std::optional<std::vector<PeerInfo>> P2PHttpClient::peers(const PeerQuery &query, std::string *error)
+  {
+    std::string filters;
+    add_query(filters, "state", query.state);
+    add_query(filters, "scheme", query.scheme);
+    add_query(filters, "host", query.host);
+    add_query(filters, "runtime", query.runtime);
+
+    bool arrow = opt_.peers_arrow;
+    if (arrow)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      arrow = !peers_arrow_missing_;
+    }
+    if (arrow)
+    {
+      const auto r = send("GET", "/peers.arrow" + filters, {}, "application/json", false, k_arrow_stream_type);
+      if (r.status == 0)
+      {
+        if (error)
+          *error = r.error;
+        return std::nullopt;
+      }
+      if (r.ok() && r.content_type.rfind(k_arrow_stream_type, 0) == 0)
+      {
+        if (auto t = detail::read_arrow_stream(r.body))
+          return detail::peer_infos_from_arrow(*t);
+      }
+      else if (r.status == 404)
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        peers_arrow_missing_ = true;
+      }
+      // Anything else (older server, error reply, undecodable stream):
+      // the JSON route below answers or reports the error.
+    }
+
+    std::string target = "/peers" + filters;
+    add_query(target, "compact", "1");
+
+    const auto j = detail::parse_client_reply(request("GET", target), error);
+    if (!j)
+      return std::nullopt;
+
+    // Columnar reply; servers without ?compact send objects under "peers".
+    const auto *columns = J::jget(*j, "columns");
+    const auto *compact_rows = J::jget(*j, "rows");
+    if (columns && compact_rows)
+      return detail::peer_infos_from_columns(*columns, *compact_rows);
+
+    std::vector<PeerInfo> out;
+    const auto *rows = J::jget(*j, "peers");
+    if (!rows || !rows->is_array())
+      return out;
+
+    out.reserve(rows->size());
+    for (const auto &r : *rows)
+      out.push_back(detail::peer_info_from_json(r));
+    return out;
+  }
+
+  std::optional<LogBatch> P2PHttpClient::logs(std::uint64_t cursor, std::string *error)
+  {
+    const auto j = detail::parse_client_reply(request("GET", "/logs?since=" + std::to_string(cursor)), error);
+    if (!j)
+      return std::nullopt;
+
+    LogBatch b;
+    b.cursor = static_cast<std::uint64_t>(json_ll(*j, "cursor"));
+    b.dropped = static_cast<std::uint64_t>(json_ll(*j, "dropped"));
+    if (const auto *lines = J::jget(*j, "lines"); lines && lines->is_array())
+    {
+      b.lines.reserve(lines->size());
+      for (const auto &l : *lines)
+      {
+        if (l.is_string())
+          b.lines.push_back(l.get<std::string>());
+      }
+    }
+    if (const auto *ts = J::jget(*j, "ts"); ts && ts->is_array() && ts->size() == b.lines.size())
+    {
+      b.ts.reserve(ts->size());
+      for (const auto &t : *ts)
+        b.ts.push_back(t.is_string() ? t.get<std::string>() : std::string());
+    }
+    return b;
+  }
+
+  std::uint64_t P2PHttpClient::streamLogs(std::uint64_t cursor,
+                                          const std::function<bool(std::string_view)> &on_line,
+                                          const std::atomic<bool> *stop,
+                                          std::chrono::milliseconds poll_every)
+  {
+    constexpr auto k_stop_check = std::chrono::milliseconds(50);
+
+    while (!stop || !stop->load())
+    {
+      auto batch = logs(cursor);
+      if (!batch)
+        break;
+
+      cursor = batch->cursor;
+      for (const auto &line : batch->lines)
+      {
+        if (!on_line(line))
+          return cursor;
+      }
+      if (!batch->lines.empty())
+        continue;
+
+      // Sleep in short steps so `stop` is noticed promptly.
+      const auto until = std::chrono::steady_clock::now() + poll_every;
+      while ((!stop || !stop->load()) && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::min<std::chrono::milliseconds>(
+            k_stop_check,
+            std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::steady_clock::now())));
+    }
+    return cursor;
+  }
+
+} // namespace vix::p2p_http
@@ -0,0 +1,532 @@
+/**
+ *
+ *  @file P2PHttpCore.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttp.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+#include <vix/p2p_http/RouteOptions.hpp>
+
+#include "detail/ConfigWatcher.hpp"
+#include "detail/LiveConfig.hpp"
+#include "detail/LocalHttp.hpp"
+#include "detail/MemoryBudget.hpp"
+#include "detail/RouteMetrics.hpp"
+#include "detail/RouteSupport.hpp"
+#include "detail/RouteTable.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/ThreadTuning.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#include <vix/p2p/P2P.hpp>
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace J = vix::json;
+
+// Registration core: runtime set, live config, lazy mode, module log lines
+// and the ping/status routes. The other route units plug in through
+// install_unit() and are only linked when something references them.
+namespace vix::p2p_http
+{
+  using detail::join_prefix;
+
+  static std::array<std::atomic<const detail::UnitHooks *>, static_cast<std::size_t>(detail::Unit::Count)> g_units{};
+
+  template <class F>
+  static void each_unit(F &&f)
+  {
+    for (const auto &slot : g_units)
+    {
+      if (const detail::UnitHooks *h = slot.load(std::memory_order_acquire))
+        f(*h);
+    }
+  }
+
+  static detail::ConfigWatcher g_config_watcher;
+  static detail::LocalHttpServer g_admin_socket;
+
+  // Lazy mode: the log sink and ticker start on the first relevant request
+  // and the ticker exits again after lazy_idle_ms without one.
+  static std::atomic<bool> g_lazy{false};
+  static std::atomic<int> g_lazy_idle_ms{60000};
+  static std::atomic<long long> g_last_activity_ms{0};
+
+  static std::atomic<long long> g_warm_up_us{-1};
+
+  // /status body built by warm-up, served to the first request unless the
+  // runtimes changed meanwhile (see runtime_change_mark()).
+  static std::mutex g_warm_status_mu;
+  static const detail::RuntimeSet *g_warm_status_set = nullptr;
+  static std::uint64_t g_warm_status_mark = 0;
+  static std::string g_warm_status;
+
+  static std::function<void(std::string)> g_external_sink = nullptr;
+
+  void set_live_log_sink(std::function<void(std::string)> sink)
+  {
+    g_external_sink = std::move(sink);
+  }
+
+  void set_draining(bool on)
+  {
+    detail::set_draining(on);
+    each_unit([on](const detail::UnitHooks &h)
+              { if (h.drain) h.drain(on); });
+  }
+
+  bool is_draining()
+  {
+    return detail::draining();
+  }
+
+  std::uint64_t in_flight_requests()
+  {
+    return detail::in_flight();
+  }
+
+  void shutdown_live_logs()
+  {
+    g_config_watcher.stop();
+    each_unit([](const detail::UnitHooks &h)
+              { if (h.shutdown) h.shutdown(); });
+    g_admin_socket.stop();
+  }
+
+  namespace detail
+  {
+    Registration::Registration(vix::App &a, RuntimeSetPtr r, const P2PHttpOptions &o, bool per_rt)
+        : app(a), rts(std::move(r)), opt(o), base(base_prefix(o)), per_runtime(per_rt)
+    {
+    }
+
+    void install_unit(Unit unit, const UnitHooks *hooks)
+    {
+      g_units[static_cast<std::size_t>(unit)].store(hooks, std::memory_order_release);
+    }
+
+    static void tap_line(std::string_view line)
+    {
+      each_unit([line](const UnitHooks &h)
+                { if (h.tap) h.tap(line); });
+    }
+
+    void log_line(std::string line)
+    {
+      tap_line(line);
+      if (g_external_sink)
+      {
+        g_external_sink(std::move(line));
+        return;
+      }
+      each_unit([&line](const UnitHooks &h)
+                { if (h.log) h.log(std::move(line)); });
+    }
+
+    void push_log(const P2PHttpOptions *opt, std::string line)
+    {
+      tap_line(line);
+      if (opt && opt->log_sink)
+      {
+        opt->log_sink(line);
+        return;
+      }
+      each_unit([&line](const UnitHooks &h)
+                { if (h.log) h.log(std::move(line)); });
+    }
+
+    long long steady_now_ms()
+    {
+      return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+    }
+
+    long long wall_now_ms()
+    {
+      return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    void lazy_touch()
+    {
+      if (!g_lazy.load(std::memory_order_relaxed))
+        return;
+
+      g_last_activity_ms.store(steady_now_ms(), std::memory_order_relaxed);
+      each_unit([](const UnitHooks &h)
+                { if (h.touch) h.touch(); });
+    }
+
+    bool lazy_enabled()
+    {
+      return g_lazy.load();
+    }
+
+    bool lazy_idle_expired()
+    {
+      return g_lazy.load() &&
+             steady_now_ms() - g_last_activity_ms.load() > g_lazy_idle_ms.load();
+    }
+
+    void lazy_release()
+    {
+      each_unit([](const UnitHooks &h)
+                { if (h.idle) h.idle(); });
+    }
+
+    void tick_units(const RuntimeSet &set)
+    {
+      each_unit([&set](const UnitHooks &h)
+                { if (h.tick) h.tick(set); });
+    }
+
+    void add_stats(vix::p2p::RuntimeStats &sum, const vix::p2p::RuntimeStats &st)
+    {
+      sum.peers_total += st.peers_total;
+      sum.peers_connected += st.peers_connected;
+      sum.handshakes_started += st.handshakes_started;
+      sum.handshakes_completed += st.handshakes_completed;
+      sum.connect.connect_attempts += st.connect.connect_attempts;
+      sum.connect.connect_deduped += st.connect.connect_deduped;
+      sum.connect.connect_failures += st.connect.connect_failures;
+      sum.connect.backoff_skips += st.connect.backoff_skips;
+      sum.connect.tracked_endpoints += st.connect.tracked_endpoints;
+    }
+
+    std::uint64_t runtime_change_mark(const RuntimeSet &set)
+    {
+      std::uint64_t h = 1469598103934665603ull; // FNV-1a
+      auto mix = [&h](std::uint64_t v)
+      { h = (h ^ v) * 1099511628211ull; };
+      for (const auto &e : set)
+      {
+        const auto st = e.runtime->runtime_stats();
+        mix(st.peers_total);
+        mix(st.peers_connected);
+        mix(st.handshakes_started);
+        mix(st.handshakes_completed);
+        mix(st.connect.connect_attempts);
+        mix(st.connect.connect_failures);
+        mix(st.connect.tracked_endpoints);
+      }
+      mix(draining() ? 1 : 0);
+      return h;
+    }
+
+    vix::p2p::RuntimeStats total_stats(const RuntimeSet &set)
+    {
+      vix::p2p::RuntimeStats sum{};
+      for (const auto &e : set)
+        add_stats(sum, e.runtime->runtime_stats());
+      return sum;
+    }
+
+    static void put_runtime_stats(J::Json &out, const vix::p2p::RuntimeStats &st)
+    {
+      out["peers_total"] = (long long)st.peers_total;
+      out["peers_connected"] = (long long)st.peers_connected;
+      out["handshakes_started"] = (long long)st.handshakes_started;
+      out["handshakes_completed"] = (long long)st.handshakes_completed;
+
+      out["connect_attempts"] = (long long)st.connect.connect_attempts;
+      out["connect_deduped"] = (long long)st.connect.connect_deduped;
+      out["connect_failures"] = (long long)st.connect.connect_failures;
+      out["backoff_skips"] = (long long)st.connect.backoff_skips;
+      out["tracked_endpoints"] = (long long)st.connect.tracked_endpoints;
+    }
+
+    // Per-route requests, rejections and handler time, keyed by route_name().
+    static J::Json route_counters_json()
+    {
+      J::Json routes = J::Json::object();
+      for (std::size_t i = 0; i < static_cast<std::size_t>(RouteId::Count); ++i)
+      {
+        const auto id = static_cast<RouteId>(i);
+        const auto &c = route_counters(id);
+        routes[route_name(id)] = J::Json{
+            {"requests", (long long)c.requests.load(std::memory_order_relaxed)},
+            {"rejected", (long long)c.rejected.load(std::memory_order_relaxed)},
+            {"total_us", (long long)c.total_us.load(std::memory_order_relaxed)},
+        };
+      }
+      return routes;
+    }
+
+    // Serialize GET /status. Several runtimes: counters are summed and each
+    // runtime is listed under "runtimes".
+    std::string build_status_body(const RuntimeSet &set)
+    {
+      J::Json out = {
+          {"ok", true},
+          {"module", "p2p_http"},
+
+          {"ready", !draining()},
+          {"draining", draining()},
+          {"in_flight", (long long)in_flight()},
+          {"route_counters", route_counters_json()},
+
+          {"lazy", g_lazy.load()},
+          {"ticker_running", false},
+          {"warm_up_us", g_warm_up_us.load()},
+
+          {"threads", thread_policy_json()},
+      };
+      each_unit([&out](const UnitHooks &h)
+                { if (h.status) h.status(out); });
+
+      if (set.size() == 1)
+      {
+        put_runtime_stats(out, set.front().runtime->runtime_stats());
+        if (!set.front().name.empty())
+          out["runtime"] = set.front().name;
+        return out.dump();
+      }
+
+      J::Json per = J::Json::array();
+      vix::p2p::RuntimeStats sum{};
+      for (const auto &e : set)
+      {
+        const auto st = e.runtime->runtime_stats();
+
+        J::Json one = {{"name", e.name}};
+        put_runtime_stats(one, st);
+        per.push_back(std::move(one));
+
+        add_stats(sum, st);
+      }
+
+      put_runtime_stats(out, sum);
+      out["runtimes"] = std::move(per);
+      return out.dump();
+    }
+
+    std::vector<BundleFile> capture_unit_bundles(const RuntimeSet &set)
+    {
+      std::vector<BundleFile> files;
+      each_unit([&](const UnitHooks &h)
+                { if (h.bundle) h.bundle(set, files); });
+      return files;
+    }
+
+    bool parse_u64(const std::string &text, std::uint64_t &out)
+    {
+      const auto *first = text.data();
+      const auto *last = first + text.size();
+      const auto [ptr, ec] = std::from_chars(first, last, out);
+      return ec == std::errc() && ptr == last;
+    }
+
+    int export_format_from_query(const std::string &text, bool &exporting, ExportFormat &format, std::string &body)
+    {
+      exporting = false;
+      if (text.empty() || text == "json")
+        return 200;
+      if (!parse_export_format(text, format))
+      {
+        body = R"({"error":"invalid_format","hint":"json|ndjson|csv","ok":false})";
+        return 400;
+      }
+      exporting = true;
+      return 200;
+    }
+
+    // Eager warm-up: pay first-request costs (peer index, serializers,
+    // log slots) at registration instead of on the first dashboard hit.
+    static void warm_up(const RuntimeSet &set)
+    {
+      const auto t0 = std::chrono::steady_clock::now();
+
+      each_unit([&set](const UnitHooks &h)
+                { if (h.warm_up) h.warm_up(set); });
+
+      {
+        std::string body = build_status_body(set);
+        std::lock_guard<std::mutex> lock(g_warm_status_mu);
+        g_warm_status = std::move(body);
+        g_warm_status_set = &set;
+        g_warm_status_mark = runtime_change_mark(set);
+      }
+
+      const long long us = (long long)std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - t0)
+                               .count();
+      g_warm_up_us.store(us);
+      log_line("[p2p_http] warm-up done in " + std::to_string(us) + "us");
+    }
+
+    std::shared_ptr<Registration> begin_registration(vix::App &app,
+                                                     std::vector<NamedRuntime> runtimes,
+                                                     const P2PHttpOptions &opt,
+                                                     bool per_runtime)
+    {
+      auto rts = std::make_shared<RuntimeSet>();
+      for (auto &e : runtimes)
+      {
+        if (e.runtime && (!per_runtime || !e.name.empty()))
+          rts->push_back(std::move(e));
+      }
+
+      if (rts->empty())
+      {
+        push_log(&opt, "[p2p_http] registerRuntimes: no named runtime, nothing mounted");
+        return nullptr;
+      }
+
+      ThreadPolicy policy;
+      policy.cpus = opt.thread_cpus;
+      policy.nice = opt.thread_nice;
+      policy.sched_batch = opt.thread_sched_batch;
+      set_thread_policy(std::move(policy));
+
+      g_lazy.store(opt.lazy_start);
+      g_lazy_idle_ms.store(opt.lazy_idle_ms <= 0 ? 60000 : opt.lazy_idle_ms);
+
+      init_live_config(opt);
+      memory_budget().set_limit(opt.memory_budget_bytes);
+
+      auto reg = std::make_shared<Registration>(app, std::move(rts), opt, per_runtime);
+      if (!opt.admin_socket_path.empty())
+      {
+        g_admin_socket.stop();
+        g_admin_socket.clear_routes();
+        reg->socket = &g_admin_socket;
+      }
+      return reg;
+    }
+
+    void end_registration(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+
+      push_log(&opt, "[p2p_http] routes registered");
+
+      if (!opt.config_file.empty())
+        g_config_watcher.start(opt.config_file, [](std::string line)
+                               { log_line(std::move(line)); });
+
+      if (opt.warm_up)
+        warm_up(*reg.rts);
+
+      if (reg.socket)
+      {
+        std::string error;
+        if (reg.socket->start(opt.admin_socket_path, opt.admin_socket_threads, &error))
+          log_line("[p2p_http] admin socket listening on " + opt.admin_socket_path);
+        else
+          log_line("[p2p_http] admin socket disabled: " + error);
+      }
+    }
+
+    void mount_ping(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+      if (!opt.enable_ping)
+        return;
+
+      // GET /p2p/ping
+      RouteSpec spec;
+      spec.path = join_prefix(reg.base, "/ping");
+      spec.id = RouteId::Ping;
+      spec.enabled = [](const LiveConfig &c)
+      { return c.enable_ping; };
+      spec.handler = [](const RouteRequest &, RouteReply &out)
+      {
+        reply_json(out, 200, J::Json{{"ok", true}, {"pong", true}, {"module", "p2p_http"}});
+      };
+      mount_route(reg, std::move(spec));
+    }
+
+    // The warm-up body, once, if it is for `set` and nothing changed since.
+    static bool take_warm_status(const RuntimeSet &set, std::string &body)
+    {
+      std::lock_guard<std::mutex> lock(g_warm_status_mu);
+      if (g_warm_status_set != &set || g_warm_status.empty())
+        return false;
+
+      const bool unchanged = runtime_change_mark(set) == g_warm_status_mark;
+      if (unchanged)
+        body = std::move(g_warm_status);
+      std::string().swap(g_warm_status);
+      g_warm_status_set = nullptr;
+      return unchanged;
+    }
+
+    // GET .../status for `rts`.
+    static void mount_status_route(Registration &reg, const std::string &path, RuntimeSetPtr rts)
+    {
+      RouteSpec spec;
+      spec.path = path;
+      spec.id = RouteId::Status;
+      spec.touch = true;
+      spec.enabled = [](const LiveConfig &c)
+      { return c.enable_status; };
+      spec.handler = [rts](const RouteRequest &, RouteReply &out)
+      {
+        if (take_warm_status(*rts, out.body))
+          return;
+        out.body = build_status_body(*rts);
+      };
+      mount_route(reg, std::move(spec));
+    }
+
+    void mount_status(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+      if (!opt.enable_status)
+        return;
+
+      // GET /p2p/status
+      mount_status_route(reg, join_prefix(reg.base, "/status"), reg.rts);
+
+      // GET /p2p/ready  (503 while draining, for load balancers and rollouts)
+      {
+        RouteSpec spec;
+        spec.path = join_prefix(reg.base, "/ready");
+        spec.id = RouteId::Ready;
+        spec.handler = [](const RouteRequest &, RouteReply &out)
+        {
+          const bool is_draining = draining();
+          reply_json(out, is_draining ? 503 : 200, J::Json{
+                                                       {"ok", !is_draining},
+                                                       {"ready", !is_draining},
+                                                       {"draining", is_draining},
+                                                       {"in_flight", (long long)in_flight()},
+                                                   });
+        };
+        mount_route(reg, std::move(spec));
+      }
+
+      // GET /p2p/rt/{name}/status  (one runtime)
+      if (reg.per_runtime)
+      {
+        for (const auto &e : *reg.rts)
+        {
+          auto one = std::make_shared<RuntimeSet>(1, e);
+          mount_status_route(reg, join_prefix(join_prefix(reg.base, "/rt/" + e.name), "/status"), one);
+        }
+      }
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
@@ -0,0 +1,119 @@
+/**
+ *
+ *  @file P2PHttpLogFile.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+#include "detail/LogClock.hpp"
+#include "detail/LogFileWriter.hpp"
+#include "detail/MemoryBudget.hpp"
+#include "detail/RouteUnits.hpp"
+
+#include <vix/json/json.hpp>
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace J = vix::json;
+
+// Log file unit: every module line, through the core's log tap, stamped
+// and appended to a rotated file written by a background thread.
+namespace vix::p2p_http
+{
+  static detail::LogFileWriter g_log_file;
+
+  static J::Json log_file_status()
+  {
+    const detail::LogFileStats s = g_log_file.stats();
+    return J::Json{
+        {"path", g_log_file.path()},
+        {"running", g_log_file.running()},
+        {"lines", s.lines},
+        {"dropped", s.dropped},
+        {"bytes_written", s.bytes_written},
+        {"writes", s.writes},
+        {"fsyncs", s.fsyncs},
+        {"rotations", s.rotations},
+        {"write_errors", s.write_errors},
+        {"backend", g_log_file.backend()},
+        {"backend_note", g_log_file.backend_note()},
+        {"syscalls", s.syscalls},
+        {"last_error", g_log_file.last_error()},
+    };
+  }
+
+  static const detail::UnitHooks &log_file_hooks()
+  {
+    static const detail::UnitHooks hooks = []()
+    {
+      detail::UnitHooks h;
+      h.tap = [](std::string_view line)
+      { g_log_file.append(line); };
+      h.status = [](J::Json &out)
+      { out["log_file"] = log_file_status(); };
+      h.shutdown = []()
+      { g_log_file.stop(); };
+      return h;
+    }();
+    return hooks;
+  }
+
+  namespace detail
+  {
+    void mount_log_file(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+      install_unit(Unit::LogFile, nullptr);
+      g_log_file.stop();
+      if (opt.log_file_path.empty())
+        return;
+
+      init_log_clock();
+
+      LogFileConfig cfg;
+      cfg.path = opt.log_file_path;
+      cfg.max_bytes = opt.log_file_max_bytes;
+      cfg.rotate_every_s = opt.log_file_rotate_every_s;
+      cfg.keep = opt.log_file_keep;
+      cfg.flush_every_ms = opt.log_file_flush_every_ms;
+      cfg.fsync_every_ms = opt.log_file_fsync_every_ms;
+      cfg.max_pending_bytes = opt.log_file_max_pending_bytes;
+      if (!parse_persist_io(opt.log_file_io, cfg.io))
+        push_log(&opt, "[p2p_http] log file: unknown log_file_io '" + opt.log_file_io + "', using auto");
+
+      const PersistIoKind io = cfg.io;
+      std::string error;
+      if (!g_log_file.start(std::move(cfg), error))
+      {
+        push_log(&opt, "[p2p_http] log file disabled: " + error);
+        return;
+      }
+      if (io != PersistIoKind::Auto && !g_log_file.backend_note().empty())
+        push_log(&opt, "[p2p_http] log file: " + g_log_file.backend_note());
+
+      static std::once_flag budget_once;
+      std::call_once(budget_once, []()
+                     {
+        MemoryConsumer c;
+        c.name = "log_file_buffers";
+        c.priority = 35;
+        c.usage = []() { return g_log_file.bytes(); };
+        memory_budget().add(std::move(c)); });
+
+      install_unit(Unit::LogFile, &log_file_hooks());
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
@@ -0,0 +1,690 @@
+/**
+ *
+ *  @file P2PHttpLogs.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+#include <vix/p2p_http/RouteOptions.hpp>
+
+#include "detail/LiveConfig.hpp"
+#include "detail/LogClock.hpp"
+#include "detail/MemoryBudget.hpp"
+#include "detail/RouteMetrics.hpp"
+#include "detail/RouteSupport.hpp"
+#include "detail/RouteTable.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/RowExport.hpp"
+#include "detail/StatsHistory.hpp"
+#include "detail/ThreadTuning.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#include <vix/p2p/P2P.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace J = vix::json;
+
+// Logs unit: log ring, p2p log sink, stats ticker and history, GET /logs.
+namespace vix::p2p_http
+{
+  using detail::join_prefix;
+
+  // A buffered line and its raw ingest stamp (detail::log_stamp()).
+  struct LogEntry
+  {
+    std::uint64_t stamp = 0;
+    std::string line;
+  };
+
+  // Bounded ring of log lines. Slots keep their capacity, so once the
+  // arena is warm a push copies into existing storage instead of allocating.
+  // Each line carries an 8-byte stamp, rendered only on output.
+  class LogBuffer
+  {
+  public:
+    explicit LogBuffer(std::size_t cap = 500) : cap_(cap == 0 ? 1 : cap), configured_(cap_) {}
+
+    void push(std::string line)
+    {
+      const std::uint64_t stamp = detail::log_stamp();
+
+      std::lock_guard<std::mutex> lock(mu_);
+      ++seq_;
+      if (count_ < cap_)
+      {
+        if (count_ < slots_.size())
+        {
+          store(slots_[count_], std::move(line));
+          stamps_[count_] = stamp;
+        }
+        else
+        {
+          slots_.push_back(std::move(line));
+          stamps_.push_back(stamp);
+        }
+        ++count_;
+        return;
+      }
+
+      store(slots_[head_], std::move(line));
+      stamps_[head_] = stamp;
+      head_ = (head_ + 1) % cap_;
+    }
+
+    void set_capacity(std::size_t cap)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      configured_ = (cap == 0 ? 1 : cap);
+      resize_locked(std::min(configured_, budget_cap_));
+    }
+
+    // Memory budget hooks. shrink() drops the oldest lines and lowers the
+    // capacity until about `want` bytes are freed; relax() lifts the cap.
+    std::size_t bytes() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      std::size_t n = (slots_.capacity() - slots_.size()) * sizeof(std::string);
+      for (const auto &s : slots_)
+        n += slot_bytes(s);
+      return n + stamps_.capacity() * sizeof(std::uint64_t);
+    }
+
+    std::size_t shrink(std::size_t want)
+    {
+      constexpr std::size_t k_min_lines = 16;
+
+      std::lock_guard<std::mutex> lock(mu_);
+      if (cap_ <= k_min_lines)
+        return 0;
+
+      // Oldest slot first; count what dropping each one would free.
+      std::size_t freed = 0;
+      std::size_t drop = 0;
+      while (cap_ - drop > k_min_lines && freed < want)
+      {
+        freed += (drop < count_) ? slot_bytes(slots_[(head_ + drop) % cap_]) : sizeof(std::string);
+        freed += sizeof(std::uint64_t);
+        ++drop;
+      }
+
+      budget_cap_ = cap_ - drop;
+      resize_locked(budget_cap_);
+      slots_.shrink_to_fit();
+      stamps_.shrink_to_fit();
+      return freed;
+    }
+
+    void relax()
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      budget_cap_ = static_cast<std::size_t>(-1);
+      resize_locked(configured_);
+    }
+
+    std::size_t capacity() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return cap_;
+    }
+
+    // Allocate every slot up front and touch it once.
+    void reserve_arena(std::size_t line_bytes)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      slots_.reserve(cap_);
+      while (slots_.size() < cap_)
+        slots_.emplace_back();
+      stamps_.resize(cap_);
+      for (auto &s : slots_)
+      {
+        if (s.capacity() < line_bytes)
+          s.reserve(line_bytes);
+      }
+    }
+
+    // One "<UTC time> <line>" per entry.
+    std::string dump() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      detail::LogTimeFormatter fmt;
+      std::ostringstream oss;
+      for (std::size_t i = 0; i < count_; ++i)
+      {
+        const std::size_t k = (head_ + i) % cap_;
+        oss << fmt.format(stamps_[k]) << ' ' << slots_[k] << "\n";
+      }
+      return oss.str();
+    }
+
+    std::uint64_t seq() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return seq_;
+    }
+
+    // Lines pushed after `cursor` (a value of seq()), oldest first, at most
+    // `max_lines` of them; `next` is the seq of the last one returned. Lines
+    // that already left the ring are counted in `dropped`.
+    std::vector<LogEntry> since(std::uint64_t cursor, std::uint64_t &next, std::uint64_t &dropped,
+                                std::size_t max_lines = static_cast<std::size_t>(-1)) const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      next = seq_;
+      dropped = 0;
+      if (cursor >= seq_)
+        return {};
+
+      const std::uint64_t oldest = seq_ - count_; // seq of the line before the oldest kept
+      if (cursor < oldest)
+      {
+        dropped = oldest - cursor;
+        cursor = oldest;
+      }
+
+      const std::size_t avail = static_cast<std::size_t>(seq_ - cursor);
+      const std::size_t n = std::min(avail, max_lines);
+      next = cursor + n;
+
+      std::vector<LogEntry> out;
+      out.reserve(n);
+      for (std::size_t i = count_ - avail; i < count_ - avail + n; ++i)
+      {
+        const std::size_t k = (head_ + i) % cap_;
+        out.push_back(LogEntry{stamps_[k], slots_[k]});
+      }
+      return out;
+    }
+
+  private:
+    void resize_locked(std::size_t cap)
+    {
+      cap = (cap == 0 ? 1 : cap);
+
+      // Linearize oldest-first, then drop the oldest lines that no longer fit.
+      std::rotate(slots_.begin(), slots_.begin() + (std::ptrdiff_t)head_, slots_.begin() + (std::ptrdiff_t)count_);
+      std::rotate(stamps_.begin(), stamps_.begin() + (std::ptrdiff_t)head_, stamps_.begin() + (std::ptrdiff_t)count_);
+      head_ = 0;
+      if (count_ > cap)
+      {
+        slots_.erase(slots_.begin(), slots_.begin() + (std::ptrdiff_t)(count_ - cap));
+        stamps_.erase(stamps_.begin(), stamps_.begin() + (std::ptrdiff_t)(count_ - cap));
+        count_ = cap;
+      }
+      if (slots_.size() > cap)
+        slots_.resize(cap);
+      if (stamps_.size() > cap)
+        stamps_.resize(cap);
+
+      cap_ = cap;
+    }
+
+    // Slot header plus its heap buffer, if it outgrew the inline storage.
+    static std::size_t slot_bytes(const std::string &s) noexcept
+    {
+      static const std::size_t inline_cap = std::string().capacity();
+      return sizeof(std::string) + (s.capacity() > inline_cap ? s.capacity() + 1 : 0);
+    }
+
+    static void store(std::string &slot, std::string &&line)
+    {
+      if (slot.capacity() >= line.size())
+        slot.assign(line);
+      else
+        slot = std::move(line);
+    }
+
+    std::size_t cap_;
+    std::size_t configured_;
+    std::size_t budget_cap_ = static_cast<std::size_t>(-1);
+    mutable std::mutex mu_;
+    std::vector<std::string> slots_;
+    std::vector<std::uint64_t> stamps_; // parallel to slots_
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::uint64_t seq_ = 0;
+  };
+
+  static LogBuffer g_logs{800};
+
+  // Summed counters per stats tick, for GET /admin/bundle.
+  static detail::StatsHistory g_stats_history{600};
+
+  // Slot size reserved by warm-up; typical "[p2p] ..." stats lines fit.
+  static constexpr std::size_t k_warm_log_line_bytes = 256;
+
+  static std::atomic<bool> g_tick_started{false};
+  static std::atomic<bool> g_tick_stop{false};
+  static std::thread g_tick_thread;
+  static std::mutex g_tick_mu;
+  static std::condition_variable g_tick_cv;
+  static std::mutex g_tick_wait_mu;
+  static std::atomic<std::shared_ptr<const detail::RuntimeSet>> g_tick_runtimes;
+
+  static std::atomic<bool> g_sink_installed{false};
+
+  static std::string stats_line_plain(const vix::p2p::RuntimeStats &st)
+  {
+    std::ostringstream oss;
+    oss
+        << "peers_total=" << st.peers_total
+        << " peers_connected=" << st.peers_connected
+        << " handshakes_started=" << st.handshakes_started
+        << " handshakes_completed=" << st.handshakes_completed
+        << " connect_attempts=" << st.connect.connect_attempts
+        << " connect_deduped=" << st.connect.connect_deduped
+        << " connect_failures=" << st.connect.connect_failures
+        << " backoff_skips=" << st.connect.backoff_skips
+        << " tracked_endpoints=" << st.connect.tracked_endpoints;
+    return oss.str();
+  }
+
+  // Stats ticker. Interval and on/off are read from the live config on
+  // every iteration, so PATCH /config takes effect without a restart.
+  static void start_stats_ticker()
+  {
+    std::lock_guard<std::mutex> lk(g_tick_mu);
+
+    if (g_tick_started.load() || g_tick_runtimes.load() == nullptr)
+      return;
+
+    // A lazy ticker that idled down has already returned; reap it.
+    if (g_tick_thread.joinable())
+      g_tick_thread.join();
+
+    g_tick_started.store(true);
+    g_tick_stop.store(false);
+
+    g_tick_thread = std::thread([]()
+                                {
+      const detail::ThreadPolicyScope policy("stats_ticker");
+
+      vix::p2p::RuntimeStats last{};
+      while (!g_tick_stop.load())
+      {
+        const auto cfg = detail::live_config();
+        const auto rts = g_tick_runtimes.load();
+
+        vix::p2p::RuntimeStats st{};
+        if (rts)
+        {
+          st = detail::total_stats(*rts);
+          g_stats_history.push(detail::StatsSample{detail::wall_now_ms(), st});
+          detail::tick_units(*rts);
+        }
+
+        if (rts && cfg->enable_live_logs && cfg->enable_logs)
+        {
+
+          const bool changed =
+            (st.peers_total != last.peers_total) ||
+            (st.peers_connected != last.peers_connected) ||
+            (st.handshakes_started != last.handshakes_started) ||
+            (st.handshakes_completed != last.handshakes_completed) ||
+            (st.connect.connect_attempts != last.connect.connect_attempts) ||
+            (st.connect.connect_deduped != last.connect.connect_deduped) ||
+            (st.connect.connect_failures != last.connect.connect_failures) ||
+            (st.connect.backoff_skips != last.connect.backoff_skips) ||
+            (st.connect.tracked_endpoints != last.connect.tracked_endpoints);
+
+          if (changed)
+          {
+            detail::log_line(std::string("[p2p] ") + stats_line_plain(st));
+            last = st;
+          }
+        }
+
+        detail::memory_budget().enforce();
+
+        if (detail::lazy_idle_expired())
+        {
+          // try_lock: shutdown_live_logs() holds g_tick_mu while joining us.
+          std::unique_lock<std::mutex> lk(g_tick_mu, std::try_to_lock);
+          if (lk.owns_lock() && detail::lazy_idle_expired())
+          {
+            detail::lazy_release();
+            g_tick_started.store(false);
+            return;
+          }
+        }
+
+        std::unique_lock<std::mutex> wait_lk(g_tick_wait_mu);
+        g_tick_cv.wait_for(wait_lk, std::chrono::milliseconds(cfg->stats_every_ms), []()
+                           { return g_tick_stop.load(); });
+      } });
+  }
+
+  static void stop_stats_ticker()
+  {
+    std::lock_guard<std::mutex> lk(g_tick_mu);
+
+    g_tick_stop.store(true);
+    {
+      std::lock_guard<std::mutex> wait_lk(g_tick_wait_mu);
+    }
+    g_tick_cv.notify_all();
+
+    if (g_tick_thread.joinable())
+      g_tick_thread.join();
+
+    vix::p2p::clear_global_log_sink();
+    g_sink_installed.store(false);
+    g_tick_started.store(false);
+    g_tick_runtimes.store(nullptr);
+  }
+
+  static void ensure_log_sink()
+  {
+    if (g_sink_installed.exchange(true))
+      return;
+
+    vix::p2p::set_global_log_sink([](std::string_view s)
+                                  { detail::log_line(std::string(s)); });
+  }
+
+  // GET /logs?format=ndjson|csv: buffered lines after `cursor`, as seq/line
+  // rows, copied out of the ring a page at a time. Lines pushed after the
+  // export started are left for the next cursor.
+  static bool export_logs(std::uint64_t cursor, detail::ExportFormat format, const detail::ChunkSink &sink)
+  {
+    constexpr std::size_t k_page_lines = 256;
+
+    detail::ExportWriter w(format, {"seq", "ts", "line"}, sink);
+    detail::LogTimeFormatter fmt;
+    const std::uint64_t end = g_logs.seq();
+    while (cursor < end)
+    {
+      std::uint64_t next = 0;
+      std::uint64_t dropped = 0;
+      const auto lines = g_logs.since(cursor, next, dropped,
+                                      static_cast<std::size_t>(std::min<std::uint64_t>(k_page_lines, end - cursor)));
+      if (lines.empty())
+        break;
+
+      std::uint64_t seq = next - lines.size();
+      for (const auto &e : lines)
+      {
+        w.begin_row();
+        w.field_int(static_cast<long long>(++seq));
+        w.field_str(fmt.format(e.stamp));
+        w.field_str(e.line);
+        w.end_row();
+      }
+      if (!w.flush_if_full())
+        return false;
+      cursor = next;
+    }
+    return w.finish();
+  }
+
+  // ?format= and ?since= of GET /logs. On 200 with `exporting`, `cursor`
+  // is where the export starts (0 = everything still buffered).
+  static int logs_export_params(const std::string &format_text,
+                                const std::string &since,
+                                bool &exporting,
+                                detail::ExportFormat &format,
+                                std::uint64_t &cursor,
+                                std::string &body)
+  {
+    if (const int status = detail::export_format_from_query(format_text, exporting, format, body); status != 200 || !exporting)
+      return status;
+
+    cursor = 0;
+    if (!since.empty() && !detail::parse_u64(since, cursor))
+    {
+      body = R"({"error":"invalid_cursor","hint":"since=<cursor from a previous reply>","ok":false})";
+      return 400;
+    }
+    return 200;
+  }
+
+  // GET /logs?since=<cursor> body. Returns the HTTP status.
+  // Reply: { "cursor": N, "dropped": D, "lines": [...], "ts": [...], "ok": true };
+  // pass "cursor" back as `since` to get only the lines pushed after it.
+  // "ts" holds the UTC time of each line, in the same order.
+  static int logs_since_reply(const std::string &since, std::string &body)
+  {
+    std::uint64_t cursor = 0;
+    if (!detail::parse_u64(since, cursor))
+    {
+      body = R"({"error":"invalid_cursor","hint":"since=<cursor from a previous reply>","ok":false})";
+      return 400;
+    }
+
+    std::uint64_t next = 0;
+    std::uint64_t dropped = 0;
+    const auto entries = g_logs.since(cursor, next, dropped);
+
+    detail::LogTimeFormatter fmt;
+    std::vector<std::string> lines;
+    std::vector<std::string> ts;
+    lines.reserve(entries.size());
+    ts.reserve(entries.size());
+    for (const auto &e : entries)
+    {
+      lines.push_back(e.line);
+      ts.emplace_back(fmt.format(e.stamp));
+    }
+
+    body = J::Json{
+        {"ok", true},
+        {"cursor", next},
+        {"dropped", dropped},
+        {"lines", lines},
+        {"ts", ts},
+    }.dump();
+    return 200;
+  }
+
+  // GET /admin/bundle: logs.ndjson and stats_history.ndjson. The rings are
+  // bounded, so their content is copied at capture time.
+  static void capture_logs_bundle(const detail::RuntimeSet &, std::vector<detail::BundleFile> &files)
+  {
+    auto logs = std::make_shared<std::vector<LogEntry>>();
+    std::uint64_t first_seq = 0;
+    if (detail::live_config()->enable_logs)
+    {
+      std::uint64_t next = 0;
+      std::uint64_t dropped = 0;
+      *logs = g_logs.since(0, next, dropped);
+      first_seq = next - logs->size() + 1;
+    }
+
+    files.push_back(detail::BundleFile{
+        "logs.ndjson", "log_lines", (long long)logs->size(),
+        [logs, first_seq](const detail::ChunkSink &out)
+        {
+          detail::ExportWriter w(detail::ExportFormat::Ndjson, {"seq", "ts", "line"}, out);
+          detail::LogTimeFormatter fmt;
+          std::uint64_t seq = first_seq;
+          for (const auto &e : *logs)
+          {
+            w.begin_row();
+            w.field_int(static_cast<long long>(seq++));
+            w.field_str(fmt.format(e.stamp));
+            w.field_str(e.line);
+            w.end_row();
+            if (!w.flush_if_full())
+              return false;
+          }
+          return w.finish();
+        }});
+
+    auto history = std::make_shared<const std::vector<detail::StatsSample>>(g_stats_history.snapshot());
+    files.push_back(detail::BundleFile{
+        "stats_history.ndjson", "stats_samples", (long long)history->size(),
+        [history](const detail::ChunkSink &out)
+        {
+          detail::ExportWriter w(detail::ExportFormat::Ndjson,
+                                 {"ts_ms", "peers_total", "peers_connected", "handshakes_started", "handshakes_completed",
+                                  "connect_attempts", "connect_deduped", "connect_failures", "backoff_skips", "tracked_endpoints"},
+                                 out);
+          for (const auto &h : *history)
+          {
+            const auto &st = h.stats;
+            w.begin_row();
+            w.field_int(h.ts_ms);
+            w.field_int((long long)st.peers_total);
+            w.field_int((long long)st.peers_connected);
+            w.field_int((long long)st.handshakes_started);
+            w.field_int((long long)st.handshakes_completed);
+            w.field_int((long long)st.connect.connect_attempts);
+            w.field_int((long long)st.connect.connect_deduped);
+            w.field_int((long long)st.connect.connect_failures);
+            w.field_int((long long)st.connect.backoff_skips);
+            w.field_int((long long)st.connect.tracked_endpoints);
+            w.end_row();
+            if (!w.flush_if_full())
+              return false;
+          }
+          return w.finish();
+        }});
+  }
+
+  static const detail::UnitHooks &logs_hooks()
+  {
+    static const detail::UnitHooks hooks = []()
+    {
+      detail::UnitHooks h;
+      h.log = [](std::string line)
+      { g_logs.push(std::move(line)); };
+      h.touch = []()
+      {
+        ensure_log_sink();
+        if (!g_tick_started.load())
+        {
+          const auto cfg = detail::live_config();
+          if (cfg->enable_live_logs && cfg->enable_logs)
+            start_stats_ticker();
+        }
+      };
+      h.warm_up = [](const detail::RuntimeSet &)
+      { g_logs.reserve_arena(k_warm_log_line_bytes); };
+      h.status = [](J::Json &out)
+      {
+        out["ticker_running"] = g_tick_started.load();
+        out["log_clock"] = detail::log_clock_source();
+      };
+      h.shutdown = []()
+      { stop_stats_ticker(); };
+      h.bundle = capture_logs_bundle;
+      return h;
+    }();
+    return hooks;
+  }
+
+  namespace detail
+  {
+    void mount_logs(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+
+      // Before the first line is stamped, not on it.
+      init_log_clock();
+
+      install_unit(Unit::Logs, &logs_hooks());
+
+      if (!opt.lazy_start)
+        ensure_log_sink();
+
+      g_logs.set_capacity(live_config()->log_capacity);
+      g_stats_history.set_capacity(opt.stats_history_len);
+      g_tick_runtimes.store(reg.rts);
+
+      static std::once_flag observers_once;
+      std::call_once(observers_once, []()
+                     { add_config_observer([](const LiveConfig &cfg)
+                                           {
+                         g_logs.set_capacity(cfg.log_capacity);
+                         if (cfg.enable_live_logs && cfg.enable_logs && !lazy_enabled())
+                           start_stats_ticker();
+                         g_tick_cv.notify_all(); }); });
+
+      static std::once_flag budget_once;
+      std::call_once(budget_once, []()
+                     {
+        auto &budget = memory_budget();
+
+        MemoryConsumer logs;
+        logs.name = "log_ring";
+        logs.priority = 20;
+        logs.usage = []() { return g_logs.bytes(); };
+        logs.shrink = [](std::size_t want) { return g_logs.shrink(want); };
+        logs.relax = []() { g_logs.relax(); };
+        budget.add(std::move(logs));
+
+        MemoryConsumer history;
+        history.name = "stats_history";
+        history.priority = 25;
+        history.usage = []() { return g_stats_history.bytes(); };
+        history.shrink = [](std::size_t want) { return g_stats_history.shrink(want); };
+        history.relax = []() { g_stats_history.relax(); };
+        budget.add(std::move(history)); });
+
+      if (opt.enable_live_logs && opt.enable_logs && !opt.lazy_start)
+        start_stats_ticker();
+
+      if (!opt.enable_logs)
+        return;
+
+      // GET /p2p/logs
+      RouteSpec spec;
+      spec.path = join_prefix(reg.base, "/logs");
+      spec.id = RouteId::Logs;
+      spec.touch = true;
+      spec.enabled = [](const LiveConfig &c)
+      { return c.enable_logs; };
+      spec.handler = [](const RouteRequest &req, RouteReply &out)
+      {
+        const std::string since = req.query("since");
+
+        bool exporting = false;
+        ExportFormat ef = ExportFormat::Ndjson;
+        std::uint64_t cursor = 0;
+        out.status = logs_export_params(req.query("format"), since, exporting, ef, cursor, out.body);
+        if (out.status != 200)
+          return;
+        if (exporting)
+        {
+          out.type = export_content_type(ef);
+          out.stream = [cursor, ef](const ChunkSink &sink)
+          { return export_logs(cursor, ef, sink); };
+          return;
+        }
+
+        if (!since.empty())
+        {
+          out.status = logs_since_reply(since, out.body);
+          return;
+        }
+        out.type = "text/plain; charset=utf-8";
+        out.body = g_logs.dump();
+      };
+      mount_route(reg, std::move(spec));
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
@@ -0,0 +1,634 @@
+/**
+ *
+ *  @file P2PHttpOtlp.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttpClient.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+#include "detail/MemoryBudget.hpp"
+#include "detail/Otlp.hpp"
+#include "detail/RouteMetrics.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/ThreadTuning.hpp"
+
+#include <vix/json/json.hpp>
+
+#include <vix/p2p/P2P.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace J = vix::json;
+
+// OTLP unit: samples RuntimeStats and the route counters, taps module log
+// lines, and pushes both to an OTLP/HTTP collector from its own thread.
+namespace vix::p2p_http
+{
+  namespace
+  {
+    std::uint64_t wall_now_ns()
+    {
+      return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    // "http://host:port[/path]"; the scheme and port are optional.
+    bool parse_endpoint(std::string_view url, std::string &host, int &port, std::string &path, std::string &error)
+    {
+      if (url.substr(0, 8) == "https://")
+      {
+        error = "https is not supported, use a local collector over http";
+        return false;
+      }
+      if (url.substr(0, 7) == "http://")
+        url.remove_prefix(7);
+
+      const std::size_t slash = url.find('/');
+      std::string_view authority = url.substr(0, slash);
+      path = slash == std::string_view::npos ? std::string() : std::string(url.substr(slash));
+      while (!path.empty() && path.back() == '/')
+        path.pop_back();
+
+      port = 4318;
+      const std::size_t colon = authority.rfind(':');
+      if (colon != std::string_view::npos)
+      {
+        const auto digits = authority.substr(colon + 1);
+        const auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), port);
+        if (ec != std::errc() || ptr != digits.data() + digits.size() || port <= 0 || port > 65535)
+        {
+          error = "invalid port";
+          return false;
+        }
+        authority = authority.substr(0, colon);
+      }
+      if (authority.empty())
+      {
+        error = "missing host";
+        return false;
+      }
+      host.assign(authority);
+      return true;
+    }
+
+    bool retryable(const ClientResponse &r)
+    {
+      return r.status == 0 || r.status == 429 || r.status == 502 || r.status == 503 || r.status == 504;
+    }
+  }
+
+  // Log records waiting for the next push. Slots keep their capacity, as in
+  // LogBuffer; when full the oldest record is dropped and counted. Records
+  // leave only once the collector accepted them (pop_through()).
+  class OtlpLogQueue
+  {
+  public:
+    void set_capacity(std::size_t cap)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      cap_ = cap == 0 ? 1 : cap;
+      slots_.clear();
+      slots_.shrink_to_fit();
+      head_ = count_ = 0;
+    }
+
+    // Returns true when `batch` records are now waiting.
+    bool push(std::uint64_t ts_ns, std::string_view line, std::size_t batch)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      ++seq_;
+      Slot *slot = nullptr;
+      if (count_ < cap_)
+      {
+        if (slots_.size() < cap_)
+          slots_.emplace_back();
+        slot = &slots_[(head_ + count_) % cap_];
+        ++count_;
+      }
+      else
+      {
+        slot = &slots_[head_];
+        head_ = (head_ + 1) % cap_;
+        ++dropped_;
+      }
+
+      slot->ts_ns = ts_ns;
+      slot->line.assign(line);
+      detail::make_valid_utf8(slot->line);
+      return count_ >= batch;
+    }
+
+    // Encode up to `max` of the oldest records; returns the seq of the last
+    // one (0 when empty) and their number in `n`.
+    std::uint64_t encode(detail::OtlpLogsEncoder &enc, std::size_t max, std::size_t &n) const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      n = std::min(count_, max);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        const Slot &s = slots_[(head_ + i) % cap_];
+        enc.record(s.ts_ns, s.ts_ns, s.line);
+      }
+      return n == 0 ? 0 : seq_ - count_ + n;
+    }
+
+    // Drop records up to `seq`, minus those the ring already overwrote.
+    void pop_through(std::uint64_t seq)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      const std::uint64_t oldest = seq_ - count_ + 1;
+      if (seq < oldest)
+        return;
+      const std::size_t n = (std::size_t)std::min<std::uint64_t>(count_, seq - oldest + 1);
+      head_ = (head_ + n) % cap_;
+      count_ -= n;
+    }
+
+    std::size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return count_;
+    }
+
+    std::uint64_t dropped() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return dropped_;
+    }
+
+    std::size_t bytes() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      std::size_t n = slots_.capacity() * sizeof(Slot);
+      for (const auto &s : slots_)
+        n += s.line.capacity();
+      return n;
+    }
+
+  private:
+    struct Slot
+    {
+      std::uint64_t ts_ns = 0;
+      std::string line;
+    };
+
+    mutable std::mutex mu_;
+    std::vector<Slot> slots_;
+    std::size_t cap_ = 1;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::uint64_t seq_ = 0;
+    std::uint64_t dropped_ = 0;
+  };
+
+  // Push thread. Metric samples are taken every push_every_ms into a
+  // bounded ring the thread alone touches; log records come through the
+  // core's log tap. A failed push keeps both and retries with backoff.
+  class OtlpExporter
+  {
+  public:
+    struct Config
+    {
+      std::string host;
+      int port = 4318;
+      std::string path;
+      std::string endpoint;
+      std::string service_name;
+      int push_every_ms = 10000;
+      std::size_t batch_size = 512;
+      std::size_t max_samples = 60;
+      std::size_t max_logs = 8192;
+    };
+
+    void start(Config cfg, detail::RuntimeSetPtr rts)
+    {
+      stop();
+
+      cfg_ = std::move(cfg);
+      rts_ = std::move(rts);
+      batch_size_.store(std::max<std::size_t>(cfg_.batch_size, 1));
+      {
+        std::lock_guard<std::mutex> lock(report_mu_);
+        endpoint_ = cfg_.endpoint;
+        last_error_.clear();
+      }
+      start_ns_ = wall_now_ns();
+      logs_.set_capacity(cfg_.max_logs);
+
+      samples_.assign(cfg_.max_samples == 0 ? 1 : cfg_.max_samples, Sample{});
+      for (auto &s : samples_)
+        s.runtimes.resize(rts_->size());
+      sample_head_ = sample_count_ = 0;
+      samples_bytes_.store(samples_.size() * (sizeof(Sample) + rts_->size() * sizeof(vix::p2p::RuntimeStats)));
+
+      stop_.store(false);
+      running_.store(true);
+      thread_ = std::thread([this]()
+                            { run(); });
+    }
+
+    void stop()
+    {
+      if (!thread_.joinable())
+        return;
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_.store(true);
+      }
+      cv_.notify_all();
+      thread_.join();
+      running_.store(false);
+    }
+
+    void tap(std::string_view line)
+    {
+      if (!running_.load(std::memory_order_relaxed))
+        return;
+      if (logs_.push(wall_now_ns(), line, batch_size_.load(std::memory_order_relaxed)) && !batch_ready_.exchange(true))
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        cv_.notify_all();
+      }
+    }
+
+    J::Json status() const
+    {
+      std::lock_guard<std::mutex> lock(report_mu_);
+      return J::Json{
+          {"endpoint", endpoint_},
+          {"running", running_.load()},
+          {"pushes", pushes_.load()},
+          {"push_failures", failures_.load()},
+          {"logs_sent", logs_sent_.load()},
+          {"logs_buffered", (long long)logs_.size()},
+          {"logs_dropped", logs_.dropped() + logs_rejected_.load()},
+          {"samples_buffered", (long long)samples_buffered_.load()},
+          {"samples_dropped", samples_dropped_.load()},
+          {"last_status", last_status_.load()},
+          {"last_error", last_error_},
+      };
+    }
+
+    std::size_t bytes() const
+    {
+      return logs_.bytes() + samples_bytes_.load() + payload_bytes_.load();
+    }
+
+  private:
+    struct RouteSnap
+    {
+      std::uint64_t requests = 0;
+      std::uint64_t rejected = 0;
+      std::uint64_t total_us = 0;
+    };
+
+    struct Sample
+    {
+      std::uint64_t ts_ns = 0;
+      std::vector<vix::p2p::RuntimeStats> runtimes;
+      std::array<RouteSnap, static_cast<std::size_t>(detail::RouteId::Count)> routes{};
+      std::uint64_t in_flight = 0;
+    };
+
+    void run()
+    {
+      const detail::ThreadPolicyScope policy("otlp_exporter");
+
+      ClientOptions co;
+      co.host = cfg_.host;
+      co.port = cfg_.port;
+      co.prefix = cfg_.path;
+      co.max_idle_connections = 1;
+      co.connect_timeout_ms = 1000;
+      P2PHttpClient client(co);
+
+      const auto every = std::chrono::milliseconds(cfg_.push_every_ms <= 0 ? 10000 : cfg_.push_every_ms);
+      auto next_sample = std::chrono::steady_clock::now();
+      int retry_ms = 0;
+
+      for (;;)
+      {
+        if (std::chrono::steady_clock::now() >= next_sample)
+        {
+          take_sample();
+          next_sample = std::chrono::steady_clock::now() + every;
+        }
+
+        batch_ready_.store(false);
+        const bool ok = push_all(client);
+        retry_ms = ok ? 0 : std::min(retry_ms == 0 ? 1000 : retry_ms * 2, 30000);
+
+        auto deadline = next_sample;
+        if (!ok)
+          deadline = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(retry_ms));
+
+        std::unique_lock<std::mutex> lock(mu_);
+        // A full batch only cuts the wait short while the collector answers.
+        cv_.wait_until(lock, deadline, [&]()
+                       { return stop_.load() || (ok && batch_ready_.load()); });
+        if (stop_.load())
+          break;
+      }
+
+      // Final flush, one attempt: the collector may be gone already.
+      take_sample();
+      push_all(client);
+    }
+
+    void take_sample()
+    {
+      Sample *s = nullptr;
+      if (sample_count_ < samples_.size())
+      {
+        s = &samples_[(sample_head_ + sample_count_) % samples_.size()];
+        ++sample_count_;
+      }
+      else
+      {
+        s = &samples_[sample_head_];
+        sample_head_ = (sample_head_ + 1) % samples_.size();
+        samples_dropped_.fetch_add(1);
+      }
+
+      s->ts_ns = wall_now_ns();
+      for (std::size_t i = 0; i < rts_->size(); ++i)
+        s->runtimes[i] = (*rts_)[i].runtime->runtime_stats();
+      for (std::size_t i = 0; i < s->routes.size(); ++i)
+      {
+        const auto &c = detail::route_counters(static_cast<detail::RouteId>(i));
+        s->routes[i] = RouteSnap{c.requests.load(), c.rejected.load(), c.total_us.load()};
+      }
+      s->in_flight = detail::in_flight();
+      samples_buffered_.store(sample_count_);
+    }
+
+    // Returns false when a push should be retried later.
+    bool push_all(P2PHttpClient &client)
+    {
+      if (sample_count_ > 0)
+      {
+        encode_metrics();
+        const ClientResponse r = send(client, "/v1/metrics");
+        if (!r.ok() && retryable(r))
+          return false;
+        sample_count_ = 0;
+        samples_buffered_.store(0);
+      }
+
+      // Drain in batches; records tapped meanwhile wait for the next round.
+      for (std::size_t left = logs_.size(); left > 0;)
+      {
+        payload_.clear();
+        std::size_t n = 0;
+        std::uint64_t last = 0;
+        {
+          detail::OtlpLogsEncoder enc(payload_, scope());
+          last = logs_.encode(enc, std::min(left, std::max<std::size_t>(cfg_.batch_size, 1)), n);
+          enc.finish();
+        }
+        if (n == 0)
+          break;
+
+        const ClientResponse r = send(client, "/v1/logs");
+        if (!r.ok() && retryable(r))
+          return false;
+        if (r.ok())
+          logs_sent_.fetch_add(n);
+        else
+          logs_rejected_.fetch_add(n);
+        logs_.pop_through(last);
+        left -= std::min(left, n);
+      }
+      return true;
+    }
+
+    detail::OtlpScope scope() const
+    {
+      detail::OtlpScope s;
+      s.service_name = cfg_.service_name;
+      s.scope_version = "0.1.0";
+      return s;
+    }
+
+    void encode_metrics()
+    {
+      using Kind = detail::OtlpMetricsEncoder::Kind;
+      using Stats = vix::p2p::RuntimeStats;
+
+      struct RuntimeMetric
+      {
+        const char *name;
+        const char *description;
+        Kind kind;
+        long long (*get)(const Stats &);
+      };
+      static constexpr RuntimeMetric k_runtime[] = {
+          {"p2p.peers.total", "Known peers", Kind::Gauge, [](const Stats &s) { return (long long)s.peers_total; }},
+          {"p2p.peers.connected", "Connected peers", Kind::Gauge, [](const Stats &s) { return (long long)s.peers_connected; }},
+          {"p2p.connect.tracked_endpoints", "Endpoints tracked by the connect backoff", Kind::Gauge, [](const Stats &s) { return (long long)s.connect.tracked_endpoints; }},
+          {"p2p.handshakes.started", "", Kind::CumulativeSum, [](const Stats &s) { return (long long)s.handshakes_started; }},
+          {"p2p.handshakes.completed", "", Kind::CumulativeSum, [](const Stats &s) { return (long long)s.handshakes_completed; }},
+          {"p2p.connect.attempts", "", Kind::CumulativeSum, [](const Stats &s) { return (long long)s.connect.connect_attempts; }},
+          {"p2p.connect.deduped", "", Kind::CumulativeSum, [](const Stats &s) { return (long long)s.connect.connect_deduped; }},
+          {"p2p.connect.failures", "", Kind::CumulativeSum, [](const Stats &s) { return (long long)s.connect.connect_failures; }},
+          {"p2p.connect.backoff_skips", "", Kind::CumulativeSum, [](const Stats &s) { return (long long)s.connect.backoff_skips; }},
+      };
+
+      struct RouteMetric
+      {
+        const char *name;
+        const char *unit;
+        const char *description;
+        std::uint64_t RouteSnap::*field;
+      };
+      static constexpr RouteMetric k_route[] = {
+          {"p2p_http.requests", "", "Requests handled per route", &RouteSnap::requests},
+          {"p2p_http.requests.rejected", "", "Requests rejected (drain, rate limit)", &RouteSnap::rejected},
+          {"p2p_http.request.time", "us", "Handler time summed over requests", &RouteSnap::total_us},
+      };
+
+      const std::size_t n = samples_.size();
+      auto sample = [&](std::size_t i) -> const Sample &
+      { return samples_[(sample_head_ + i) % n]; };
+
+      payload_.clear();
+      detail::OtlpMetricsEncoder enc(payload_, scope());
+
+      for (const auto &m : k_runtime)
+      {
+        enc.begin_metric(m.name, "", m.description, m.kind);
+        for (std::size_t i = 0; i < sample_count_; ++i)
+        {
+          const Sample &s = sample(i);
+          for (std::size_t r = 0; r < rts_->size(); ++r)
+          {
+            const std::string &name = (*rts_)[r].name;
+            enc.point(start_ns_, s.ts_ns, m.get(s.runtimes[r]), name.empty() ? "" : "runtime", name);
+          }
+        }
+        enc.end_metric();
+      }
+
+      for (const auto &m : k_route)
+      {
+        enc.begin_metric(m.name, m.unit, m.description, Kind::CumulativeSum);
+        for (std::size_t i = 0; i < sample_count_; ++i)
+        {
+          const Sample &s = sample(i);
+          for (std::size_t r = 0; r < s.routes.size(); ++r)
+            enc.point(start_ns_, s.ts_ns, (long long)(s.routes[r].*m.field),
+                      "route", detail::route_name(static_cast<detail::RouteId>(r)));
+        }
+        enc.end_metric();
+      }
+
+      enc.begin_metric("p2p_http.in_flight", "", "Requests executing a p2p_http handler", Kind::Gauge);
+      for (std::size_t i = 0; i < sample_count_; ++i)
+        enc.point(0, sample(i).ts_ns, (long long)sample(i).in_flight);
+      enc.end_metric();
+
+      enc.finish();
+    }
+
+    ClientResponse send(P2PHttpClient &client, std::string_view target)
+    {
+      payload_bytes_.store(payload_.capacity());
+      ClientResponse r = client.request("POST", target, payload_, "application/x-protobuf");
+      last_status_.store(r.status);
+      if (r.ok())
+      {
+        pushes_.fetch_add(1);
+        if (failing_)
+          detail::log_line("[p2p_http] otlp: collector reachable again");
+        failing_ = false;
+        return r;
+      }
+
+      failures_.fetch_add(1);
+      const std::string error = r.status == 0 ? r.error : "HTTP " + std::to_string(r.status);
+      {
+        std::lock_guard<std::mutex> lock(report_mu_);
+        last_error_ = error;
+      }
+      // Once per outage, not once per retry.
+      if (!failing_)
+        detail::log_line("[p2p_http] otlp: push to " + cfg_.endpoint + " failed: " + error);
+      failing_ = retryable(r);
+      return r;
+    }
+
+    Config cfg_;
+    detail::RuntimeSetPtr rts_;
+    std::uint64_t start_ns_ = 0;
+
+    OtlpLogQueue logs_;
+
+    // Exporter thread only.
+    std::vector<Sample> samples_;
+    std::size_t sample_head_ = 0;
+    std::size_t sample_count_ = 0;
+    std::string payload_;
+    bool failing_ = false;
+
+    std::thread thread_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> batch_ready_{false};
+    std::atomic<std::size_t> batch_size_{512};
+
+    std::atomic<std::uint64_t> pushes_{0};
+    std::atomic<std::uint64_t> failures_{0};
+    std::atomic<std::uint64_t> logs_sent_{0};
+    std::atomic<std::uint64_t> logs_rejected_{0};
+    std::atomic<std::size_t> samples_buffered_{0};
+    std::atomic<std::uint64_t> samples_dropped_{0};
+    std::atomic<int> last_status_{0};
+    std::atomic<std::size_t> samples_bytes_{0};
+    std::atomic<std::size_t> payload_bytes_{0};
+    mutable std::mutex report_mu_;
+    std::string endpoint_;
+    std::string last_error_;
+  };
+
+  static OtlpExporter g_otlp;
+
+  static const detail::UnitHooks &otlp_hooks()
+  {
+    static const detail::UnitHooks hooks = []()
+    {
+      detail::UnitHooks h;
+      h.tap = [](std::string_view line)
+      { g_otlp.tap(line); };
+      h.status = [](J::Json &out)
+      { out["otlp"] = g_otlp.status(); };
+      h.shutdown = []()
+      { g_otlp.stop(); };
+      return h;
+    }();
+    return hooks;
+  }
+
+  namespace detail
+  {
+    void mount_otlp(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+      g_otlp.stop();
+      install_unit(Unit::Otlp, nullptr);
+      if (opt.otlp_endpoint.empty())
+        return;
+
+      OtlpExporter::Config cfg;
+      std::string error;
+      if (!parse_endpoint(opt.otlp_endpoint, cfg.host, cfg.port, cfg.path, error))
+      {
+        push_log(&opt, "[p2p_http] otlp disabled: " + error);
+        return;
+      }
+      cfg.endpoint = opt.otlp_endpoint;
+      cfg.service_name = opt.otlp_service_name;
+      cfg.push_every_ms = opt.otlp_push_every_ms;
+      cfg.batch_size = opt.otlp_batch_size;
+      cfg.max_samples = opt.otlp_max_buffered_samples;
+      cfg.max_logs = opt.otlp_max_buffered_logs;
+
+      static std::once_flag budget_once;
+      std::call_once(budget_once, []()
+                     {
+        MemoryConsumer c;
+        c.name = "otlp_buffers";
+        c.priority = 30;
+        c.usage = []() { return g_otlp.bytes(); };
+        memory_budget().add(std::move(c)); });
+
+      g_otlp.start(std::move(cfg), reg.rts);
+      install_unit(Unit::Otlp, &otlp_hooks());
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
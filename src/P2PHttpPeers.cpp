@@ -0,0 +1,743 @@
+/**
+ *
+ *  @file P2PHttpPeers.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+#include <vix/p2p_http/RouteOptions.hpp>
+
+#include "detail/Interner.hpp"
+#include "detail/LiveConfig.hpp"
+#include "detail/MemoryBudget.hpp"
+#include "detail/PeerIndex.hpp"
+#include "detail/PeerJournal.hpp"
+#include "detail/RouteMetrics.hpp"
+#include "detail/RouteSupport.hpp"
+#include "detail/RouteTable.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/RowExport.hpp"
+#include "detail/ScratchArena.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#include <vix/p2p/Node.hpp>
+#include <vix/p2p/P2P.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace J = vix::json;
+
+// Peers unit: peer index cache, change journal, connect limiter and the
+// /peers, /peers.arrow, /peers/delta and /connect routes.
+namespace vix::p2p_http
+{
+  using detail::join_prefix;
+
+  // Peer index (rows) and its unfiltered GET /peers body, reused for
+  // peers_cache_ttl_ms. Filtered requests reuse the rows only.
+  //
+  // A warm-up entry ignores the TTL: it serves the first request, as long
+  // as the runtimes did not change since (detail::runtime_change_mark()).
+  class PeersCache
+  {
+  public:
+    using Rows = std::shared_ptr<const detail::PeerRows>;
+
+    bool warm() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return warm_;
+    }
+
+    // `mark`: current runtime_change_mark(), only read for a warm entry.
+    Rows rows(int ttl_ms, std::uint64_t mark)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!fresh_locked(ttl_ms, mark))
+        return nullptr;
+      warm_ = false;
+      return rows_;
+    }
+
+    bool body(int ttl_ms, std::uint64_t mark, std::string &out)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!fresh_locked(ttl_ms, mark) || body_.empty())
+        return false;
+
+      out = body_;
+      warm_ = false;
+      return true;
+    }
+
+    void store(Rows rows, std::string body)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      rows_ = std::move(rows);
+      body_ = std::move(body);
+      built_at_ = std::chrono::steady_clock::now();
+      warm_ = false;
+    }
+
+    void store_warm(Rows rows, std::string body, std::uint64_t mark)
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      rows_ = std::move(rows);
+      body_ = std::move(body);
+      built_at_ = std::chrono::steady_clock::now();
+      warm_ = true;
+      warm_mark_ = mark;
+    }
+
+    // Returns the bytes released (memory budget shrink hook).
+    std::size_t clear()
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      const std::size_t n = bytes_locked();
+      rows_.reset();
+      std::string().swap(body_);
+      warm_ = false;
+      return n;
+    }
+
+    std::size_t bytes() const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      return bytes_locked();
+    }
+
+    void append_symbols(std::vector<detail::Symbol> &out) const
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!rows_)
+        return;
+      out.reserve(out.size() + rows_->size() * 4);
+      for (const auto &r : *rows_)
+        detail::append_row_symbols(r, out);
+    }
+
+  private:
+    std::size_t bytes_locked() const
+    {
+      return body_.capacity() + (rows_ ? rows_->capacity() * sizeof(detail::PeerRow) : 0);
+    }
+
+    bool fresh_locked(int ttl_ms, std::uint64_t mark)
+    {
+      if (!rows_)
+        return false;
+      if (warm_)
+      {
+        if (mark == warm_mark_)
+          return true;
+        // Outdated before anyone asked for it.
+        warm_ = false;
+        rows_.reset();
+        std::string().swap(body_);
+        return false;
+      }
+      return ttl_ms > 0 &&
+             std::chrono::steady_clock::now() - built_at_ <= std::chrono::milliseconds(ttl_ms);
+    }
+
+    mutable std::mutex mu_;
+    Rows rows_;
+    std::string body_;
+    std::chrono::steady_clock::time_point built_at_{};
+    bool warm_ = false;
+    std::uint64_t warm_mark_ = 0;
+  };
+
+  static PeersCache g_peers_cache;
+  static detail::PeerJournal g_peer_journal;
+
+  // Token bucket guarding POST /connect (connect_rate_per_sec, 0 = unlimited).
+  class RateLimiter
+  {
+  public:
+    bool allow(int rate_per_sec)
+    {
+      if (rate_per_sec <= 0)
+        return true;
+
+      std::lock_guard<std::mutex> lock(mu_);
+      const auto now = std::chrono::steady_clock::now();
+      const double burst = static_cast<double>(rate_per_sec);
+
+      if (last_.time_since_epoch().count() == 0)
+        tokens_ = burst;
+      else
+      {
+        const double elapsed = std::chrono::duration<double>(now - last_).count();
+        tokens_ = std::min(burst, tokens_ + elapsed * rate_per_sec);
+      }
+      last_ = now;
+
+      if (tokens_ < 1.0)
+        return false;
+
+      tokens_ -= 1.0;
+      return true;
+    }
+
+  private:
+    std::mutex mu_;
+    double tokens_ = 0.0;
+    std::chrono::steady_clock::time_point last_{};
+  };
+
+  static RateLimiter g_connect_limiter;
+
+  using detail::RuntimeSet;
+  using detail::RuntimeSetPtr;
+
+  // Interned ids are collected once this many were added since the last
+  // collection, at most once per k_names_collect_every.
+  static constexpr std::size_t k_names_collect_after = 1024;
+  static constexpr auto k_names_collect_every = std::chrono::seconds(60);
+  // Under memory pressure (budget shrink), still at most this often.
+  static constexpr auto k_names_shrink_every = std::chrono::seconds(10);
+
+  // The peers cache and the journal are the long-lived holders of peer
+  // Symbols; requests only hold them while they format.
+  static std::size_t collect_names(std::chrono::milliseconds min_interval)
+  {
+    return detail::interner().collect([](std::vector<detail::Symbol> &held)
+                                      {
+                                        g_peers_cache.append_symbols(held);
+                                        g_peer_journal.append_symbols(held);
+                                      },
+                                      min_interval);
+  }
+
+  // POST /connect body -> reply. Returns the HTTP status.
+  // Expect JSON: { "host": "127.0.0.1", "port": 9002, "scheme": "tcp" }
+  static int connect_reply(vix::p2p::Node &node, const J::Json &body, J::Json &out)
+  {
+    auto get_str = [&](const char *key, const std::string &fallback = "") -> std::string
+    {
+      if (const auto *v = vix::json::jget(body, key))
+      {
+        if (v->is_string())
+          return v->get<std::string>();
+
+        if (v->is_number_integer())
+          return std::to_string(v->get<long long>());
+      }
+      return fallback;
+    };
+
+    auto get_ll = [&](const char *key, long long fallback = 0) -> long long
+    {
+      if (const auto *v = vix::json::jget(body, key))
+      {
+        if (v->is_number_integer())
+          return v->get<long long>();
+
+        if (v->is_string())
+        {
+          try { return std::stoll(v->get<std::string>()); }
+          catch (...) {}
+        }
+      }
+      return fallback;
+    };
+
+    const std::string host = get_str("host", "");
+    const long long port_ll = get_ll("port", 0);
+    std::string scheme = get_str("scheme", "tcp");
+    if (scheme.empty())
+      scheme = "tcp";
+
+    if (host.empty() || port_ll <= 0 || port_ll > 65535)
+    {
+      out = J::Json{
+          {"ok", false},
+          {"error", "invalid_endpoint"},
+          {"hint", "expected {host, port, scheme?}"},
+      };
+      return 400;
+    }
+
+    vix::p2p::PeerEndpoint ep;
+    ep.host = host;
+    ep.port = static_cast<std::uint16_t>(port_ll);
+    ep.scheme = scheme;
+
+    const bool started = node.connect(ep);
+
+    out = J::Json{
+        {"ok", true},
+        {"started", started},
+        {"endpoint", scheme + "://" + host + ":" + std::to_string((int)ep.port)},
+    };
+    return 200;
+  }
+
+  // Rows of one runtime, tagged with its name when it has one. Nullopt
+  // without a node.
+  static std::optional<detail::PeerRows> runtime_rows(const NamedRuntime &e,
+                                               std::pmr::memory_resource *scratch,
+                                               std::pmr::memory_resource *resource)
+  {
+    auto node = e.runtime->node();
+    if (!node)
+      return std::nullopt;
+
+    auto rows = detail::build_peer_rows(*node, scratch, resource);
+    if (!e.name.empty())
+    {
+      const detail::Symbol rt = detail::interner().intern(e.name);
+      for (auto &r : rows)
+        r.runtime = rt;
+    }
+    return rows;
+  }
+
+  // Peer rows for every runtime that has a node, sorted by peer_id. Rows
+  // of a named runtime carry its name; several runtimes are k-way merged.
+  //
+  // The result is kept by the cache and the journal, so it goes to the
+  // heap; per-runtime parts and sort order stay on the request arena.
+  static std::optional<detail::PeerRows> build_rows(const RuntimeSet &set)
+  {
+    detail::ScratchArena scratch;
+
+    std::optional<detail::PeerRows> rows;
+    if (set.size() == 1)
+    {
+      rows = runtime_rows(set.front(), scratch.resource(), std::pmr::get_default_resource());
+    }
+    else
+    {
+      std::pmr::vector<detail::PeerRows> parts(scratch.resource());
+      parts.reserve(set.size());
+      for (const auto &e : set)
+      {
+        if (auto part = runtime_rows(e, scratch.resource(), scratch.resource()))
+          parts.push_back(std::move(*part));
+      }
+      if (!parts.empty())
+        rows = detail::merge_peer_rows(std::move(parts));
+    }
+
+    if (!rows)
+      return std::nullopt;
+
+    // The new rows touched their ids this generation, so they survive it.
+    if (detail::interner().interned_since_collect() >= k_names_collect_after)
+      collect_names(k_names_collect_every);
+    return rows;
+  }
+
+  // Body layouts of the peers routes.
+  enum class PeersFormat
+  {
+    Json,    // GET /peers
+    Compact, // GET /peers?compact=1
+    Arrow,   // GET /peers.arrow
+  };
+
+  static constexpr const char *k_arrow_stream_type = "application/vnd.apache.arrow.stream";
+
+  // GET /peers body for the given filters. Returns the HTTP status.
+  // `cache` is null for views that are not cached (per-runtime routes).
+  // Optional filters: ?state=connected&scheme=tcp&host=10.0.0.2&runtime=eu
+  // Returns 200, or 400 with `body` set.
+  static int peer_filter_from_query(const std::string &state,
+                                    const std::string &scheme,
+                                    const std::string &host,
+                                    const std::string &runtime,
+                                    detail::PeerFilter &filter,
+                                    std::string &body)
+  {
+    if (!state.empty())
+    {
+      filter.state = detail::parse_peer_state(state);
+      if (!filter.state)
+      {
+        body = R"({"error":"invalid_state","hint":"disconnected|connecting|handshaking|connected|stale|closed","ok":false})";
+        return 400;
+      }
+    }
+    if (!scheme.empty())
+      filter.scheme = detail::interner().find(scheme);
+    if (!host.empty())
+      filter.host = detail::interner().find(host);
+    if (!runtime.empty())
+      filter.runtime = detail::interner().find(runtime);
+    return 200;
+  }
+
+  // Cached rows, or a fresh build (`rebuilt`). Null when there is no node.
+  static PeersCache::Rows peer_rows(const RuntimeSet &set, PeersCache *cache, int ttl, std::uint64_t mark, bool &rebuilt)
+  {
+    PeersCache::Rows rows = cache ? cache->rows(ttl, mark) : nullptr;
+    rebuilt = !rows;
+    if (rebuilt)
+    {
+      auto built = build_rows(set);
+      if (!built)
+        return nullptr;
+      rows = std::make_shared<const detail::PeerRows>(std::move(*built));
+    }
+    return rows;
+  }
+
+  static int peers_reply(const RuntimeSet &set,
+                         PeersCache *cache,
+                         const std::string &state,
+                         const std::string &scheme,
+                         const std::string &host,
+                         const std::string &runtime,
+                         PeersFormat format,
+                         std::string &body)
+  {
+    detail::PeerFilter filter;
+    if (const int status = peer_filter_from_query(state, scheme, host, runtime, filter, body); status != 200)
+      return status;
+
+    const int ttl = cache ? detail::live_config()->peers_cache_ttl_ms : 0;
+    const std::uint64_t mark = cache && cache->warm() ? detail::runtime_change_mark(set) : 0;
+
+    // Only the plain unfiltered body is cached; other views reuse the rows.
+    const bool cacheable_body = filter.empty() && format == PeersFormat::Json;
+    if (cache && cacheable_body && cache->body(ttl, mark, body))
+      return 200;
+
+    bool rebuilt = false;
+    PeersCache::Rows rows = peer_rows(set, cache, ttl, mark, rebuilt);
+    if (!rows)
+    {
+      body = R"({"error":"p2p_node_unavailable","ok":false})";
+      return 503;
+    }
+
+    switch (format)
+    {
+    case PeersFormat::Json: body = detail::peers_body(*rows, filter); break;
+    case PeersFormat::Compact: body = detail::peers_body_compact(*rows, filter); break;
+    case PeersFormat::Arrow: body = detail::peers_arrow(*rows, filter); break;
+    }
+    if (cache && rebuilt && ttl > 0)
+    {
+      cache->store(rows, cacheable_body ? body : std::string{});
+      detail::memory_budget().enforce();
+    }
+    return 200;
+  }
+
+  // GET /peers?format=ndjson|csv. On 200, `produce` writes the export to a
+  // sink; otherwise `body` holds the JSON error. The rows are held by the
+  // producer, so it can run after the handler returned.
+  static int peers_export_reply(const RuntimeSet &set,
+                                PeersCache *cache,
+                                const std::string &state,
+                                const std::string &scheme,
+                                const std::string &host,
+                                const std::string &runtime,
+                                detail::ExportFormat format,
+                                std::function<bool(const detail::ChunkSink &)> &produce,
+                                std::string &body)
+  {
+    detail::PeerFilter filter;
+    if (const int status = peer_filter_from_query(state, scheme, host, runtime, filter, body); status != 200)
+      return status;
+
+    const int ttl = cache ? detail::live_config()->peers_cache_ttl_ms : 0;
+    const std::uint64_t mark = cache && cache->warm() ? detail::runtime_change_mark(set) : 0;
+    bool rebuilt = false;
+    PeersCache::Rows rows = peer_rows(set, cache, ttl, mark, rebuilt);
+    if (!rows)
+    {
+      body = R"({"error":"p2p_node_unavailable","ok":false})";
+      return 503;
+    }
+    if (cache && rebuilt && ttl > 0)
+    {
+      cache->store(rows, std::string{});
+      detail::memory_budget().enforce();
+    }
+
+    produce = [rows, filter, format](const detail::ChunkSink &sink)
+    { return detail::export_peers(*rows, filter, format, sink); };
+    return 200;
+  }
+
+  // GET /peers/delta?epoch=E&since=G&wait_ms=N body. Returns the HTTP status.
+  // Long-polls up to wait_ms for a change. Each waiter holds a server
+  // thread, so the wait is capped at the PeerMirror default and ends as
+  // soon as the node starts draining.
+  static int peers_delta_reply(const std::string &epoch,
+                               const std::string &since,
+                               const std::string &wait_ms,
+                               std::string &body)
+  {
+    constexpr std::uint64_t k_max_wait_ms = 20000;
+
+    std::uint64_t e = 0;
+    std::uint64_t g = 0;
+    std::uint64_t w = 0;
+    if ((!epoch.empty() && !detail::parse_u64(epoch, e)) ||
+        (!since.empty() && !detail::parse_u64(since, g)) ||
+        (!wait_ms.empty() && !detail::parse_u64(wait_ms, w)))
+    {
+      body = R"({"error":"invalid_cursor","hint":"epoch, since and wait_ms are unsigned integers","ok":false})";
+      return 400;
+    }
+
+    return g_peer_journal.delta(e, g, std::chrono::milliseconds(std::min(w, k_max_wait_ms)), body,
+                                []()
+                                { return detail::draining(); });
+  }
+
+  // POST .../connect on the first runtime of `rts`.
+  static void mount_connect_route(detail::Registration &reg, const std::string &path, RuntimeSetPtr rts)
+  {
+    detail::RouteSpec spec;
+    spec.method = "POST";
+    spec.path = path;
+    spec.id = detail::RouteId::Connect;
+    spec.ro.heavy = true;
+    spec.ro.require_auth = false; // ou true si tu veux protéger
+    spec.ro.reject_when_draining = true;
+    spec.touch = true;
+    spec.enabled = [](const detail::LiveConfig &c)
+    { return c.enable_peers; };
+    spec.handler = [rts](const detail::RouteRequest &req, detail::RouteReply &out)
+    {
+      if (!g_connect_limiter.allow(detail::live_config()->connect_rate_per_sec))
+      {
+        out.rejected = true;
+        return detail::reply_json(out, 429, J::Json{{"ok", false}, {"error", "rate_limited"}});
+      }
+
+      auto node = rts->front().runtime->node();
+      if (!node)
+        return detail::reply_json(out, 503, J::Json{{"ok", false}, {"error", "p2p_node_unavailable"}});
+
+      J::Json body;
+      try
+      {
+        body = J::Json::parse(req.body());
+      }
+      catch (...)
+      {
+        return detail::reply_json(out, 400, J::Json{{"ok", false}, {"error", "invalid_json"}});
+      }
+
+      J::Json reply;
+      const int status = connect_reply(*node, body, reply);
+      detail::reply_json(out, status, reply);
+    };
+    detail::mount_route(reg, std::move(spec));
+  }
+
+  // GET .../peers for `rts`, cached when `cache` is set.
+  // `arrow` mounts the Arrow IPC variant (GET /peers.arrow) instead of JSON.
+  static void mount_peers_route(detail::Registration &reg, const std::string &path, RuntimeSetPtr rts, PeersCache *cache, bool arrow)
+  {
+    detail::RouteSpec spec;
+    spec.path = path;
+    spec.id = detail::RouteId::Peers;
+    spec.touch = true;
+    spec.enabled = [](const detail::LiveConfig &c)
+    { return c.enable_peers; };
+    spec.handler = [rts, cache, arrow](const detail::RouteRequest &req, detail::RouteReply &out)
+    {
+      if (!arrow)
+      {
+        bool exporting = false;
+        detail::ExportFormat ef = detail::ExportFormat::Ndjson;
+        out.status = detail::export_format_from_query(req.query("format"), exporting, ef, out.body);
+        if (out.status != 200)
+          return;
+        if (exporting)
+        {
+          // Rows are written one at a time, without an intermediate JSON
+          // document; the socket streams them as chunks.
+          out.status = peers_export_reply(*rts, cache,
+                                          req.query("state"),
+                                          req.query("scheme"),
+                                          req.query("host"),
+                                          req.query("runtime"),
+                                          ef, out.stream, out.body);
+          if (out.status == 200)
+            out.type = detail::export_content_type(ef);
+          return;
+        }
+      }
+
+      PeersFormat format = PeersFormat::Arrow;
+      if (!arrow)
+        format = req.query("compact") == "1" ? PeersFormat::Compact : PeersFormat::Json;
+
+      out.status = peers_reply(*rts, cache,
+                               req.query("state"),
+                               req.query("scheme"),
+                               req.query("host"),
+                               req.query("runtime"),
+                               format,
+                               out.body);
+      if (arrow && out.status == 200)
+        out.type = k_arrow_stream_type;
+    };
+    detail::mount_route(reg, std::move(spec));
+  }
+
+  // GET /admin/bundle: peers.ndjson. Peer rows are immutable, so the
+  // capture only holds a reference to them.
+  static void capture_peers_bundle(const RuntimeSet &set, std::vector<detail::BundleFile> &files)
+  {
+    PeersCache::Rows rows;
+    if (detail::live_config()->enable_peers)
+    {
+      if (auto built = build_rows(set))
+        rows = std::make_shared<const detail::PeerRows>(std::move(*built));
+    }
+
+    detail::BundleFile file{"peers.ndjson", "peers", -1, nullptr};
+    if (rows)
+    {
+      file.count = (long long)rows->size();
+      file.produce = [rows](const detail::ChunkSink &out)
+      { return detail::export_peers(*rows, {}, detail::ExportFormat::Ndjson, out); };
+    }
+    files.push_back(std::move(file));
+  }
+
+  static const detail::UnitHooks &peers_hooks()
+  {
+    static const detail::UnitHooks hooks = []()
+    {
+      detail::UnitHooks h;
+      h.idle = []()
+      { g_peers_cache.clear(); };
+      h.warm_up = [](const RuntimeSet &set)
+      {
+        if (auto built = build_rows(set))
+        {
+          auto rows = std::make_shared<const detail::PeerRows>(std::move(*built));
+          std::string body = detail::peers_body(*rows);
+          g_peers_cache.store_warm(std::move(rows), std::move(body), detail::runtime_change_mark(set));
+        }
+      };
+      h.shutdown = []()
+      { g_peer_journal.close(); };
+      h.drain = [](bool on)
+      { if (on) g_peer_journal.release_waiters(); };
+      h.bundle = capture_peers_bundle;
+      return h;
+    }();
+    return hooks;
+  }
+
+  namespace detail
+  {
+    void mount_peers(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+      const RuntimeSetPtr rts = reg.rts;
+
+      install_unit(Unit::Peers, &peers_hooks());
+
+      static std::once_flag budget_once;
+      std::call_once(budget_once, []()
+                     {
+        auto &budget = memory_budget();
+
+        MemoryConsumer cache;
+        cache.name = "peers_cache";
+        cache.priority = 10;
+        cache.usage = []() { return g_peers_cache.bytes(); };
+        cache.shrink = [](std::size_t) { return g_peers_cache.clear(); };
+        budget.add(std::move(cache));
+
+        MemoryConsumer journal;
+        journal.name = "peer_journal";
+        journal.priority = 15;
+        journal.usage = []() { return g_peer_journal.bytes(); };
+        journal.shrink = [](std::size_t want) { return g_peer_journal.shrink(want); };
+        budget.add(std::move(journal));
+
+        // Last: ids still held by the cache and journal survive anyway, so
+        // this frees most once those two have given memory back.
+        MemoryConsumer names;
+        names.name = "interner";
+        names.priority = 100;
+        names.usage = []() { return interner().bytes(); };
+        names.shrink = [](std::size_t) { return collect_names(k_names_shrink_every); };
+        budget.add(std::move(names)); });
+
+      if (!opt.enable_peers)
+        return;
+
+      g_peer_journal.reset([rts]()
+                           { return build_rows(*rts); },
+                           opt.peers_delta_max_changes);
+
+      // POST /p2p/connect  (connect to a peer endpoint)
+      mount_connect_route(reg, join_prefix(reg.base, "/connect"), rts);
+
+      // GET /p2p/peers  (multi-peer view for dashboard)
+      // GET /p2p/peers.arrow  (same rows as an Arrow IPC stream)
+      mount_peers_route(reg, join_prefix(reg.base, "/peers"), rts, &g_peers_cache, false);
+      mount_peers_route(reg, join_prefix(reg.base, "/peers.arrow"), rts, &g_peers_cache, true);
+
+      // GET /p2p/peers/delta  (changes since a generation, long-poll)
+      {
+        RouteSpec spec;
+        spec.path = join_prefix(reg.base, "/peers/delta");
+        spec.id = RouteId::Peers;
+        spec.ro.heavy = true;
+        spec.touch = true;
+        spec.enabled = [](const LiveConfig &c)
+        { return c.enable_peers; };
+        spec.handler = [](const RouteRequest &req, RouteReply &out)
+        {
+          out.status = peers_delta_reply(req.query("epoch"),
+                                         req.query("since"),
+                                         req.query("wait_ms"),
+                                         out.body);
+        };
+        mount_route(reg, std::move(spec));
+      }
+
+      // GET/POST /p2p/rt/{name}/...  (one runtime, uncached)
+      if (reg.per_runtime)
+      {
+        for (const auto &e : *rts)
+        {
+          auto one = std::make_shared<RuntimeSet>(1, e);
+          const std::string rt_base = join_prefix(reg.base, "/rt/" + e.name);
+
+          mount_peers_route(reg, join_prefix(rt_base, "/peers"), one, nullptr, false);
+          mount_peers_route(reg, join_prefix(rt_base, "/peers.arrow"), one, nullptr, true);
+          mount_connect_route(reg, join_prefix(rt_base, "/connect"), one);
+        }
+      }
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
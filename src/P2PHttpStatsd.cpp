@@ -0,0 +1,314 @@
+/**
+ *
+ *  @file P2PHttpStatsd.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+#include "detail/RouteMetrics.hpp"
+#include "detail/RouteUnits.hpp"
+#include "detail/Statsd.hpp"
+#include "detail/ThreadTuning.hpp"
+
+#include <vix/json/json.hpp>
+
+#include <vix/p2p/P2P.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace J = vix::json;
+
+// StatsD unit: every stats_every_ms, on its own thread, packs counter
+// deltas and gauges into MTU-sized datagrams and hands them to the kernel
+// in one batch.
+namespace vix::p2p_http
+{
+  class StatsdEmitter
+  {
+  public:
+    struct Config
+    {
+      std::string host;
+      int port = 8125;
+      std::string prefix;
+      std::size_t max_datagram = 1432;
+      int every_ms = 1000;
+    };
+
+    ~StatsdEmitter() { stop(); }
+
+    bool start(Config cfg, detail::RuntimeSetPtr rts, std::string &error)
+    {
+      stop();
+
+      std::lock_guard<std::mutex> lock(mu_);
+      cfg_ = std::move(cfg);
+      rts_ = std::move(rts);
+      packer_ = detail::StatsdPacker(cfg_.max_datagram);
+      last_runtimes_.clear();
+      baseline_ = false;
+      failing_ = false;
+      {
+        std::lock_guard<std::mutex> rl(report_mu_);
+        target_ = cfg_.host + ":" + std::to_string(cfg_.port);
+        last_error_.clear();
+      }
+      if (!sender_.open(cfg_.host, cfg_.port, error))
+        return false;
+
+      stop_ = false;
+      thread_ = std::thread([this]()
+                            { run(); });
+      return true;
+    }
+
+    void stop()
+    {
+      if (thread_.joinable())
+      {
+        {
+          std::lock_guard<std::mutex> lock(mu_);
+          stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+      }
+
+      std::lock_guard<std::mutex> lock(mu_);
+      sender_.close();
+    }
+
+    J::Json status() const
+    {
+      std::lock_guard<std::mutex> lock(report_mu_);
+      return J::Json{
+          {"target", target_},
+          {"ticks", ticks_.load()},
+          {"packets_sent", packets_sent_.load()},
+          {"packets_dropped", packets_dropped_.load()},
+          {"bytes_sent", bytes_sent_.load()},
+          {"syscalls", syscalls_.load()},
+          {"last_error", last_error_},
+      };
+    }
+
+  private:
+    // Own timer: the emitter does not depend on the logs unit's ticker,
+    // which lazy mode idles down and enable_live_logs=false never starts.
+    void run()
+    {
+      const detail::ThreadPolicyScope policy("statsd_emitter");
+
+      const auto every = std::chrono::milliseconds(cfg_.every_ms <= 0 ? 1000 : cfg_.every_ms);
+      auto next = std::chrono::steady_clock::now();
+
+      std::unique_lock<std::mutex> lock(mu_);
+      while (!stop_)
+      {
+        tick_locked(*rts_);
+
+        next += every;
+        const auto now = std::chrono::steady_clock::now();
+        if (next < now)
+          next = now + every; // fell behind: skip, do not burst
+        cv_.wait_until(lock, next, [this]()
+                       { return stop_; });
+      }
+    }
+
+    void tick_locked(const detail::RuntimeSet &set)
+    {
+      if (!sender_.is_open())
+        return;
+
+      packer_.reset();
+      pack(set);
+      ticks_.fetch_add(1, std::memory_order_relaxed);
+      if (packer_.datagrams() == 0)
+        return;
+
+      const detail::UdpSendResult r = sender_.send(packer_);
+      packets_sent_.fetch_add(r.sent, std::memory_order_relaxed);
+      packets_dropped_.fetch_add(r.dropped, std::memory_order_relaxed);
+      bytes_sent_.fetch_add(r.bytes, std::memory_order_relaxed);
+      syscalls_.fetch_add(r.syscalls, std::memory_order_relaxed);
+
+      if (r.dropped == 0)
+      {
+        failing_ = false;
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> rl(report_mu_);
+        last_error_ = r.error;
+      }
+      // Once per outage, not once per tick.
+      if (!failing_)
+        detail::log_line("[p2p_http] statsd: dropped " + std::to_string(r.dropped) +
+                         " packet(s) to " + cfg_.host + ": " + r.error);
+      failing_ = true;
+    }
+
+    struct RouteSnap
+    {
+      std::uint64_t requests = 0;
+      std::uint64_t rejected = 0;
+      std::uint64_t total_us = 0;
+    };
+
+    // Counters only grow; a smaller value means the source restarted.
+    static long long delta(std::uint64_t cur, std::uint64_t last)
+    {
+      return (long long)(cur >= last ? cur - last : cur);
+    }
+
+    void counter(std::string_view rt, std::string_view name, std::uint64_t cur, std::uint64_t last)
+    {
+      const long long d = delta(cur, last);
+      if (baseline_ && d != 0)
+        packer_.add({cfg_.prefix, rt.empty() ? "" : "rt", rt, name}, d, 'c');
+    }
+
+    void gauge(std::string_view rt, std::string_view name, std::uint64_t v)
+    {
+      packer_.add({cfg_.prefix, rt.empty() ? "" : "rt", rt, name}, (long long)v, 'g');
+    }
+
+    // The first tick only records the baseline, so counters report deltas
+    // since the previous tick, never totals since the runtime started.
+    void pack(const detail::RuntimeSet &set)
+    {
+      if (last_runtimes_.size() != set.size())
+      {
+        last_runtimes_.assign(set.size(), vix::p2p::RuntimeStats{});
+        baseline_ = false;
+      }
+
+      for (std::size_t i = 0; i < set.size(); ++i)
+      {
+        const auto st = set[i].runtime->runtime_stats();
+        const auto &last = last_runtimes_[i];
+        const std::string_view rt = set[i].name;
+
+        gauge(rt, "peers.total", st.peers_total);
+        gauge(rt, "peers.connected", st.peers_connected);
+        gauge(rt, "connect.tracked_endpoints", st.connect.tracked_endpoints);
+        counter(rt, "handshakes.started", st.handshakes_started, last.handshakes_started);
+        counter(rt, "handshakes.completed", st.handshakes_completed, last.handshakes_completed);
+        counter(rt, "connect.attempts", st.connect.connect_attempts, last.connect.connect_attempts);
+        counter(rt, "connect.deduped", st.connect.connect_deduped, last.connect.connect_deduped);
+        counter(rt, "connect.failures", st.connect.connect_failures, last.connect.connect_failures);
+        counter(rt, "connect.backoff_skips", st.connect.backoff_skips, last.connect.backoff_skips);
+        last_runtimes_[i] = st;
+      }
+
+      for (std::size_t i = 0; i < last_routes_.size(); ++i)
+      {
+        const auto id = static_cast<detail::RouteId>(i);
+        const auto &c = detail::route_counters(id);
+        const RouteSnap cur{c.requests.load(), c.rejected.load(), c.total_us.load()};
+        RouteSnap &last = last_routes_[i];
+        const std::string_view route = detail::route_name(id);
+
+        if (baseline_)
+        {
+          if (const long long d = delta(cur.requests, last.requests); d != 0)
+            packer_.add({cfg_.prefix, "route", route, "requests"}, d, 'c');
+          if (const long long d = delta(cur.rejected, last.rejected); d != 0)
+            packer_.add({cfg_.prefix, "route", route, "rejected"}, d, 'c');
+          if (const long long d = delta(cur.total_us, last.total_us); d != 0)
+            packer_.add({cfg_.prefix, "route", route, "time_us"}, d, 'c');
+        }
+        last = cur;
+      }
+
+      gauge({}, "in_flight", detail::in_flight());
+      baseline_ = true;
+    }
+
+    // Emitter thread, and start()/stop().
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool stop_ = false;
+    Config cfg_;
+    detail::RuntimeSetPtr rts_;
+    detail::StatsdPacker packer_;
+    detail::UdpSender sender_;
+    std::vector<vix::p2p::RuntimeStats> last_runtimes_;
+    std::array<RouteSnap, static_cast<std::size_t>(detail::RouteId::Count)> last_routes_{};
+    bool baseline_ = false;
+    bool failing_ = false;
+
+    std::atomic<std::uint64_t> ticks_{0};
+    std::atomic<std::uint64_t> packets_sent_{0};
+    std::atomic<std::uint64_t> packets_dropped_{0};
+    std::atomic<std::uint64_t> bytes_sent_{0};
+    std::atomic<std::uint64_t> syscalls_{0};
+    mutable std::mutex report_mu_;
+    std::string target_;
+    std::string last_error_;
+  };
+
+  static StatsdEmitter g_statsd;
+
+  static const detail::UnitHooks &statsd_hooks()
+  {
+    static const detail::UnitHooks hooks = []()
+    {
+      detail::UnitHooks h;
+      h.status = [](J::Json &out)
+      { out["statsd"] = g_statsd.status(); };
+      h.shutdown = []()
+      { g_statsd.stop(); };
+      return h;
+    }();
+    return hooks;
+  }
+
+  namespace detail
+  {
+    void mount_statsd(Registration &reg)
+    {
+      const P2PHttpOptions &opt = reg.opt;
+      install_unit(Unit::Statsd, nullptr);
+      g_statsd.stop();
+      if (opt.statsd_host.empty())
+        return;
+
+      StatsdEmitter::Config cfg;
+      cfg.host = opt.statsd_host;
+      cfg.port = opt.statsd_port;
+      cfg.prefix = opt.statsd_prefix;
+      cfg.max_datagram = opt.statsd_max_datagram;
+      cfg.every_ms = opt.stats_every_ms;
+
+      std::string error;
+      if (!g_statsd.start(std::move(cfg), reg.rts, error))
+      {
+        push_log(&opt, "[p2p_http] statsd disabled: " + error);
+        return;
+      }
+      install_unit(Unit::Statsd, &statsd_hooks());
+    }
+  } // namespace detail
+} // namespace vix::p2p_http
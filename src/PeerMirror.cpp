@@ -0,0 +1,326 @@
+/**
+ *
+ *  @file PeerMirror.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include <vix/p2p_http/PeerMirror.hpp>
+
+#include "detail/ClientJson.hpp"
+
+#include <vix/json/json.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace J = vix::json;
+
+namespace vix::p2p_http
+{
+  namespace
+  {
+    // Slack on top of the long-poll wait before the client gives up.
+    constexpr int k_io_slack_ms = 5000;
+
+    // Fields a consumer reacts to; relative ages alone are not a change.
+    bool same_peer(const PeerInfo &a, const PeerInfo &b) noexcept
+    {
+      return a.state == b.state &&
+             a.scheme == b.scheme &&
+             a.host == b.host &&
+             a.port == b.port &&
+             a.secure == b.secure &&
+             a.handshake_stage == b.handshake_stage;
+    }
+
+    ClientOptions with_io_timeout(ClientOptions c, int wait_ms)
+    {
+      c.io_timeout_ms = std::max(c.io_timeout_ms, wait_ms + k_io_slack_ms);
+      return c;
+    }
+  }
+
+  PeerMirror::PeerMirror(ClientOptions client, PeerMirrorOptions opt)
+      : client_(with_io_timeout(std::move(client), std::max(0, opt.wait_ms))),
+        opt_(opt)
+  {
+  }
+
+  PeerMirror::~PeerMirror()
+  {
+    stop();
+  }
+
+  std::string PeerMirror::key_of(std::string_view peer_id, std::string_view runtime)
+  {
+    std::string k;
+    k.reserve(peer_id.size() + 1 + runtime.size());
+    k.append(peer_id).push_back('\0');
+    k.append(runtime);
+    return k;
+  }
+
+  void PeerMirror::on_change(PeerChangeFn fn)
+  {
+    if (fn)
+      callbacks_.push_back(std::move(fn));
+  }
+
+  void PeerMirror::start()
+  {
+    if (running_.exchange(true))
+      return;
+
+    stop_.store(false);
+    thread_ = std::thread([this]()
+                          { run(); });
+  }
+
+  void PeerMirror::stop()
+  {
+    if (!thread_.joinable())
+      return;
+
+    stop_.store(true);
+    {
+      std::lock_guard<std::mutex> lock(stop_mu_);
+    }
+    stop_cv_.notify_all();
+
+    // Keep interrupting: the thread may be between the stop check and the
+    // moment its request takes a connection.
+    while (running_.load())
+    {
+      client_.interrupt();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    thread_.join();
+  }
+
+  void PeerMirror::run()
+  {
+    while (!stop_.load())
+    {
+      if (sync_once(nullptr, opt_.wait_ms))
+        continue;
+
+      std::unique_lock<std::mutex> lock(stop_mu_);
+      stop_cv_.wait_for(lock, std::chrono::milliseconds(opt_.retry_ms), [this]()
+                        { return stop_.load(); });
+    }
+    running_.store(false);
+  }
+
+  bool PeerMirror::sync_once(std::string *error, int wait_ms)
+  {
+    std::lock_guard<std::mutex> sync_lock(sync_mu_);
+
+    std::string target = "/peers/delta?epoch=";
+    {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      target.append(std::to_string(epoch_));
+      target.append("&since=").append(std::to_string(gen_));
+    }
+    target.append("&wait_ms=").append(std::to_string(std::max(0, wait_ms)));
+
+    const auto j = detail::parse_client_reply(client_.request("GET", target), error);
+    if (!j)
+    {
+      std::unique_lock<std::shared_mutex> lock(mu_);
+      ++stats_.errors;
+      return false;
+    }
+
+    std::vector<PeerChange> changes;
+    {
+      std::unique_lock<std::shared_mutex> lock(mu_);
+
+      if (detail::json_bool(*j, "reset"))
+      {
+        std::vector<PeerInfo> rows;
+        if (const auto *peers = J::jget(*j, "peers"); peers && peers->is_array())
+        {
+          rows.reserve(peers->size());
+          for (const auto &r : *peers)
+            rows.push_back(detail::peer_info_from_json(r));
+        }
+        apply_snapshot_locked(std::move(rows), changes);
+        ++stats_.snapshots;
+      }
+      else
+      {
+        if (const auto *removed = J::jget(*j, "removed"); removed && removed->is_array())
+        {
+          for (const auto &r : *removed)
+            remove_locked(key_of(detail::json_str(r, "peer_id"), detail::json_str(r, "runtime")), changes);
+        }
+        if (const auto *upserts = J::jget(*j, "upserts"); upserts && upserts->is_array())
+        {
+          for (const auto &r : *upserts)
+            upsert_locked(detail::peer_info_from_json(r), changes);
+        }
+        ++stats_.deltas;
+      }
+
+      epoch_ = static_cast<std::uint64_t>(detail::json_ll(*j, "epoch"));
+      gen_ = static_cast<std::uint64_t>(detail::json_ll(*j, "gen"));
+      stats_.changes += changes.size();
+      if (!ready_)
+      {
+        ready_ = true;
+        ready_cv_.notify_all();
+      }
+    }
+
+    for (const auto &c : changes)
+    {
+      for (const auto &fn : callbacks_)
+        fn(c);
+    }
+    return true;
+  }
+
+  void PeerMirror::apply_snapshot_locked(std::vector<PeerInfo> rows, std::vector<PeerChange> &out)
+  {
+    std::set<std::string> keep;
+    for (const auto &r : rows)
+      keep.insert(key_of(r.peer_id, r.runtime));
+
+    std::vector<std::string> gone;
+    for (const auto &[key, row] : rows_)
+    {
+      (void)row;
+      if (keep.find(key) == keep.end())
+        gone.push_back(key);
+    }
+    for (const auto &key : gone)
+      remove_locked(key, out);
+
+    for (auto &r : rows)
+      upsert_locked(std::move(r), out);
+  }
+
+  void PeerMirror::upsert_locked(PeerInfo row, std::vector<PeerChange> &out)
+  {
+    std::string key = key_of(row.peer_id, row.runtime);
+    auto it = rows_.find(key);
+    if (it == rows_.end())
+    {
+      by_state_[row.state].insert(key);
+      out.push_back(PeerChange{PeerChangeKind::Added, row});
+      rows_.emplace(std::move(key), std::move(row));
+      return;
+    }
+
+    const bool changed = !same_peer(it->second, row);
+    if (it->second.state != row.state)
+    {
+      auto old = by_state_.find(it->second.state);
+      if (old != by_state_.end())
+      {
+        old->second.erase(key);
+        if (old->second.empty())
+          by_state_.erase(old);
+      }
+      by_state_[row.state].insert(key);
+    }
+
+    it->second = std::move(row);
+    if (changed)
+      out.push_back(PeerChange{PeerChangeKind::Updated, it->second});
+  }
+
+  void PeerMirror::remove_locked(const std::string &key, std::vector<PeerChange> &out)
+  {
+    auto it = rows_.find(key);
+    if (it == rows_.end())
+      return;
+
+    auto idx = by_state_.find(it->second.state);
+    if (idx != by_state_.end())
+    {
+      idx->second.erase(key);
+      if (idx->second.empty())
+        by_state_.erase(idx);
+    }
+
+    out.push_back(PeerChange{PeerChangeKind::Removed, std::move(it->second)});
+    rows_.erase(it);
+  }
+
+  bool PeerMirror::ready() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return ready_;
+  }
+
+  bool PeerMirror::wait_ready(std::chrono::milliseconds timeout) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return ready_cv_.wait_for(lock, timeout, [this]()
+                              { return ready_; });
+  }
+
+  std::optional<PeerInfo> PeerMirror::find(std::string_view peer_id, std::string_view runtime) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    const auto it = rows_.find(key_of(peer_id, runtime));
+    if (it == rows_.end())
+      return std::nullopt;
+    return it->second;
+  }
+
+  std::vector<PeerInfo> PeerMirror::snapshot() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    std::vector<PeerInfo> out;
+    out.reserve(rows_.size());
+    for (const auto &[key, row] : rows_)
+    {
+      (void)key;
+      out.push_back(row);
+    }
+    return out;
+  }
+
+  std::vector<PeerInfo> PeerMirror::by_state(std::string_view state) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    std::vector<PeerInfo> out;
+    const auto idx = by_state_.find(std::string(state));
+    if (idx == by_state_.end())
+      return out;
+
+    out.reserve(idx->second.size());
+    for (const auto &key : idx->second)
+      out.push_back(rows_.at(key));
+    return out;
+  }
+
+  std::size_t PeerMirror::size() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return rows_.size();
+  }
+
+  std::uint64_t PeerMirror::generation() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return gen_;
+  }
+
+  PeerMirrorStats PeerMirror::stats() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return stats_;
+  }
+
+} // namespace vix::p2p_http
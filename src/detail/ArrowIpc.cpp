@@ -0,0 +1,894 @@
+/**
+ *
+ *  @file ArrowIpc.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "ArrowIpc.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    // Format.fbs / Schema.fbs / Message.fbs constants.
+    constexpr std::int16_t k_metadata_v5 = 4;
+
+    constexpr std::uint8_t k_header_schema = 1;
+    constexpr std::uint8_t k_header_dictionary = 2;
+    constexpr std::uint8_t k_header_record_batch = 3;
+
+    constexpr std::uint8_t k_type_int = 2;
+    constexpr std::uint8_t k_type_utf8 = 5;
+    constexpr std::uint8_t k_type_bool = 6;
+
+    std::size_t pad8(std::size_t n) noexcept
+    {
+      return (n + 7) & ~std::size_t(7);
+    }
+
+    template <class T>
+    void put_le(std::string &buf, std::size_t pos, T v)
+    {
+      for (std::size_t i = 0; i < sizeof(T); ++i)
+        buf[pos + i] = static_cast<char>((static_cast<std::uint64_t>(v) >> (8 * i)) & 0xff);
+    }
+
+    template <class T>
+    void append_le(std::string &buf, T v)
+    {
+      const std::size_t pos = buf.size();
+      buf.resize(pos + sizeof(T));
+      put_le(buf, pos, v);
+    }
+
+    /**
+     * Minimal FlatBuffers encoder, written front to back: a table is laid
+     * out with placeholder offsets, then the objects it references are
+     * appended after it and the offsets patched (uoffsets point forward).
+     */
+    class FlatBuilder
+    {
+    public:
+      using Child = std::function<std::size_t(FlatBuilder &)>;
+
+      // One table slot: an inline scalar of `size` bytes, or a child offset.
+      struct Slot
+      {
+        std::uint16_t id = 0;
+        std::uint8_t size = 0;
+        std::uint64_t bits = 0;
+        Child child = nullptr;
+      };
+
+      static Slot scalar(std::uint16_t id, std::uint8_t size, std::uint64_t bits)
+      {
+        return Slot{id, size, bits, nullptr};
+      }
+
+      static Slot offset(std::uint16_t id, Child child)
+      {
+        return Slot{id, 4, 0, std::move(child)};
+      }
+
+      FlatBuilder() { buf_.resize(4); } // root uoffset
+
+      std::size_t table(std::vector<Slot> slots)
+      {
+        std::uint16_t n_ids = 0;
+        for (const auto &s : slots)
+          n_ids = std::max<std::uint16_t>(n_ids, std::uint16_t(s.id + 1));
+
+        // Inline layout after the vtable soffset, widest fields first.
+        std::stable_sort(slots.begin(), slots.end(), [](const Slot &a, const Slot &b)
+                         { return a.size > b.size; });
+        std::vector<std::uint16_t> at(n_ids, 0);
+        std::vector<std::uint16_t> pos(slots.size(), 0);
+        std::size_t size = 4;
+        for (std::size_t i = 0; i < slots.size(); ++i)
+        {
+          size = (size + slots[i].size - 1) / slots[i].size * slots[i].size;
+          pos[i] = static_cast<std::uint16_t>(size);
+          at[slots[i].id] = pos[i];
+          size += slots[i].size;
+        }
+
+        align(2);
+        const std::size_t vtable = buf_.size();
+        append_le(buf_, static_cast<std::uint16_t>(4 + 2 * n_ids));
+        append_le(buf_, static_cast<std::uint16_t>(size));
+        for (const auto a : at)
+          append_le(buf_, a);
+
+        align(8);
+        const std::size_t table = buf_.size();
+        buf_.resize(table + size, '\0');
+        put_le(buf_, table, static_cast<std::int32_t>(table - vtable));
+
+        for (std::size_t i = 0; i < slots.size(); ++i)
+        {
+          if (!slots[i].child)
+          {
+            for (std::size_t b = 0; b < slots[i].size; ++b)
+              buf_[table + pos[i] + b] = static_cast<char>((slots[i].bits >> (8 * b)) & 0xff);
+          }
+        }
+        for (std::size_t i = 0; i < slots.size(); ++i)
+        {
+          if (slots[i].child)
+            patch(table + pos[i], slots[i].child(*this));
+        }
+        return table;
+      }
+
+      std::size_t string(std::string_view s)
+      {
+        align(4);
+        const std::size_t at = buf_.size();
+        append_le(buf_, static_cast<std::uint32_t>(s.size()));
+        buf_.append(s);
+        buf_.push_back('\0');
+        return at;
+      }
+
+      std::size_t offsets(const std::vector<Child> &items)
+      {
+        align(4);
+        const std::size_t at = buf_.size();
+        append_le(buf_, static_cast<std::uint32_t>(items.size()));
+        buf_.resize(at + 4 + 4 * items.size(), '\0');
+        for (std::size_t i = 0; i < items.size(); ++i)
+          patch(at + 4 + 4 * i, items[i](*this));
+        return at;
+      }
+
+      // Vector of 8-byte aligned structs given as raw little-endian bytes.
+      std::size_t structs(const std::string &raw, std::size_t count)
+      {
+        align(4);
+        if ((buf_.size() + 4) % 8 != 0)
+          buf_.append(4, '\0');
+        const std::size_t at = buf_.size();
+        append_le(buf_, static_cast<std::uint32_t>(count));
+        buf_.append(raw);
+        return at;
+      }
+
+      std::string finish(const Child &root)
+      {
+        patch(0, root(*this));
+        align(8);
+        return std::move(buf_);
+      }
+
+    private:
+      void align(std::size_t a)
+      {
+        while (buf_.size() % a != 0)
+          buf_.push_back('\0');
+      }
+
+      void patch(std::size_t at, std::size_t target)
+      {
+        put_le(buf_, at, static_cast<std::uint32_t>(target - at));
+      }
+
+      std::string buf_;
+    };
+
+    using Child = FlatBuilder::Child;
+    using Slot = FlatBuilder::Slot;
+
+    Child int_type(int bits, bool is_signed)
+    {
+      return [=](FlatBuilder &fb)
+      {
+        return fb.table({FlatBuilder::scalar(0, 4, std::uint32_t(bits)),
+                         FlatBuilder::scalar(1, 1, is_signed ? 1 : 0)});
+      };
+    }
+
+    Child empty_table()
+    {
+      return [](FlatBuilder &fb)
+      { return fb.table({}); };
+    }
+
+    Child field_fb(const ArrowField &f, std::int64_t dict_id)
+    {
+      return [f, dict_id](FlatBuilder &fb)
+      {
+        std::vector<Slot> slots;
+        slots.push_back(FlatBuilder::offset(0, [&f](FlatBuilder &b)
+                                            { return b.string(f.name); }));
+        slots.push_back(FlatBuilder::scalar(1, 1, 0)); // nullable = false
+
+        switch (f.type)
+        {
+        case ArrowType::Int64:
+          slots.push_back(FlatBuilder::scalar(2, 1, k_type_int));
+          slots.push_back(FlatBuilder::offset(3, int_type(64, true)));
+          break;
+        case ArrowType::UInt16:
+          slots.push_back(FlatBuilder::scalar(2, 1, k_type_int));
+          slots.push_back(FlatBuilder::offset(3, int_type(16, false)));
+          break;
+        case ArrowType::Bool:
+          slots.push_back(FlatBuilder::scalar(2, 1, k_type_bool));
+          slots.push_back(FlatBuilder::offset(3, empty_table()));
+          break;
+        case ArrowType::Utf8:
+        case ArrowType::DictUtf8:
+          slots.push_back(FlatBuilder::scalar(2, 1, k_type_utf8));
+          slots.push_back(FlatBuilder::offset(3, empty_table()));
+          break;
+        }
+
+        if (f.type == ArrowType::DictUtf8)
+        {
+          // DictionaryEncoding { id, indexType: Int32, isOrdered: false }
+          slots.push_back(FlatBuilder::offset(4, [dict_id](FlatBuilder &b)
+                                              { return b.table({FlatBuilder::scalar(0, 8, std::uint64_t(dict_id)),
+                                                                FlatBuilder::offset(1, int_type(32, true))}); }));
+        }
+
+        // Readers require the children vector even when empty.
+        slots.push_back(FlatBuilder::offset(5, [](FlatBuilder &b)
+                                            { return b.offsets({}); }));
+        return fb.table(std::move(slots));
+      };
+    }
+
+    // Body buffers laid out 8-byte aligned; fills the RecordBatch metadata.
+    struct BatchBody
+    {
+      std::string body;
+      std::string nodes;   // FieldNode { length, null_count }
+      std::string buffers; // Buffer { offset, length }
+      std::size_t n_nodes = 0;
+      std::size_t n_buffers = 0;
+
+      void node(std::size_t length)
+      {
+        append_le(nodes, static_cast<std::int64_t>(length));
+        append_le(nodes, static_cast<std::int64_t>(0));
+        ++n_nodes;
+      }
+
+      void buffer(std::string_view data)
+      {
+        append_le(buffers, static_cast<std::int64_t>(body.size()));
+        append_le(buffers, static_cast<std::int64_t>(data.size()));
+        ++n_buffers;
+        body.append(data);
+        body.resize(pad8(body.size()), '\0');
+      }
+
+      void column(const ArrowColumn &c)
+      {
+        node(c.length());
+        buffer({}); // validity: no nulls
+        for (const auto b : c.buffers())
+          buffer(b);
+      }
+    };
+
+    Child record_batch_fb(std::size_t length, const BatchBody &bb)
+    {
+      return [length, &bb](FlatBuilder &fb)
+      {
+        return fb.table({FlatBuilder::scalar(0, 8, std::uint64_t(length)),
+                         FlatBuilder::offset(1, [&bb](FlatBuilder &b)
+                                             { return b.structs(bb.nodes, bb.n_nodes); }),
+                         FlatBuilder::offset(2, [&bb](FlatBuilder &b)
+                                             { return b.structs(bb.buffers, bb.n_buffers); })});
+      };
+    }
+
+    // Encapsulated message: continuation, metadata size, Message, body.
+    void write_message(std::string &out, std::uint8_t header_type, const Child &header, const std::string &body)
+    {
+      FlatBuilder fb;
+      std::string meta = fb.finish([&](FlatBuilder &b)
+                                   { return b.table({FlatBuilder::scalar(0, 2, std::uint16_t(k_metadata_v5)),
+                                                     FlatBuilder::scalar(1, 1, header_type),
+                                                     FlatBuilder::offset(2, header),
+                                                     FlatBuilder::scalar(3, 8, std::uint64_t(body.size()))}); });
+      meta.resize(pad8(meta.size()), '\0');
+
+      append_le(out, static_cast<std::uint32_t>(0xFFFFFFFFu));
+      append_le(out, static_cast<std::int32_t>(meta.size()));
+      out.append(meta);
+      out.append(body);
+    }
+  }
+
+  void ArrowColumn::reserve(std::size_t rows, std::size_t text_bytes)
+  {
+    switch (type_)
+    {
+    case ArrowType::Int64: values_.reserve(rows * 8); break;
+    case ArrowType::UInt16: values_.reserve(rows * 2); break;
+    case ArrowType::Bool: values_.reserve(rows / 8 + 1); break;
+    case ArrowType::DictUtf8: values_.reserve(rows * 4); break;
+    case ArrowType::Utf8:
+      values_.reserve(text_bytes);
+      offsets_.reserve((rows + 1) * 4);
+      break;
+    }
+  }
+
+  template <class T>
+  void ArrowColumn::push_raw(T v)
+  {
+    append_le(values_, v);
+    ++length_;
+  }
+
+  void ArrowColumn::push_int64(std::int64_t v) { push_raw(v); }
+  void ArrowColumn::push_uint16(std::uint16_t v) { push_raw(v); }
+  void ArrowColumn::push_index(std::int32_t i) { push_raw(i); }
+
+  void ArrowColumn::push_bool(bool v)
+  {
+    if (length_ % 8 == 0)
+      values_.push_back('\0');
+    if (v)
+      values_.back() = static_cast<char>(values_.back() | (1 << (length_ % 8)));
+    ++length_;
+  }
+
+  void ArrowColumn::push_utf8(std::string_view s)
+  {
+    if (offsets_.empty())
+      append_le(offsets_, std::int32_t(0));
+    values_.append(s);
+    append_le(offsets_, static_cast<std::int32_t>(values_.size()));
+    ++length_;
+  }
+
+  std::vector<std::string_view> ArrowColumn::buffers() const
+  {
+    if (type_ != ArrowType::Utf8)
+      return {values_};
+
+    // An empty column still needs its single 0 offset.
+    static const std::string k_zero_offset(4, '\0');
+    return {offsets_.empty() ? std::string_view(k_zero_offset) : std::string_view(offsets_), values_};
+  }
+
+  void ArrowColumn::clear()
+  {
+    length_ = 0;
+    values_.clear();
+    offsets_.clear();
+  }
+
+  void ArrowStreamWriter::schema(const std::vector<ArrowField> &fields)
+  {
+    fields_ = fields;
+
+    write_message(out_, k_header_schema, [this](FlatBuilder &fb)
+                  {
+                    std::vector<Child> items;
+                    items.reserve(fields_.size());
+                    for (std::size_t i = 0; i < fields_.size(); ++i)
+                      items.push_back(field_fb(fields_[i], static_cast<std::int64_t>(i)));
+                    return fb.table({FlatBuilder::offset(1, [&items](FlatBuilder &b)
+                                                         { return b.offsets(items); })}); },
+                  std::string{});
+  }
+
+  void ArrowStreamWriter::dictionary(std::size_t field, const std::vector<std::string_view> &values)
+  {
+    ArrowColumn col(ArrowType::Utf8);
+    std::size_t bytes = 0;
+    for (const auto v : values)
+      bytes += v.size();
+    col.reserve(values.size(), bytes);
+    for (const auto v : values)
+      col.push_utf8(v);
+
+    BatchBody bb;
+    bb.column(col);
+
+    const auto id = static_cast<std::int64_t>(field);
+    write_message(out_, k_header_dictionary, [&](FlatBuilder &fb)
+                  { return fb.table({FlatBuilder::scalar(0, 8, std::uint64_t(id)),
+                                     FlatBuilder::offset(1, record_batch_fb(col.length(), bb))}); },
+                  bb.body);
+  }
+
+  void ArrowStreamWriter::batch(const std::vector<ArrowColumn> &columns)
+  {
+    BatchBody bb;
+    for (const auto &c : columns)
+      bb.column(c);
+
+    const std::size_t length = columns.empty() ? 0 : columns.front().length();
+    write_message(out_, k_header_record_batch, record_batch_fb(length, bb), bb.body);
+  }
+
+  void ArrowStreamWriter::finish()
+  {
+    append_le(out_, static_cast<std::uint32_t>(0xFFFFFFFFu));
+    append_le(out_, static_cast<std::uint32_t>(0));
+  }
+
+  namespace
+  {
+    template <class T>
+    T get_le(std::string_view buf, std::size_t pos)
+    {
+      std::uint64_t v = 0;
+      for (std::size_t i = 0; i < sizeof(T); ++i)
+        v |= static_cast<std::uint64_t>(static_cast<unsigned char>(buf[pos + i])) << (8 * i);
+      return static_cast<T>(v);
+    }
+
+    /**
+     * Bounds-checked FlatBuffers reader. Position 0 holds the root offset,
+     * so it doubles as "absent"; an out-of-range offset clears ok() and
+     * reads as absent.
+     */
+    class FlatReader
+    {
+    public:
+      explicit FlatReader(std::string_view buf) : buf_(buf) {}
+
+      bool ok() const noexcept { return ok_; }
+
+      std::size_t root() { return deref(0); }
+
+      template <class T>
+      T scalar(std::size_t table, std::uint16_t id, T def = T{})
+      {
+        const std::size_t at = slot(table, id);
+        return (at != 0 && fits(at, sizeof(T))) ? get_le<T>(buf_, at) : def;
+      }
+
+      // Table, string or vector referenced by field `id`.
+      std::size_t child(std::size_t table, std::uint16_t id)
+      {
+        const std::size_t at = slot(table, id);
+        return at == 0 ? 0 : deref(at);
+      }
+
+      std::uint32_t count(std::size_t vec)
+      {
+        return (vec != 0 && fits(vec, 4)) ? get_le<std::uint32_t>(buf_, vec) : 0;
+      }
+
+      // Table referenced by element `i` of an offsets vector.
+      std::size_t element(std::size_t vec, std::size_t i)
+      {
+        return deref(vec + 4 + 4 * i);
+      }
+
+      std::string_view string(std::size_t at)
+      {
+        return bytes(at, 1);
+      }
+
+      // Raw contents of a vector of `size`-byte structs.
+      std::string_view bytes(std::size_t vec, std::size_t size)
+      {
+        const std::size_t n = count(vec) * size;
+        return (vec != 0 && fits(vec + 4, n)) ? buf_.substr(vec + 4, n) : std::string_view{};
+      }
+
+    private:
+      bool fits(std::size_t at, std::size_t n)
+      {
+        if (at <= buf_.size() && n <= buf_.size() - at)
+          return true;
+        ok_ = false;
+        return false;
+      }
+
+      std::size_t deref(std::size_t at)
+      {
+        if (!fits(at, 4))
+          return 0;
+        const std::size_t target = at + get_le<std::uint32_t>(buf_, at);
+        return fits(target, 4) ? target : 0;
+      }
+
+      // Position of field `id` in `table`, or 0 when it is not set.
+      std::size_t slot(std::size_t table, std::uint16_t id)
+      {
+        if (table == 0 || !fits(table, 4))
+          return 0;
+        const auto soff = get_le<std::int32_t>(buf_, table);
+        if (soff > static_cast<std::int64_t>(table) || !fits(table - soff, 4))
+        {
+          ok_ = false;
+          return 0;
+        }
+        const std::size_t vtable = table - soff;
+        const std::size_t entry = 4 + 2 * std::size_t(id);
+        if (entry + 2 > get_le<std::uint16_t>(buf_, vtable) || !fits(vtable + entry, 2))
+          return 0;
+        const auto off = get_le<std::uint16_t>(buf_, vtable + entry);
+        return off == 0 ? 0 : table + off;
+      }
+
+      std::string_view buf_;
+      bool ok_ = true;
+    };
+
+    // Integer encoding of a column or of dictionary indices.
+    struct IntLayout
+    {
+      int bits = 64;
+      bool is_signed = true;
+
+      std::size_t width() const noexcept { return static_cast<std::size_t>(bits / 8); }
+
+      std::int64_t at(std::string_view values, std::size_t i) const
+      {
+        const std::size_t pos = i * width();
+        switch (bits)
+        {
+        case 8: return is_signed ? std::int64_t(get_le<std::int8_t>(values, pos)) : std::int64_t(get_le<std::uint8_t>(values, pos));
+        case 16: return is_signed ? std::int64_t(get_le<std::int16_t>(values, pos)) : std::int64_t(get_le<std::uint16_t>(values, pos));
+        case 32: return is_signed ? std::int64_t(get_le<std::int32_t>(values, pos)) : std::int64_t(get_le<std::uint32_t>(values, pos));
+        default: return get_le<std::int64_t>(values, pos);
+        }
+      }
+    };
+
+    bool read_int_layout(FlatReader &fb, std::size_t int_table, IntLayout &out)
+    {
+      out.bits = fb.scalar<std::int32_t>(int_table, 0);
+      out.is_signed = fb.scalar<std::uint8_t>(int_table, 1) != 0;
+      return out.bits == 8 || out.bits == 16 || out.bits == 32 || out.bits == 64;
+    }
+
+    // Walks the FieldNode and Buffer vectors of one RecordBatch.
+    class BatchCursor
+    {
+    public:
+      BatchCursor(FlatReader &fb, std::size_t batch, std::string_view body)
+          : nodes_(fb.bytes(fb.child(batch, 1), 16)),
+            buffers_(fb.bytes(fb.child(batch, 2), 16)),
+            body_(body),
+            compressed_(fb.child(batch, 3) != 0)
+      {
+      }
+
+      bool compressed() const noexcept { return compressed_; }
+
+      // Length of the next column; nulls are not supported.
+      bool node(std::size_t &length, std::string &error)
+      {
+        if (nodes_.size() < 16 * (node_ + 1))
+          return fail(error, "missing field node");
+        const auto len = get_le<std::int64_t>(nodes_, 16 * node_);
+        const auto nulls = get_le<std::int64_t>(nodes_, 16 * node_ + 8);
+        ++node_;
+        if (nulls != 0)
+          return fail(error, "null values are not supported");
+        if (len < 0 || static_cast<std::uint64_t>(len) > body_.size() * 8 + 8)
+          return fail(error, "bad column length");
+        length = static_cast<std::size_t>(len);
+        return true;
+      }
+
+      bool buffer(std::string_view &out, std::string &error)
+      {
+        if (buffers_.size() < 16 * (buffer_ + 1))
+          return fail(error, "missing buffer");
+        const auto off = get_le<std::int64_t>(buffers_, 16 * buffer_);
+        const auto len = get_le<std::int64_t>(buffers_, 16 * buffer_ + 8);
+        ++buffer_;
+        if (off < 0 || len < 0 || static_cast<std::uint64_t>(off) > body_.size() ||
+            static_cast<std::uint64_t>(len) > body_.size() - static_cast<std::uint64_t>(off))
+          return fail(error, "buffer out of range");
+        out = body_.substr(static_cast<std::size_t>(off), static_cast<std::size_t>(len));
+        return true;
+      }
+
+      bool ints(std::size_t length, const IntLayout &layout, std::vector<std::int64_t> &out, std::string &error)
+      {
+        std::string_view validity, values;
+        if (!buffer(validity, error) || !buffer(values, error))
+          return false;
+        if (values.size() / layout.width() < length)
+          return fail(error, "short int buffer");
+        for (std::size_t i = 0; i < length; ++i)
+          out.push_back(layout.at(values, i));
+        return true;
+      }
+
+      bool bools(std::size_t length, std::vector<std::int64_t> &out, std::string &error)
+      {
+        std::string_view validity, bits;
+        if (!buffer(validity, error) || !buffer(bits, error))
+          return false;
+        if (bits.size() < (length + 7) / 8)
+          return fail(error, "short bool buffer");
+        for (std::size_t i = 0; i < length; ++i)
+          out.push_back((static_cast<unsigned char>(bits[i / 8]) >> (i % 8)) & 1);
+        return true;
+      }
+
+      bool utf8(std::size_t length, std::vector<std::string> &out, std::string &error)
+      {
+        std::string_view validity, offsets, data;
+        if (!buffer(validity, error) || !buffer(offsets, error) || !buffer(data, error))
+          return false;
+        if (offsets.size() / 4 < length + 1)
+          return fail(error, "short offsets buffer");
+        auto prev = get_le<std::int32_t>(offsets, 0);
+        for (std::size_t i = 0; i < length; ++i)
+        {
+          const auto next = get_le<std::int32_t>(offsets, 4 * (i + 1));
+          if (prev < 0 || next < prev || static_cast<std::size_t>(next) > data.size())
+            return fail(error, "bad string offsets");
+          out.emplace_back(data.substr(static_cast<std::size_t>(prev), static_cast<std::size_t>(next - prev)));
+          prev = next;
+        }
+        return true;
+      }
+
+    private:
+      static bool fail(std::string &error, const char *why)
+      {
+        error = why;
+        return false;
+      }
+
+      std::string_view nodes_;
+      std::string_view buffers_;
+      std::string_view body_;
+      bool compressed_ = false;
+      std::size_t node_ = 0;
+      std::size_t buffer_ = 0;
+    };
+
+    class StreamDecoder
+    {
+    public:
+      ArrowTable table;
+      std::string error;
+
+      bool has_schema() const noexcept { return have_schema_; }
+
+      bool message(std::uint8_t type, FlatReader &fb, std::size_t header, std::string_view body)
+      {
+        if (header == 0)
+          return fail("message without header");
+        if (type == k_header_schema)
+          return schema(fb, header);
+        if (!have_schema_)
+          return fail("message before schema");
+        if (type == k_header_dictionary)
+          return dictionary(fb, header, body);
+        if (type == k_header_record_batch)
+          return batch(fb, header, body);
+        return fail("unexpected message type");
+      }
+
+    private:
+      struct FieldInfo
+      {
+        IntLayout ints;
+        IntLayout index;
+        std::int64_t dict_id = -1;
+      };
+
+      bool fail(const char *why)
+      {
+        error = why;
+        return false;
+      }
+
+      bool schema(FlatReader &fb, std::size_t schema_table)
+      {
+        if (have_schema_)
+          return fail("second schema");
+        have_schema_ = true;
+
+        const std::size_t vec = fb.child(schema_table, 1);
+        const std::size_t n = fb.bytes(vec, 4).size() / 4;
+        table.fields.reserve(n);
+        fields_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          const std::size_t f = fb.element(vec, i);
+          ArrowField field;
+          field.name = std::string(fb.string(fb.child(f, 0)));
+
+          FieldInfo info;
+          const auto type = fb.scalar<std::uint8_t>(f, 2);
+          if (type == k_type_int)
+          {
+            if (!read_int_layout(fb, fb.child(f, 3), info.ints))
+              return fail("unsupported int width");
+            field.type = (info.ints.bits == 16 && !info.ints.is_signed) ? ArrowType::UInt16 : ArrowType::Int64;
+          }
+          else if (type == k_type_bool)
+            field.type = ArrowType::Bool;
+          else if (type == k_type_utf8)
+            field.type = ArrowType::Utf8;
+          else
+            return fail("unsupported field type");
+
+          if (const std::size_t dict = fb.child(f, 4); dict != 0)
+          {
+            if (field.type != ArrowType::Utf8)
+              return fail("unsupported dictionary value type");
+            info.dict_id = fb.scalar<std::int64_t>(dict, 0);
+            info.index = IntLayout{32, true};
+            if (const std::size_t index = fb.child(dict, 1); index != 0 && !read_int_layout(fb, index, info.index))
+              return fail("unsupported dictionary index width");
+            field.type = ArrowType::DictUtf8;
+          }
+
+          table.fields.push_back(std::move(field));
+          fields_.push_back(info);
+        }
+
+        table.ints.resize(n);
+        table.texts.resize(n);
+        return true;
+      }
+
+      bool dictionary(FlatReader &fb, std::size_t dict_batch, std::string_view body)
+      {
+        const auto id = fb.scalar<std::int64_t>(dict_batch, 0);
+        const bool delta = fb.scalar<std::uint8_t>(dict_batch, 2) != 0;
+
+        BatchCursor c(fb, fb.child(dict_batch, 1), body);
+        if (c.compressed())
+          return fail("compressed bodies are not supported");
+
+        auto &values = dicts_[id];
+        if (!delta)
+          values.clear();
+        std::size_t length = 0;
+        return c.node(length, error) && c.utf8(length, values, error);
+      }
+
+      bool batch(FlatReader &fb, std::size_t record_batch, std::string_view body)
+      {
+        const auto rows = fb.scalar<std::int64_t>(record_batch, 0);
+        BatchCursor c(fb, record_batch, body);
+        if (c.compressed())
+          return fail("compressed bodies are not supported");
+
+        for (std::size_t i = 0; i < table.fields.size(); ++i)
+        {
+          std::size_t length = 0;
+          if (!c.node(length, error))
+            return false;
+          if (static_cast<std::int64_t>(length) != rows)
+            return fail("column length differs from batch length");
+
+          const FieldInfo &info = fields_[i];
+          bool ok = false;
+          switch (table.fields[i].type)
+          {
+          case ArrowType::Int64:
+          case ArrowType::UInt16:
+            ok = c.ints(length, info.ints, table.ints[i], error);
+            break;
+          case ArrowType::Bool:
+            ok = c.bools(length, table.ints[i], error);
+            break;
+          case ArrowType::Utf8:
+            ok = c.utf8(length, table.texts[i], error);
+            break;
+          case ArrowType::DictUtf8:
+            ok = resolve(c, length, info, table.texts[i]);
+            break;
+          }
+          if (!ok)
+            return false;
+        }
+        table.rows += static_cast<std::size_t>(rows);
+        return true;
+      }
+
+      bool resolve(BatchCursor &c, std::size_t length, const FieldInfo &info, std::vector<std::string> &out)
+      {
+        const auto it = dicts_.find(info.dict_id);
+        if (it == dicts_.end())
+          return fail("batch before its dictionary");
+
+        std::vector<std::int64_t> indices;
+        indices.reserve(length);
+        if (!c.ints(length, info.index, indices, error))
+          return false;
+        for (const auto i : indices)
+        {
+          if (i < 0 || static_cast<std::uint64_t>(i) >= it->second.size())
+            return fail("dictionary index out of range");
+          out.push_back(it->second[static_cast<std::size_t>(i)]);
+        }
+        return true;
+      }
+
+      bool have_schema_ = false;
+      std::vector<FieldInfo> fields_;
+      std::unordered_map<std::int64_t, std::vector<std::string>> dicts_;
+    };
+  }
+
+  std::size_t ArrowTable::column(std::string_view name) const noexcept
+  {
+    for (std::size_t i = 0; i < fields.size(); ++i)
+    {
+      if (fields[i].name == name)
+        return i;
+    }
+    return static_cast<std::size_t>(-1);
+  }
+
+  std::optional<ArrowTable> read_arrow_stream(std::string_view in, std::string *error)
+  {
+    StreamDecoder d;
+    auto fail = [&](const std::string &why) -> std::optional<ArrowTable>
+    {
+      if (error)
+        *error = why;
+      return std::nullopt;
+    };
+
+    // A stream may also just end after its last message.
+    std::size_t pos = 0;
+    while (pos < in.size())
+    {
+      if (in.size() - pos < 4)
+        return fail("truncated stream");
+      auto meta_len = get_le<std::uint32_t>(in, pos);
+      pos += 4;
+      if (meta_len == 0xFFFFFFFFu)
+      {
+        if (in.size() - pos < 4)
+          return fail("truncated stream");
+        meta_len = get_le<std::uint32_t>(in, pos);
+        pos += 4;
+      }
+      if (meta_len == 0)
+        break;
+      if (meta_len > in.size() - pos)
+        return fail("truncated stream");
+
+      FlatReader fb(in.substr(pos, meta_len));
+      pos += meta_len;
+
+      const std::size_t msg = fb.root();
+      const auto type = fb.scalar<std::uint8_t>(msg, 1);
+      const std::size_t header = fb.child(msg, 2);
+      const auto body_len = fb.scalar<std::int64_t>(msg, 3);
+      if (body_len < 0 || static_cast<std::uint64_t>(body_len) > in.size() - pos)
+        return fail("truncated stream");
+      const std::string_view body = in.substr(pos, static_cast<std::size_t>(body_len));
+      pos += static_cast<std::size_t>(body_len);
+
+      if (!d.message(type, fb, header, body))
+        return fail(d.error);
+      if (!fb.ok())
+        return fail("malformed metadata");
+    }
+
+    if (!d.has_schema())
+      return fail("missing schema");
+    return std::move(d.table);
+  }
+} // namespace vix::p2p_http::detail
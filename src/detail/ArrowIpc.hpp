@@ -0,0 +1,139 @@
+/**
+ *
+ *  @file ArrowIpc.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_ARROW_IPC_HPP
+#define VIX_P2P_HTTP_DETAIL_ARROW_IPC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace vix::p2p_http::detail
+{
+  /** @brief Column types supported by the IPC writer (all non-nullable). */
+  enum class ArrowType
+  {
+    Int64,
+    UInt16,
+    Bool,
+    Utf8,
+
+    /** @brief Utf8 values, dictionary-encoded with int32 indices. */
+    DictUtf8,
+  };
+
+  struct ArrowField
+  {
+    std::string name;
+    ArrowType type = ArrowType::Int64;
+  };
+
+  /**
+   * @brief Values of one column for one record batch.
+   *
+   * Fixed-width values and bool bits go to `values`; Utf8 also fills
+   * `offsets`. DictUtf8 columns hold int32 indices into the dictionary
+   * written for that field.
+   */
+  class ArrowColumn
+  {
+  public:
+    explicit ArrowColumn(ArrowType type) : type_(type) {}
+
+    void reserve(std::size_t rows, std::size_t text_bytes = 0);
+
+    void push_int64(std::int64_t v);
+    void push_uint16(std::uint16_t v);
+    void push_bool(bool v);
+    void push_utf8(std::string_view s);
+    void push_index(std::int32_t i);
+
+    ArrowType type() const noexcept { return type_; }
+    std::size_t length() const noexcept { return length_; }
+
+    /** @brief Body buffers after the (empty) validity bitmap. */
+    std::vector<std::string_view> buffers() const;
+
+    void clear();
+
+  private:
+    template <class T>
+    void push_raw(T v);
+
+    ArrowType type_;
+    std::size_t length_ = 0;
+    std::string values_;
+    std::string offsets_;
+  };
+
+  /**
+   * @brief Arrow IPC streaming format writer (schema, dictionaries,
+   * record batches, end-of-stream), with metadata encoded by hand.
+   *
+   * Follows the columnar format, metadata version V5, little endian.
+   * Buffers are 8-byte aligned, so readers can map them without copies.
+   */
+  class ArrowStreamWriter
+  {
+  public:
+    explicit ArrowStreamWriter(std::string &out) : out_(out) {}
+
+    /** @brief Schema message. DictUtf8 fields get dictionary ids in field order. */
+    void schema(const std::vector<ArrowField> &fields);
+
+    /** @brief Dictionary for the `field`-th field (must be DictUtf8). */
+    void dictionary(std::size_t field, const std::vector<std::string_view> &values);
+
+    /** @brief One record batch; columns follow the schema order. */
+    void batch(const std::vector<ArrowColumn> &columns);
+
+    /** @brief End-of-stream marker. */
+    void finish();
+
+  private:
+    std::string &out_;
+    std::vector<ArrowField> fields_;
+  };
+
+  /**
+   * @brief Columns of a decoded Arrow IPC stream, batches concatenated.
+   *
+   * Integer and bool columns land in `ints` (widened to int64); Utf8 and
+   * dictionary-encoded Utf8 columns land in `texts`, with the indices
+   * already resolved. Both vectors are indexed by field.
+   */
+  struct ArrowTable
+  {
+    std::vector<ArrowField> fields;
+    std::vector<std::vector<std::int64_t>> ints;
+    std::vector<std::vector<std::string>> texts;
+    std::size_t rows = 0;
+
+    /** @brief Index of the field called `name`, or npos. */
+    std::size_t column(std::string_view name) const noexcept;
+  };
+
+  /**
+   * @brief Decode an Arrow IPC stream of the shape ArrowStreamWriter emits.
+   *
+   * Accepts int (up to 64 bits), bool and Utf8 fields, optionally
+   * dictionary-encoded. Nulls, compressed bodies and other types are
+   * rejected, as are truncated or malformed messages; `error` then says why.
+   */
+  std::optional<ArrowTable> read_arrow_stream(std::string_view in, std::string *error = nullptr);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_ARROW_IPC_HPP
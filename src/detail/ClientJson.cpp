@@ -0,0 +1,204 @@
+/**
+ *
+ *  @file ClientJson.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "ClientJson.hpp"
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  long long json_ll(const J::Json &j, const char *key)
+  {
+    const auto *v = J::jget(j, key);
+    return (v && v->is_number()) ? v->get<long long>() : 0;
+  }
+
+  std::string json_str(const J::Json &j, const char *key)
+  {
+    const auto *v = J::jget(j, key);
+    return (v && v->is_string()) ? v->get<std::string>() : std::string{};
+  }
+
+  bool json_bool(const J::Json &j, const char *key)
+  {
+    const auto *v = J::jget(j, key);
+    return v && v->is_boolean() && v->get<bool>();
+  }
+
+  PeerInfo peer_info_from_json(const J::Json &r)
+  {
+    PeerInfo p;
+    p.peer_id = json_str(r, "peer_id");
+    p.state = json_str(r, "state");
+    p.scheme = json_str(r, "scheme");
+    p.host = json_str(r, "host");
+    p.port = static_cast<int>(json_ll(r, "port"));
+    p.secure = json_bool(r, "secure");
+    p.handshake_stage = json_str(r, "handshake_stage");
+    p.last_seen_ms_ago = json_ll(r, "last_seen_ms_ago");
+    p.handshake_age_ms = json_ll(r, "handshake_age_ms");
+    p.runtime = json_str(r, "runtime");
+    return p;
+  }
+
+  std::vector<PeerInfo> peer_infos_from_columns(const J::Json &columns, const J::Json &rows)
+  {
+    std::vector<PeerInfo> out;
+    if (!columns.is_array() || !rows.is_array())
+      return out;
+
+    auto col = [&](std::string_view name) -> std::size_t
+    {
+      for (std::size_t i = 0; i < columns.size(); ++i)
+      {
+        if (columns[i].is_string() && columns[i].get_ref<const std::string &>() == name)
+          return i;
+      }
+      return static_cast<std::size_t>(-1);
+    };
+
+    const std::size_t c_peer_id = col("peer_id");
+    const std::size_t c_state = col("state");
+    const std::size_t c_scheme = col("scheme");
+    const std::size_t c_host = col("host");
+    const std::size_t c_port = col("port");
+    const std::size_t c_secure = col("secure");
+    const std::size_t c_stage = col("handshake_stage");
+    const std::size_t c_last_seen = col("last_seen_ms_ago");
+    const std::size_t c_hs_age = col("handshake_age_ms");
+    const std::size_t c_runtime = col("runtime");
+
+    auto cell = [](const J::Json &row, std::size_t i) -> const J::Json *
+    {
+      return i < row.size() ? &row[i] : nullptr;
+    };
+    auto str = [&](const J::Json &row, std::size_t i)
+    {
+      const auto *v = cell(row, i);
+      return (v && v->is_string()) ? v->get<std::string>() : std::string{};
+    };
+    auto num = [&](const J::Json &row, std::size_t i)
+    {
+      const auto *v = cell(row, i);
+      return (v && v->is_number()) ? v->get<long long>() : 0LL;
+    };
+
+    out.reserve(rows.size());
+    for (const auto &r : rows)
+    {
+      if (!r.is_array())
+        continue;
+
+      PeerInfo p;
+      p.peer_id = str(r, c_peer_id);
+      p.state = str(r, c_state);
+      p.scheme = str(r, c_scheme);
+      p.host = str(r, c_host);
+      p.port = static_cast<int>(num(r, c_port));
+      const auto *secure = cell(r, c_secure);
+      p.secure = secure && secure->is_boolean() && secure->get<bool>();
+      p.handshake_stage = str(r, c_stage);
+      p.last_seen_ms_ago = num(r, c_last_seen);
+      p.handshake_age_ms = num(r, c_hs_age);
+      p.runtime = str(r, c_runtime);
+      out.push_back(std::move(p));
+    }
+    return out;
+  }
+
+  std::vector<PeerInfo> peer_infos_from_arrow(const ArrowTable &t)
+  {
+    // Missing columns resolve to an empty one and read as ""/0.
+    static const std::vector<std::string> k_no_texts;
+    static const std::vector<std::int64_t> k_no_ints;
+    auto texts = [&](std::string_view name) -> const std::vector<std::string> &
+    {
+      const std::size_t c = t.column(name);
+      return c < t.texts.size() ? t.texts[c] : k_no_texts;
+    };
+    auto ints = [&](std::string_view name) -> const std::vector<std::int64_t> &
+    {
+      const std::size_t c = t.column(name);
+      return c < t.ints.size() ? t.ints[c] : k_no_ints;
+    };
+
+    const auto &peer_id = texts("peer_id");
+    const auto &state = texts("state");
+    const auto &scheme = texts("scheme");
+    const auto &host = texts("host");
+    const auto &port = ints("port");
+    const auto &secure = ints("secure");
+    const auto &stage = texts("handshake_stage");
+    const auto &last_seen = ints("last_seen_ms_ago");
+    const auto &hs_age = ints("handshake_age_ms");
+    const auto &runtime = texts("runtime");
+
+    auto str = [](const std::vector<std::string> &col, std::size_t i)
+    {
+      return i < col.size() ? col[i] : std::string{};
+    };
+    auto num = [](const std::vector<std::int64_t> &col, std::size_t i)
+    {
+      return i < col.size() ? static_cast<long long>(col[i]) : 0LL;
+    };
+
+    std::vector<PeerInfo> out;
+    out.reserve(t.rows);
+    for (std::size_t i = 0; i < t.rows; ++i)
+    {
+      PeerInfo p;
+      p.peer_id = str(peer_id, i);
+      p.state = str(state, i);
+      p.scheme = str(scheme, i);
+      p.host = str(host, i);
+      p.port = static_cast<int>(num(port, i));
+      p.secure = num(secure, i) != 0;
+      p.handshake_stage = str(stage, i);
+      p.last_seen_ms_ago = num(last_seen, i);
+      p.handshake_age_ms = num(hs_age, i);
+      p.runtime = str(runtime, i);
+      out.push_back(std::move(p));
+    }
+    return out;
+  }
+
+  std::optional<J::Json> parse_client_reply(const ClientResponse &r, std::string *error)
+  {
+    if (r.status == 0)
+    {
+      if (error)
+        *error = r.error;
+      return std::nullopt;
+    }
+
+    J::Json j = J::Json::parse(r.body, nullptr, false);
+    if (j.is_discarded() || !j.is_object())
+    {
+      if (error)
+        *error = "invalid_reply (HTTP " + std::to_string(r.status) + ")";
+      return std::nullopt;
+    }
+
+    if (!r.ok())
+    {
+      if (error)
+      {
+        const std::string e = json_str(j, "error");
+        *error = e.empty() ? "HTTP " + std::to_string(r.status) : e;
+      }
+      return std::nullopt;
+    }
+    return j;
+  }
+} // namespace vix::p2p_http::detail
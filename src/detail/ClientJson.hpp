@@ -0,0 +1,50 @@
+/**
+ *
+ *  @file ClientJson.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_CLIENT_JSON_HPP
+#define VIX_P2P_HTTP_DETAIL_CLIENT_JSON_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <vix/json/json.hpp>
+#include <vix/p2p_http/P2PHttpClient.hpp>
+
+#include "ArrowIpc.hpp"
+
+namespace vix::p2p_http::detail
+{
+  long long json_ll(const vix::json::Json &j, const char *key);
+  std::string json_str(const vix::json::Json &j, const char *key);
+  bool json_bool(const vix::json::Json &j, const char *key);
+
+  /** @brief One GET /peers row as seen by the client. */
+  PeerInfo peer_info_from_json(const vix::json::Json &row);
+
+  /** @brief Rows of a GET /peers?compact=1 reply, located by column name. */
+  std::vector<PeerInfo> peer_infos_from_columns(const vix::json::Json &columns, const vix::json::Json &rows);
+
+  /** @brief Rows of a decoded GET /peers.arrow stream, located by column name. */
+  std::vector<PeerInfo> peer_infos_from_arrow(const ArrowTable &table);
+
+  /**
+   * @brief Parse a JSON object reply.
+   *
+   * Fails on transport errors, non-object bodies and non-2xx statuses;
+   * `error` then gets the reply's "error" field or a generic reason.
+   */
+  std::optional<vix::json::Json> parse_client_reply(const ClientResponse &r, std::string *error);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_CLIENT_JSON_HPP
@@ -0,0 +1,184 @@
+/**
+ *
+ *  @file ConfigWatcher.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "ConfigWatcher.hpp"
+#include "LiveConfig.hpp"
+#include "ThreadTuning.hpp"
+
+#include <vix/json/json.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  ConfigWatcher::~ConfigWatcher()
+  {
+    stop();
+  }
+
+  void ConfigWatcher::start(std::string path, LogFn log)
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (thread_.joinable())
+      return;
+
+    path_ = std::move(path);
+    log_ = std::move(log);
+    stop_.store(false);
+
+    reload();
+    thread_ = std::thread([this]()
+                          { run(); });
+  }
+
+  void ConfigWatcher::stop()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_.store(true);
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+  bool ConfigWatcher::reload()
+  {
+    std::ifstream in(path_, std::ios::binary);
+    if (!in)
+    {
+      if (log_)
+        log_("[p2p_http] config file unreadable: " + path_);
+      return false;
+    }
+
+    const std::string text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    J::Json doc;
+    try
+    {
+      doc = J::Json::parse(text);
+    }
+    catch (...)
+    {
+      if (log_)
+        log_("[p2p_http] config rejected (invalid_json), keeping previous: " + path_);
+      return false;
+    }
+
+    const auto result = apply_config_file(doc);
+    if (!result.ok)
+    {
+      if (log_)
+        log_("[p2p_http] config rejected (" + result.error +
+             (result.field.empty() ? std::string{} : " " + result.field) +
+             "), keeping previous: " + path_);
+      return false;
+    }
+
+    if (log_)
+      log_("[p2p_http] config reloaded: " + path_);
+    return true;
+  }
+
+#if defined(__linux__)
+  void ConfigWatcher::run()
+  {
+    const ThreadPolicyScope policy("config_watcher");
+
+    const std::filesystem::path file(path_);
+    const std::string dir = file.has_parent_path() ? file.parent_path().string() : std::string{"."};
+    const std::string name = file.filename().string();
+
+    const int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+      if (log_)
+        log_("[p2p_http] inotify unavailable, config watcher stopped");
+      return;
+    }
+
+    // Watch the directory: editors often replace the file through a rename.
+    if (::inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+      if (log_)
+        log_("[p2p_http] cannot watch config directory: " + dir);
+      ::close(fd);
+      return;
+    }
+
+    alignas(struct inotify_event) char buf[4096];
+
+    while (!stop_.load())
+    {
+      pollfd pfd{fd, POLLIN, 0};
+      const int rc = ::poll(&pfd, 1, 250);
+      if (rc <= 0 || !(pfd.revents & POLLIN))
+        continue;
+
+      bool touched = false;
+      for (;;)
+      {
+        const ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0)
+          break;
+
+        for (char *p = buf; p < buf + n;)
+        {
+          const auto *ev = reinterpret_cast<const struct inotify_event *>(p);
+          if (ev->len > 0 && name == ev->name)
+            touched = true;
+          p += sizeof(struct inotify_event) + ev->len;
+        }
+      }
+
+      // One apply per burst of events (write + close + rename).
+      if (touched)
+        reload();
+    }
+
+    ::close(fd);
+  }
+#else
+  void ConfigWatcher::run()
+  {
+    const ThreadPolicyScope policy("config_watcher");
+
+    std::error_code ec;
+    auto last = std::filesystem::last_write_time(path_, ec);
+
+    while (!stop_.load())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+      const auto now = std::filesystem::last_write_time(path_, ec);
+      if (!ec && now != last)
+      {
+        last = now;
+        reload();
+      }
+    }
+  }
+#endif
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,66 @@
+/**
+ *
+ *  @file ConfigWatcher.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_CONFIG_WATCHER_HPP
+#define VIX_P2P_HTTP_DETAIL_CONFIG_WATCHER_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Watch a JSON options file and apply it to the live config.
+   *
+   * On Linux the parent directory is watched with inotify so that editors
+   * replacing the file (write + rename) are picked up; elsewhere the file
+   * mtime is polled. Each change goes through apply_config_file(): the
+   * config is rebuilt from the registration options and the whole file,
+   * so a removed field reverts, and an invalid file is rejected with the
+   * previous config left active.
+   */
+  class ConfigWatcher
+  {
+  public:
+    using LogFn = std::function<void(std::string)>;
+
+    ConfigWatcher() = default;
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+
+    /** @brief Apply the file once, then watch it from a background thread. */
+    void start(std::string path, LogFn log);
+
+    /** @brief Stop watching (joins the thread). */
+    void stop();
+
+    /** @brief Read and apply the file now. Returns true when applied. */
+    bool reload();
+
+  private:
+    void run();
+
+    std::mutex mu_;
+    std::string path_;
+    LogFn log_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_CONFIG_WATCHER_HPP
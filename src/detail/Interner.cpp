@@ -0,0 +1,226 @@
+/**
+ *
+ *  @file Interner.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "Interner.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace vix::p2p_http::detail
+{
+  Interner::Interner()
+  {
+    by_id_.emplace_back();
+    seen_.push_back(0);
+    ids_.emplace(std::string_view{}, Symbol{0});
+  }
+
+  void Interner::touch_locked(Symbol id) const noexcept
+  {
+    // Many readers hit the same hot ids: write only on a generation change.
+    std::atomic_ref<std::uint32_t> seen(seen_[id]);
+    if (seen.load(std::memory_order_relaxed) != gen_)
+      seen.store(gen_, std::memory_order_relaxed);
+  }
+
+  std::string_view Interner::store_locked(std::string_view s)
+  {
+    // Oversized strings get a chunk of their own; the current chunk stays open.
+    if (s.size() > k_chunk_bytes / 4)
+    {
+      auto own = std::make_unique<char[]>(s.size());
+      std::memcpy(own.get(), s.data(), s.size());
+      const std::string_view out{own.get(), s.size()};
+      chunks_.insert(chunks_.end() - (chunks_.empty() ? 0 : 1), std::move(own));
+      arena_bytes_ += s.size();
+      return out;
+    }
+
+    if (k_chunk_bytes - chunk_used_ < s.size())
+    {
+      chunks_.push_back(std::make_unique<char[]>(k_chunk_bytes));
+      chunk_used_ = 0;
+      arena_bytes_ += k_chunk_bytes;
+    }
+
+    char *dst = chunks_.back().get() + chunk_used_;
+    std::memcpy(dst, s.data(), s.size());
+    chunk_used_ += s.size();
+    return {dst, s.size()};
+  }
+
+  Symbol Interner::intern(std::string_view s)
+  {
+    {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      auto it = ids_.find(s);
+      if (it != ids_.end())
+      {
+        touch_locked(it->second);
+        return it->second;
+      }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto it = ids_.find(s);
+    if (it != ids_.end())
+    {
+      seen_[it->second] = gen_;
+      return it->second;
+    }
+
+    const std::string_view stored = store_locked(s);
+    Symbol id = 0;
+    if (!free_.empty())
+    {
+      id = free_.back();
+      free_.pop_back();
+      by_id_[id] = stored;
+      seen_[id] = gen_;
+    }
+    else
+    {
+      id = static_cast<Symbol>(by_id_.size());
+      by_id_.push_back(stored);
+      seen_.push_back(gen_);
+    }
+    ids_.emplace(stored, id);
+    live_bytes_ += s.size();
+    ++interned_since_collect_;
+    return id;
+  }
+
+  Symbol Interner::find(std::string_view s) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    auto it = ids_.find(s);
+    if (it == ids_.end())
+      return k_unknown_symbol;
+    // The caller filters with the id: keep it alive for this generation.
+    touch_locked(it->second);
+    return it->second;
+  }
+
+  std::string_view Interner::view(Symbol id) const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return id < by_id_.size() ? by_id_[id] : std::string_view{};
+  }
+
+  std::size_t Interner::collect(const std::function<void(std::vector<Symbol> &)> &roots,
+                                std::chrono::milliseconds min_interval)
+  {
+    {
+      std::unique_lock<std::shared_mutex> lock(mu_);
+      const auto now = std::chrono::steady_clock::now();
+      if (collected_at_ != std::chrono::steady_clock::time_point{} && now - collected_at_ < min_interval)
+        return 0;
+      collected_at_ = now;
+      ++gen_;
+      interned_since_collect_ = 0;
+    }
+
+    // Roots are gathered under their owners' locks, never under ours:
+    // those owners format rows while holding a Reader.
+    std::vector<Symbol> held;
+    if (roots)
+      roots(held);
+
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    const std::size_t before = bytes_locked();
+
+    for (const Symbol id : held)
+    {
+      if (id < seen_.size())
+        seen_[id] = gen_;
+    }
+
+    // Ids freed last time went a whole generation without a lookup.
+    free_.insert(free_.end(), freeing_.begin(), freeing_.end());
+    freeing_.clear();
+
+    for (std::size_t id = 1; id < by_id_.size(); ++id)
+    {
+      const std::string_view s = by_id_[id];
+      if (s.empty() || seen_[id] + 1 >= gen_)
+        continue;
+      ids_.erase(s);
+      live_bytes_ -= s.size();
+      by_id_[id] = {};
+      freeing_.push_back(static_cast<Symbol>(id));
+    }
+
+    if (arena_bytes_ > k_chunk_bytes && live_bytes_ < arena_bytes_ / 2)
+      compact_locked();
+
+    const std::size_t after = bytes_locked();
+    return before > after ? before - after : 0;
+  }
+
+  // Copies the live strings into fresh chunks; ids keep their values.
+  void Interner::compact_locked()
+  {
+    std::vector<std::unique_ptr<char[]>> old;
+    old.swap(chunks_);
+    chunk_used_ = k_chunk_bytes;
+    arena_bytes_ = 0;
+
+    std::unordered_map<std::string_view, Symbol> ids;
+    ids.reserve(by_id_.size() - free_.size() - freeing_.size());
+    ids.emplace(std::string_view{}, Symbol{0});
+    for (std::size_t id = 1; id < by_id_.size(); ++id)
+    {
+      if (by_id_[id].empty())
+        continue;
+      by_id_[id] = store_locked(by_id_[id]);
+      ids.emplace(by_id_[id], static_cast<Symbol>(id));
+    }
+    ids_.swap(ids);
+  }
+
+  std::size_t Interner::interned_since_collect() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return interned_since_collect_;
+  }
+
+  std::size_t Interner::size() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return by_id_.size() - free_.size() - freeing_.size();
+  }
+
+  std::size_t Interner::bytes() const
+  {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return bytes_locked();
+  }
+
+  std::size_t Interner::bytes_locked() const
+  {
+    return arena_bytes_ +
+           by_id_.capacity() * sizeof(std::string_view) +
+           seen_.capacity() * sizeof(std::uint32_t) +
+           (free_.capacity() + freeing_.capacity()) * sizeof(Symbol) +
+           ids_.size() * (sizeof(std::string_view) + sizeof(Symbol) + 2 * sizeof(void *)) +
+           ids_.bucket_count() * sizeof(void *);
+  }
+
+  Interner &interner()
+  {
+    static Interner table;
+    return table;
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,144 @@
+/**
+ *
+ *  @file Interner.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_INTERNER_HPP
+#define VIX_P2P_HTTP_DETAIL_INTERNER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vix::p2p_http::detail
+{
+  /** @brief Interned string id. 0 is always the empty string. */
+  using Symbol = std::uint32_t;
+
+  /** @brief Returned by Interner::find() for strings never interned. */
+  inline constexpr Symbol k_unknown_symbol = 0xFFFFFFFFu;
+
+  /**
+   * @brief Module-wide string intern table.
+   *
+   * Bytes live in an arena of fixed chunks; a hash map from view to id
+   * gives O(1) interning. Cached peer structures store 4-byte Symbols
+   * instead of std::string copies, and equality filters compare ids.
+   *
+   * Peer ids and endpoints churn on long-lived nodes, so ids are
+   * reclaimed by collect(): the owners of long-lived rows (peers cache,
+   * journal) pass the ids they hold, and an id that was neither passed,
+   * interned nor found during the last two generations is freed. Freed
+   * ids are reused one generation later, and the arena is compacted once
+   * most of it is dead. Ids stay stable across a compaction; only views
+   * move, which readers see under the table lock.
+   */
+  class Interner
+  {
+  public:
+    Interner();
+
+    Interner(const Interner &) = delete;
+    Interner &operator=(const Interner &) = delete;
+
+    /** @brief Id for `s`, inserting it if needed. */
+    Symbol intern(std::string_view s);
+
+    /** @brief Id for `s`, or k_unknown_symbol when it was never interned. */
+    Symbol find(std::string_view s) const;
+
+    /**
+     * @brief String for an id (empty for unknown or freed ids).
+     *
+     * Copy it before the next collect(); use a Reader for batches.
+     */
+    std::string_view view(Symbol id) const;
+
+    /**
+     * @brief Start a new generation and free ids unused for two of them.
+     *
+     * `roots` appends every id still held by long-lived structures; it runs
+     * without the table lock. Generations advance at most once per
+     * `min_interval`, so short-lived holders (a request formatting rows)
+     * are never collected under them; calls in between return 0.
+     * @return Bytes given back to the allocator.
+     */
+    std::size_t collect(const std::function<void(std::vector<Symbol> &)> &roots,
+                        std::chrono::milliseconds min_interval);
+
+    /** @brief Ids interned since the last collection. */
+    std::size_t interned_since_collect() const;
+
+    /**
+     * @brief Batch reader holding the shared lock once for many lookups.
+     */
+    class Reader
+    {
+    public:
+      explicit Reader(const Interner &t) : t_(t), lock_(t.mu_) {}
+
+      std::string_view view(Symbol id) const noexcept
+      {
+        return id < t_.by_id_.size() ? t_.by_id_[id] : std::string_view{};
+      }
+
+    private:
+      const Interner &t_;
+      std::shared_lock<std::shared_mutex> lock_;
+    };
+
+    Reader reader() const { return Reader(*this); }
+
+    /** @brief Ids in use, the empty string included. */
+    std::size_t size() const;
+
+    /** @brief Bytes held by the arena and the index. */
+    std::size_t bytes() const;
+
+  private:
+    static constexpr std::size_t k_chunk_bytes = 16 * 1024;
+
+    std::string_view store_locked(std::string_view s);
+    void touch_locked(Symbol id) const noexcept;
+    std::size_t bytes_locked() const;
+    void compact_locked();
+
+    mutable std::shared_mutex mu_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::size_t chunk_used_ = k_chunk_bytes;
+    std::size_t arena_bytes_ = 0;
+    // Bytes of the strings still interned (the rest of the arena is dead).
+    std::size_t live_bytes_ = 0;
+    std::vector<std::string_view> by_id_;
+    std::unordered_map<std::string_view, Symbol> ids_;
+
+    // Last generation each id was used in; written under the shared lock
+    // through std::atomic_ref.
+    mutable std::vector<std::uint32_t> seen_;
+    std::uint32_t gen_ = 1;
+    std::chrono::steady_clock::time_point collected_at_{};
+    std::size_t interned_since_collect_ = 0;
+    // Freed by the last collection / reusable now.
+    std::vector<Symbol> freeing_;
+    std::vector<Symbol> free_;
+  };
+
+  /** @brief The p2p_http-wide table. */
+  Interner &interner();
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_INTERNER_HPP
@@ -0,0 +1,82 @@
+/**
+ *
+ *  @file JsonWrite.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_JSON_WRITE_HPP
+#define VIX_P2P_HTTP_DETAIL_JSON_WRITE_HPP
+
+#include <charconv>
+#include <string>
+#include <string_view>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Append-only JSON helpers for hot response bodies.
+   *
+   * Used where building a Json DOM per row would dominate the handler
+   * (one node + one string per field). Output matches Json::dump().
+   */
+  /** @brief Append `s` escaped, without surrounding quotes. */
+  inline void append_json_escaped(std::string &out, std::string_view s)
+  {
+    static constexpr char k_hex[] = "0123456789abcdef";
+
+    for (const char ch : s)
+    {
+      const auto c = static_cast<unsigned char>(ch);
+      switch (c)
+      {
+      case '"':  out.append("\\\""); break;
+      case '\\': out.append("\\\\"); break;
+      case '\b': out.append("\\b"); break;
+      case '\f': out.append("\\f"); break;
+      case '\n': out.append("\\n"); break;
+      case '\r': out.append("\\r"); break;
+      case '\t': out.append("\\t"); break;
+      default:
+        if (c < 0x20)
+        {
+          out.append("\\u00");
+          out.push_back(k_hex[c >> 4]);
+          out.push_back(k_hex[c & 0x0F]);
+        }
+        else
+        {
+          out.push_back(ch);
+        }
+      }
+    }
+  }
+
+  inline void append_json_string(std::string &out, std::string_view s)
+  {
+    out.push_back('"');
+    append_json_escaped(out, s);
+    out.push_back('"');
+  }
+
+  template <typename Int>
+  inline void append_json_int(std::string &out, Int v)
+  {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+  }
+
+  inline void append_json_bool(std::string &out, bool v)
+  {
+    out.append(v ? "true" : "false");
+  }
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_JSON_WRITE_HPP
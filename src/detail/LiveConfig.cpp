@@ -0,0 +1,230 @@
+/**
+ *
+ *  @file LiveConfig.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "LiveConfig.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    std::atomic<std::shared_ptr<const LiveConfig>> g_config{std::make_shared<const LiveConfig>()};
+
+    // Serializes writers (PATCH, file reload); readers only load the pointer.
+    std::mutex g_config_write_mu;
+    std::vector<ConfigObserver> g_observers;
+
+    constexpr int k_min_stats_every_ms = 10;
+    constexpr int k_max_stats_every_ms = 3600 * 1000;
+    constexpr std::size_t k_max_log_capacity = 1000000;
+    constexpr int k_max_cache_ttl_ms = 3600 * 1000;
+    constexpr int k_max_connect_rate = 100000;
+
+    ConfigPatchResult fail(std::string error, std::string field)
+    {
+      ConfigPatchResult r;
+      r.ok = false;
+      r.error = std::move(error);
+      r.field = std::move(field);
+      return r;
+    }
+
+    // Layers the published config is built from: registration options,
+    // then the config file, then PATCH /config fields. Writers only.
+    LiveConfig g_base;
+    J::Json g_file = J::Json::object();
+    J::Json g_overrides = J::Json::object();
+
+    void publish_locked(LiveConfig next)
+    {
+      auto snap = std::make_shared<const LiveConfig>(std::move(next));
+      g_config.store(snap);
+
+      for (const auto &fn : g_observers)
+        fn(*snap);
+    }
+
+    // Validate `fields` and write them into `cfg`; `cfg` is garbage on error.
+    ConfigPatchResult apply_fields(const J::Json &fields, LiveConfig &cfg)
+    {
+      if (!fields.is_object())
+        return fail("invalid_config", "");
+
+      for (auto it = fields.begin(); it != fields.end(); ++it)
+      {
+        const std::string &key = it.key();
+        const J::Json &v = it.value();
+
+        if (key == "stats_every_ms")
+        {
+          if (!v.is_number_integer())
+            return fail("invalid_type", key);
+          const long long ms = v.get<long long>();
+          if (ms < k_min_stats_every_ms || ms > k_max_stats_every_ms)
+            return fail("out_of_range", key);
+          cfg.stats_every_ms = static_cast<int>(ms);
+        }
+        else if (key == "log_capacity")
+        {
+          if (!v.is_number_integer())
+            return fail("invalid_type", key);
+          const long long n = v.get<long long>();
+          if (n < 1 || n > static_cast<long long>(k_max_log_capacity))
+            return fail("out_of_range", key);
+          cfg.log_capacity = static_cast<std::size_t>(n);
+        }
+        else if (key == "peers_cache_ttl_ms")
+        {
+          if (!v.is_number_integer())
+            return fail("invalid_type", key);
+          const long long ms = v.get<long long>();
+          if (ms < 0 || ms > k_max_cache_ttl_ms)
+            return fail("out_of_range", key);
+          cfg.peers_cache_ttl_ms = static_cast<int>(ms);
+        }
+        else if (key == "connect_rate_per_sec")
+        {
+          if (!v.is_number_integer())
+            return fail("invalid_type", key);
+          const long long n = v.get<long long>();
+          if (n < 0 || n > k_max_connect_rate)
+            return fail("out_of_range", key);
+          cfg.connect_rate_per_sec = static_cast<int>(n);
+        }
+        else if (key == "enable_ping" || key == "enable_status" || key == "enable_peers" ||
+                 key == "enable_logs" || key == "enable_live_logs")
+        {
+          if (!v.is_boolean())
+            return fail("invalid_type", key);
+          const bool on = v.get<bool>();
+          if (key == "enable_ping")
+            cfg.enable_ping = on;
+          else if (key == "enable_status")
+            cfg.enable_status = on;
+          else if (key == "enable_peers")
+            cfg.enable_peers = on;
+          else if (key == "enable_logs")
+            cfg.enable_logs = on;
+          else
+            cfg.enable_live_logs = on;
+        }
+        else
+        {
+          return fail("unknown_field", key);
+        }
+      }
+
+      ConfigPatchResult r;
+      r.ok = true;
+      return r;
+    }
+
+    // Build base + file + overrides from scratch and publish it whole.
+    ConfigPatchResult rebuild_locked(const J::Json &file, const J::Json &overrides)
+    {
+      LiveConfig next = g_base;
+      if (auto r = apply_fields(file, next); !r.ok)
+        return r;
+      if (auto r = apply_fields(overrides, next); !r.ok)
+        return r;
+
+      publish_locked(std::move(next));
+
+      ConfigPatchResult r;
+      r.ok = true;
+      return r;
+    }
+  }
+
+  std::shared_ptr<const LiveConfig> live_config()
+  {
+    return g_config.load();
+  }
+
+  void init_live_config(const P2PHttpOptions &opt)
+  {
+    LiveConfig cfg;
+    cfg.stats_every_ms = (opt.stats_every_ms <= 0 ? 1000 : opt.stats_every_ms);
+    cfg.log_capacity = (opt.log_capacity == 0 ? 1 : opt.log_capacity);
+    cfg.peers_cache_ttl_ms = std::max(0, opt.peers_cache_ttl_ms);
+    cfg.connect_rate_per_sec = std::max(0, opt.connect_rate_per_sec);
+    cfg.enable_ping = opt.enable_ping;
+    cfg.enable_status = opt.enable_status;
+    cfg.enable_peers = opt.enable_peers;
+    cfg.enable_logs = opt.enable_logs;
+    cfg.enable_live_logs = opt.enable_live_logs;
+
+    std::lock_guard<std::mutex> lk(g_config_write_mu);
+    g_base = cfg;
+    g_file = J::Json::object();
+    g_overrides = J::Json::object();
+    publish_locked(std::move(cfg));
+  }
+
+  ConfigPatchResult apply_config_patch(const J::Json &patch)
+  {
+    if (!patch.is_object())
+      return fail("invalid_config", "");
+
+    std::lock_guard<std::mutex> lk(g_config_write_mu);
+    J::Json overrides = g_overrides;
+    for (auto it = patch.begin(); it != patch.end(); ++it)
+      overrides[it.key()] = it.value();
+
+    auto r = rebuild_locked(g_file, overrides);
+    if (r.ok)
+      g_overrides = std::move(overrides);
+    return r;
+  }
+
+  ConfigPatchResult apply_config_file(const J::Json &doc)
+  {
+    if (!doc.is_object())
+      return fail("invalid_config", "");
+
+    std::lock_guard<std::mutex> lk(g_config_write_mu);
+    auto r = rebuild_locked(doc, g_overrides);
+    if (r.ok)
+      g_file = doc;
+    return r;
+  }
+
+  void add_config_observer(ConfigObserver fn)
+  {
+    std::lock_guard<std::mutex> lk(g_config_write_mu);
+    g_observers.push_back(std::move(fn));
+  }
+
+  J::Json live_config_json(const LiveConfig &cfg)
+  {
+    return J::Json{
+        {"stats_every_ms", cfg.stats_every_ms},
+        {"log_capacity", cfg.log_capacity},
+        {"peers_cache_ttl_ms", cfg.peers_cache_ttl_ms},
+        {"connect_rate_per_sec", cfg.connect_rate_per_sec},
+        {"enable_ping", cfg.enable_ping},
+        {"enable_status", cfg.enable_status},
+        {"enable_peers", cfg.enable_peers},
+        {"enable_logs", cfg.enable_logs},
+        {"enable_live_logs", cfg.enable_live_logs},
+    };
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,91 @@
+/**
+ *
+ *  @file LiveConfig.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_LIVE_CONFIG_HPP
+#define VIX_P2P_HTTP_DETAIL_LIVE_CONFIG_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <vix/json/json.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Subset of P2PHttpOptions that can change without a restart.
+   *
+   * Published as an immutable snapshot; handlers load the current pointer
+   * once per request and never observe a half-applied update.
+   */
+  struct LiveConfig
+  {
+    int stats_every_ms = 1000;
+    std::size_t log_capacity = 800;
+
+    int peers_cache_ttl_ms = 0;
+    int connect_rate_per_sec = 0;
+
+    bool enable_ping = true;
+    bool enable_status = true;
+    bool enable_peers = true;
+    bool enable_logs = true;
+    bool enable_live_logs = true;
+  };
+
+  /** @brief Outcome of a config patch. */
+  struct ConfigPatchResult
+  {
+    bool ok = false;
+    std::string error;
+    std::string field;
+  };
+
+  /** @brief Called after a new config has been published. */
+  using ConfigObserver = std::function<void(const LiveConfig &)>;
+
+  /** @brief Current config snapshot (never null). */
+  std::shared_ptr<const LiveConfig> live_config();
+
+  /** @brief Seed the live config from registration options. */
+  void init_live_config(const P2PHttpOptions &opt);
+
+  /**
+   * @brief Validate and apply a JSON patch of tunable fields (PATCH /config).
+   *
+   * The fields are kept as explicit overrides on top of the registration
+   * options and the config file, and outlive file reloads. Every field is
+   * checked before anything is published; on error the previous config
+   * stays in place.
+   */
+  ConfigPatchResult apply_config_patch(const vix::json::Json &patch);
+
+  /**
+   * @brief Replace the config file layer with `doc` (config_file reload).
+   *
+   * The config is rebuilt from the registration options, then `doc`, then
+   * the PATCH overrides, and swapped in whole: a field removed from the
+   * file goes back to its registration value. On error nothing changes.
+   */
+  ConfigPatchResult apply_config_file(const vix::json::Json &doc);
+
+  /** @brief Register a callback run after each successful update. */
+  void add_config_observer(ConfigObserver fn);
+
+  /** @brief Serialize a config snapshot. */
+  vix::json::Json live_config_json(const LiveConfig &cfg);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_LIVE_CONFIG_HPP
@@ -0,0 +1,645 @@
+/**
+ *
+ *  @file LocalHttp.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "LocalHttp.hpp"
+#include "ThreadTuning.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VIX_P2P_HTTP_HAS_UNIX_SOCKETS 1
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    constexpr std::size_t k_max_header_bytes = 16 * 1024;
+    constexpr std::size_t k_max_body_bytes = 1024 * 1024;
+    constexpr int k_idle_timeout_sec = 5;
+
+    bool iequals(std::string_view a, std::string_view b) noexcept
+    {
+      return a.size() == b.size() &&
+             std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+                        { return std::tolower((unsigned char)x) == std::tolower((unsigned char)y); });
+    }
+
+    std::string_view trim(std::string_view s) noexcept
+    {
+      while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+      while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+        s.remove_suffix(1);
+      return s;
+    }
+
+    int hex_value(char c) noexcept
+    {
+      if (c >= '0' && c <= '9')
+        return c - '0';
+      if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+      return -1;
+    }
+
+    std::string url_decode(std::string_view s)
+    {
+      std::string out;
+      out.reserve(s.size());
+      for (std::size_t i = 0; i < s.size(); ++i)
+      {
+        if (s[i] == '+')
+          out.push_back(' ');
+        else if (s[i] == '%' && i + 2 < s.size() && hex_value(s[i + 1]) >= 0 && hex_value(s[i + 2]) >= 0)
+        {
+          out.push_back(char(hex_value(s[i + 1]) * 16 + hex_value(s[i + 2])));
+          i += 2;
+        }
+        else
+          out.push_back(s[i]);
+      }
+      return out;
+    }
+
+    const char *reason(int status) noexcept
+    {
+      switch (status)
+      {
+      case 200: return "OK";
+      case 400: return "Bad Request";
+      case 401: return "Unauthorized";
+      case 404: return "Not Found";
+      case 413: return "Payload Too Large";
+      case 429: return "Too Many Requests";
+      case 431: return "Request Header Fields Too Large";
+      case 503: return "Service Unavailable";
+      default:  return status < 400 ? "OK" : "Error";
+      }
+    }
+  }
+
+  std::string LocalRequest::query_value(std::string_view name, std::string_view fallback) const
+  {
+    std::string_view q(query);
+    while (!q.empty())
+    {
+      const auto amp = q.find('&');
+      const std::string_view pair = q.substr(0, amp);
+      q = (amp == std::string_view::npos) ? std::string_view{} : q.substr(amp + 1);
+
+      const auto eq = pair.find('=');
+      if (url_decode(pair.substr(0, eq)) == name)
+        return eq == std::string_view::npos ? std::string{} : url_decode(pair.substr(eq + 1));
+    }
+    return std::string(fallback);
+  }
+
+  LocalHttpServer::~LocalHttpServer()
+  {
+    stop();
+  }
+
+  void LocalHttpServer::route(std::string method, std::string path, LocalHandler h)
+  {
+    routes_[method + " " + path] = std::move(h);
+  }
+
+  void LocalHttpServer::clear_routes()
+  {
+    routes_.clear();
+  }
+
+  void LocalHttpServer::dispatch(const LocalRequest &req, LocalResponse &res) const
+  {
+    auto it = routes_.find(req.method + " " + req.path);
+    if (it == routes_.end())
+    {
+      res.status = 404;
+      res.body = R"({"error":"not_found","ok":false})";
+      return;
+    }
+
+    try
+    {
+      it->second(req, res);
+    }
+    catch (...)
+    {
+      res = LocalResponse{};
+      res.status = 500;
+      res.body = R"({"error":"internal_error","ok":false})";
+    }
+  }
+
+#if defined(VIX_P2P_HTTP_HAS_UNIX_SOCKETS)
+
+  namespace
+  {
+    bool write_all(int fd, const std::string &data)
+    {
+#if defined(MSG_NOSIGNAL)
+      constexpr int flags = MSG_NOSIGNAL;
+#else
+      constexpr int flags = 0;
+#endif
+      std::size_t off = 0;
+      while (off < data.size())
+      {
+        const ssize_t n = ::send(fd, data.data() + off, data.size() - off, flags);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n <= 0)
+          return false;
+        off += static_cast<std::size_t>(n);
+      }
+      return true;
+    }
+
+    // Returns false on EOF, error or idle timeout.
+    bool read_more(int fd, std::string &buf)
+    {
+      char chunk[4096];
+      for (;;)
+      {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n <= 0)
+          return false;
+        buf.append(chunk, static_cast<std::size_t>(n));
+        return true;
+      }
+    }
+
+    // Runs a streamed body as chunks, then the last chunk. False when the
+    // client went away or the producer threw (the reply is then cut short).
+    bool send_stream(int fd, const std::function<void(const LocalChunkWriter &)> &stream)
+    {
+      static constexpr char k_hex[] = "0123456789abcdef";
+
+      bool alive = true;
+      std::string frame;
+      const LocalChunkWriter write = [&](std::string_view data)
+      {
+        if (!alive || data.empty())
+          return alive;
+
+        char size[16];
+        std::size_t n = 0;
+        for (std::size_t v = data.size(); v != 0; v >>= 4)
+          size[n++] = k_hex[v & 0x0F];
+
+        frame.clear();
+        while (n > 0)
+          frame.push_back(size[--n]);
+        frame.append("\r\n").append(data).append("\r\n");
+        alive = write_all(fd, frame);
+        return alive;
+      };
+
+      try
+      {
+        stream(write);
+      }
+      catch (...)
+      {
+        return false;
+      }
+      return alive && write_all(fd, "0\r\n\r\n");
+    }
+
+    void send_error(int fd, int status, const char *error)
+    {
+      const std::string body = std::string(R"({"error":")") + error + R"(","ok":false})";
+      std::string out = "HTTP/1.1 " + std::to_string(status) + " " + reason(status) +
+                        "\r\nContent-Type: application/json\r\nContent-Length: " +
+                        std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+      (void)write_all(fd, out);
+    }
+  }
+
+  bool LocalHttpServer::start(const std::string &socket_path, int threads, std::string *error)
+  {
+    std::lock_guard<std::mutex> lk(life_mu_);
+    if (running_.load())
+      return true;
+
+    auto fail = [error](std::string msg)
+    {
+      if (error)
+        *error = std::move(msg);
+      return false;
+    };
+
+    sockaddr_un addr{};
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path))
+      return fail("invalid socket path");
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+      return fail(std::string("socket: ") + std::strerror(errno));
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    // A leftover socket file from a previous run would make bind() fail.
+    struct stat st{};
+    if (::lstat(socket_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+      ::unlink(socket_path.c_str());
+
+    // Owner-only before anyone can connect: connect() is refused until
+    // listen(), so the mode is fixed in between. umask() would be
+    // process-wide and race with files other threads create.
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+      const std::string msg = std::string("bind: ") + std::strerror(errno);
+      ::close(fd);
+      return fail(msg);
+    }
+    if (::chmod(socket_path.c_str(), 0600) != 0 || ::listen(fd, 64) != 0)
+    {
+      const std::string msg = std::string("chmod/listen: ") + std::strerror(errno);
+      ::close(fd);
+      ::unlink(socket_path.c_str());
+      return fail(msg);
+    }
+
+    int wake[2] = {-1, -1};
+    if (::pipe(wake) != 0)
+    {
+      const std::string msg = std::string("pipe: ") + std::strerror(errno);
+      ::close(fd);
+      ::unlink(socket_path.c_str());
+      return fail(msg);
+    }
+    for (int w : wake)
+    {
+      ::fcntl(w, F_SETFD, FD_CLOEXEC);
+      ::fcntl(w, F_SETFL, ::fcntl(w, F_GETFL) | O_NONBLOCK);
+    }
+
+    socket_path_ = socket_path;
+    listen_fd_ = fd;
+    wake_fds_[0] = wake[0];
+    wake_fds_[1] = wake[1];
+    stop_.store(false);
+    running_.store(true);
+
+    const int n = std::clamp(threads, 1, 64);
+    for (int i = 0; i < n; ++i)
+      workers_.emplace_back([this, i]()
+                            { worker_loop(i); });
+
+    poller_ = std::thread([this]()
+                          { poll_loop(); });
+    return true;
+  }
+
+  void LocalHttpServer::stop()
+  {
+    std::lock_guard<std::mutex> lk(life_mu_);
+    if (!running_.load())
+      return;
+
+    stop_.store(true);
+    {
+      std::lock_guard<std::mutex> q(q_mu_);
+      // Wake workers blocked reading a request or writing a reply.
+      for (int fd : active_)
+        ::shutdown(fd, SHUT_RDWR);
+    }
+    q_cv_.notify_all();
+    (void)::write(wake_fds_[1], "x", 1);
+
+    if (poller_.joinable())
+      poller_.join();
+    for (auto &t : workers_)
+    {
+      if (t.joinable())
+        t.join();
+    }
+    workers_.clear();
+
+    for (const Conn &c : queue_)
+      ::close(c.fd);
+    queue_.clear();
+    for (const Conn &c : parked_)
+      ::close(c.fd);
+    parked_.clear();
+
+    ::close(wake_fds_[0]);
+    ::close(wake_fds_[1]);
+    wake_fds_[0] = wake_fds_[1] = -1;
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(socket_path_.c_str());
+    running_.store(false);
+  }
+
+  // Owns every connection that is not being served: new ones and idle
+  // keep-alive ones. A connection goes to the workers once it is readable.
+  void LocalHttpServer::poll_loop()
+  {
+    const ThreadPolicyScope policy("admin_socket/poll");
+
+    const auto idle_timeout = std::chrono::seconds(k_idle_timeout_sec);
+    std::vector<Conn> idle;
+    std::vector<pollfd> fds;
+
+    while (!stop_.load())
+    {
+      {
+        std::lock_guard<std::mutex> q(q_mu_);
+        for (Conn &c : parked_)
+          idle.push_back(std::move(c));
+        parked_.clear();
+      }
+
+      fds.clear();
+      fds.push_back(pollfd{listen_fd_, POLLIN, 0});
+      fds.push_back(pollfd{wake_fds_[0], POLLIN, 0});
+      for (const Conn &c : idle)
+        fds.push_back(pollfd{c.fd, POLLIN, 0});
+
+      if (::poll(fds.data(), fds.size(), 200) < 0 && errno != EINTR)
+        continue;
+
+      if (fds[1].revents & POLLIN)
+      {
+        char drain[64];
+        while (::read(wake_fds_[0], drain, sizeof(drain)) > 0)
+        {
+        }
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      std::vector<Conn> ready;
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < idle.size(); ++i)
+      {
+        const short ev = fds[i + 2].revents;
+        if (ev & (POLLIN | POLLHUP | POLLERR))
+          ready.push_back(std::move(idle[i]));
+        else if (now - idle[i].idle_since >= idle_timeout)
+          ::close(idle[i].fd);
+        else
+          idle[kept++] = std::move(idle[i]);
+      }
+      idle.resize(kept);
+
+      if (fds[0].revents & POLLIN)
+      {
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd >= 0)
+        {
+          // Bounds a request that arrives in pieces and a stalled reader.
+          timeval tv{};
+          tv.tv_sec = k_idle_timeout_sec;
+          ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+          ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#if defined(SO_NOSIGPIPE)
+          const int one = 1;
+          ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+          idle.push_back(Conn{fd, {}, now});
+        }
+      }
+
+      if (!ready.empty())
+      {
+        {
+          std::lock_guard<std::mutex> q(q_mu_);
+          for (Conn &c : ready)
+            queue_.push_back(std::move(c));
+        }
+        if (ready.size() == 1)
+          q_cv_.notify_one();
+        else
+          q_cv_.notify_all();
+      }
+    }
+
+    for (const Conn &c : idle)
+      ::close(c.fd);
+  }
+
+  // One request per turn: the connection goes back to the poll thread
+  // after the reply instead of keeping the worker.
+  void LocalHttpServer::worker_loop(int index)
+  {
+    const ThreadPolicyScope policy("admin_socket/" + std::to_string(index));
+
+    for (;;)
+    {
+      Conn c;
+      {
+        std::unique_lock<std::mutex> q(q_mu_);
+        q_cv_.wait(q, [this]()
+                   { return stop_.load() || !queue_.empty(); });
+        if (stop_.load())
+          return;
+
+        c = std::move(queue_.front());
+        queue_.pop_front();
+        active_.push_back(c.fd);
+      }
+
+      const bool keep = serve_one(c);
+
+      {
+        std::lock_guard<std::mutex> q(q_mu_);
+        active_.erase(std::find(active_.begin(), active_.end(), c.fd));
+      }
+
+      if (keep && !stop_.load())
+        release(std::move(c));
+      else
+        ::close(c.fd);
+    }
+  }
+
+  void LocalHttpServer::release(Conn c)
+  {
+    c.idle_since = std::chrono::steady_clock::now();
+
+    // A pipelined request is already buffered: no need to wait for POLLIN.
+    if (c.buf.find("\r\n\r\n") != std::string::npos)
+    {
+      {
+        std::lock_guard<std::mutex> q(q_mu_);
+        queue_.push_back(std::move(c));
+      }
+      q_cv_.notify_one();
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> q(q_mu_);
+      parked_.push_back(std::move(c));
+    }
+    (void)::write(wake_fds_[1], "x", 1);
+  }
+
+  // Reads and answers one request. Returns whether to keep the connection.
+  bool LocalHttpServer::serve_one(Conn &c)
+  {
+    const int fd = c.fd;
+    std::string &buf = c.buf;
+
+    // Headers.
+    std::size_t head_end;
+    while ((head_end = buf.find("\r\n\r\n")) == std::string::npos)
+    {
+      if (buf.size() > k_max_header_bytes)
+      {
+        send_error(fd, 431, "headers_too_large");
+        return false;
+      }
+      if (!read_more(fd, buf))
+        return false;
+    }
+
+    const std::string_view head(buf.data(), head_end);
+    const auto line_end = head.find("\r\n");
+    const std::string_view line = head.substr(0, line_end);
+
+    const auto sp1 = line.find(' ');
+    const auto sp2 = (sp1 == std::string_view::npos) ? sp1 : line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos)
+    {
+      send_error(fd, 400, "bad_request");
+      return false;
+    }
+
+    LocalRequest req;
+    req.method = std::string(line.substr(0, sp1));
+    const std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    const std::string_view version = line.substr(sp2 + 1);
+
+    const auto qpos = target.find('?');
+    req.path = std::string(target.substr(0, qpos));
+    if (qpos != std::string_view::npos)
+      req.query = std::string(target.substr(qpos + 1));
+
+    std::size_t content_length = 0;
+    bool keep_alive = (version == "HTTP/1.1");
+
+    std::string_view rest = (line_end == std::string_view::npos) ? std::string_view{} : head.substr(line_end + 2);
+    while (!rest.empty())
+    {
+      const auto eol = rest.find("\r\n");
+      const std::string_view h = rest.substr(0, eol);
+      rest = (eol == std::string_view::npos) ? std::string_view{} : rest.substr(eol + 2);
+
+      const auto colon = h.find(':');
+      if (colon == std::string_view::npos)
+        continue;
+      const std::string_view name = trim(h.substr(0, colon));
+      const std::string_view value = trim(h.substr(colon + 1));
+
+      if (iequals(name, "content-length"))
+      {
+        content_length = 0;
+        for (char c : value)
+        {
+          if (c < '0' || c > '9' || content_length > k_max_body_bytes)
+            break;
+          content_length = content_length * 10 + std::size_t(c - '0');
+        }
+      }
+      else if (iequals(name, "connection"))
+      {
+        if (iequals(value, "close"))
+          keep_alive = false;
+        else if (iequals(value, "keep-alive"))
+          keep_alive = true;
+      }
+      else if (iequals(name, "transfer-encoding"))
+      {
+        send_error(fd, 400, "chunked_not_supported");
+        return false;
+      }
+    }
+
+    if (content_length > k_max_body_bytes)
+    {
+      send_error(fd, 413, "body_too_large");
+      return false;
+    }
+
+    // Body.
+    const std::size_t body_at = head_end + 4;
+    while (buf.size() - body_at < content_length)
+    {
+      if (!read_more(fd, buf))
+        return false;
+    }
+    req.body.assign(buf, body_at, content_length);
+    buf.erase(0, body_at + content_length);
+
+    LocalResponse res;
+    dispatch(req, res);
+
+    std::string out;
+    out.reserve(128 + res.body.size());
+    out.append("HTTP/1.1 ").append(std::to_string(res.status)).push_back(' ');
+    out.append(reason(res.status));
+    out.append("\r\nContent-Type: ").append(res.type);
+    for (const auto &[name, value] : res.headers)
+      out.append("\r\n").append(name).append(": ").append(value);
+
+    if (res.stream)
+    {
+      out.append(keep_alive ? "\r\nTransfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n"
+                            : "\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n");
+      return write_all(fd, out) && send_stream(fd, res.stream) && keep_alive;
+    }
+
+    out.append("\r\nContent-Length: ").append(std::to_string(res.body.size()));
+    out.append(keep_alive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    out.append(res.body);
+
+    return write_all(fd, out) && keep_alive;
+  }
+
+#else
+
+  bool LocalHttpServer::start(const std::string &, int, std::string *error)
+  {
+    if (error)
+      *error = "unix domain sockets are not supported on this platform";
+    return false;
+  }
+
+  void LocalHttpServer::stop() {}
+  void LocalHttpServer::poll_loop() {}
+  void LocalHttpServer::worker_loop(int) {}
+  bool LocalHttpServer::serve_one(Conn &) { return false; }
+  void LocalHttpServer::release(Conn) {}
+
+#endif
+} // namespace vix::p2p_http::detail
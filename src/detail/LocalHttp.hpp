@@ -0,0 +1,142 @@
+/**
+ *
+ *  @file LocalHttp.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_LOCAL_HTTP_HPP
+#define VIX_P2P_HTTP_DETAIL_LOCAL_HTTP_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vix::p2p_http::detail
+{
+  /** @brief Parsed request on the local admin listener. */
+  struct LocalRequest
+  {
+    std::string method;
+    std::string path;
+    std::string query;
+    std::string body;
+
+    /** @brief Percent-decoded query parameter, or `fallback`. */
+    std::string query_value(std::string_view name, std::string_view fallback = "") const;
+  };
+
+  /** @brief Writes one block of a streamed body; false once the client is gone. */
+  using LocalChunkWriter = std::function<bool(std::string_view)>;
+
+  struct LocalResponse
+  {
+    int status = 200;
+    std::string type = "application/json";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    /**
+     * @brief Streamed body, used instead of `body` when set.
+     *
+     * Called on the worker after the head is sent; each block goes out as
+     * one chunk (Transfer-Encoding: chunked), so the reply never has to
+     * fit in memory.
+     */
+    std::function<void(const LocalChunkWriter &)> stream;
+  };
+
+  using LocalHandler = std::function<void(const LocalRequest &, LocalResponse &)>;
+
+  /**
+   * @brief Minimal HTTP/1.1 server on a Unix domain socket.
+   *
+   * Serves exact-path routes to local tooling, off the public port and its
+   * accept queue. One poll thread watches the listener and every idle
+   * keep-alive connection, and hands a connection to the small fixed pool
+   * only once a request arrives on it; after the reply the connection goes
+   * back to the poll thread. Idle clients therefore hold no worker.
+   * Connections idle for 5 s are closed. Requests need a Content-Length
+   * body (no chunked uploads); replies may be streamed. POSIX only:
+   * start() fails elsewhere.
+   */
+  class LocalHttpServer
+  {
+  public:
+    LocalHttpServer() = default;
+    ~LocalHttpServer();
+
+    LocalHttpServer(const LocalHttpServer &) = delete;
+    LocalHttpServer &operator=(const LocalHttpServer &) = delete;
+
+    /** @brief Add a route. Call before start(). */
+    void route(std::string method, std::string path, LocalHandler h);
+
+    /** @brief Drop every route. Call while stopped. */
+    void clear_routes();
+
+    /**
+     * @brief Bind `socket_path` (mode 0600, replacing a stale socket) and serve.
+     * @return false with `error` set when the socket cannot be bound.
+     */
+    bool start(const std::string &socket_path, int threads, std::string *error = nullptr);
+
+    /** @brief Stop serving, join threads and unlink the socket. */
+    void stop();
+
+    bool running() const noexcept { return running_.load(); }
+
+  private:
+    struct Conn
+    {
+      int fd = -1;
+      // Bytes read past the last request (pipelining).
+      std::string buf;
+      std::chrono::steady_clock::time_point idle_since{};
+    };
+
+    void poll_loop();
+    void worker_loop(int index);
+    bool serve_one(Conn &c);
+    void release(Conn c);
+    void dispatch(const LocalRequest &req, LocalResponse &res) const;
+
+    std::unordered_map<std::string, LocalHandler> routes_;
+
+    std::mutex life_mu_;
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+
+    std::thread poller_;
+    std::vector<std::thread> workers_;
+    // Self-pipe: wakes the poll thread when a worker parks a connection.
+    int wake_fds_[2] = {-1, -1};
+
+    std::mutex q_mu_;
+    std::condition_variable q_cv_;
+    // Connections with a request waiting, for the workers.
+    std::deque<Conn> queue_;
+    // Connections handed back by workers, for the poll thread.
+    std::vector<Conn> parked_;
+    std::vector<int> active_;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_LOCAL_HTTP_HPP
@@ -0,0 +1,198 @@
+/**
+ *
+ *  @file LogClock.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "LogClock.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VIX_P2P_HTTP_HAS_TSC 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    std::uint64_t unix_now_ns() noexcept
+    {
+      return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    // Precise monotonic reference for the TSC calibration.
+    std::uint64_t mono_ns() noexcept
+    {
+#if defined(CLOCK_MONOTONIC_RAW)
+      timespec ts{};
+      ::clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+      return (std::uint64_t)ts.tv_sec * 1000000000ull + (std::uint64_t)ts.tv_nsec;
+#else
+      return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+#endif
+    }
+
+    // Tick-resolution clock read from the vDSO without a syscall.
+    std::uint64_t coarse_ns() noexcept
+    {
+#if defined(CLOCK_MONOTONIC_COARSE)
+      timespec ts{};
+      ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+      return (std::uint64_t)ts.tv_sec * 1000000000ull + (std::uint64_t)ts.tv_nsec;
+#else
+      return mono_ns();
+#endif
+    }
+
+#if defined(VIX_P2P_HTTP_HAS_TSC)
+    // Constant rate across P-states and C-states: CPUID 0x80000007 EDX[8].
+    bool invariant_tsc() noexcept
+    {
+      unsigned a = 0, b = 0, c = 0, d = 0;
+      if (!__get_cpuid(0x80000000u, &a, &b, &c, &d) || a < 0x80000007u)
+        return false;
+      __get_cpuid(0x80000007u, &a, &b, &c, &d);
+      return (d & (1u << 8)) != 0;
+    }
+#endif
+
+    struct Anchor
+    {
+      bool tsc = false;
+      std::uint64_t stamp = 0;
+      std::uint64_t unix_ns = 0;
+      std::uint64_t mono_ns = 0;
+    };
+
+    // TSC ns per tick. A 2 ms first estimate, refined against
+    // CLOCK_MONOTONIC_RAW as rendering goes on (see refine()).
+    std::atomic<double> g_ns_per_tick{1.0};
+    std::atomic<std::uint64_t> g_refined_at{0};
+
+    Anchor make_anchor() noexcept
+    {
+      Anchor a;
+#if defined(VIX_P2P_HTTP_HAS_TSC)
+      if (invariant_tsc())
+      {
+        const std::uint64_t t0 = mono_ns();
+        const std::uint64_t c0 = __rdtsc();
+        std::uint64_t t1 = t0;
+        while (t1 - t0 < 2000000)
+          t1 = mono_ns();
+        const std::uint64_t c1 = __rdtsc();
+        if (c1 > c0)
+        {
+          g_ns_per_tick.store((double)(t1 - t0) / (double)(c1 - c0));
+          a.tsc = true;
+          a.stamp = c1;
+          a.mono_ns = t1;
+          a.unix_ns = unix_now_ns();
+          return a;
+        }
+      }
+#endif
+      a.stamp = coarse_ns();
+      a.unix_ns = unix_now_ns();
+      return a;
+    }
+
+    const Anchor &anchor() noexcept
+    {
+      static const Anchor a = make_anchor();
+      return a;
+    }
+
+    // Longer baselines give a better rate; redo it at most once a second.
+    void refine(const Anchor &a) noexcept
+    {
+      const std::uint64_t now = mono_ns();
+      if (now - g_refined_at.load(std::memory_order_relaxed) < 1000000000ull || now - a.mono_ns < 1000000000ull)
+        return;
+#if defined(VIX_P2P_HTTP_HAS_TSC)
+      const std::uint64_t ticks = __rdtsc() - a.stamp;
+      if (ticks > 0)
+        g_ns_per_tick.store((double)(now - a.mono_ns) / (double)ticks, std::memory_order_relaxed);
+#endif
+      g_refined_at.store(now, std::memory_order_relaxed);
+    }
+  }
+
+  std::uint64_t log_stamp() noexcept
+  {
+#if defined(VIX_P2P_HTTP_HAS_TSC)
+    if (anchor().tsc)
+      return __rdtsc();
+#else
+    (void)anchor();
+#endif
+    return coarse_ns();
+  }
+
+  void init_log_clock() noexcept
+  {
+    (void)anchor();
+  }
+
+  std::uint64_t log_stamp_unix_ns(std::uint64_t stamp) noexcept
+  {
+    const Anchor &a = anchor();
+    const auto diff = (std::int64_t)(stamp - a.stamp);
+    if (!a.tsc)
+      return a.unix_ns + (std::uint64_t)diff;
+
+    refine(a);
+    const double ns = (double)diff * g_ns_per_tick.load(std::memory_order_relaxed);
+    return a.unix_ns + (std::uint64_t)(std::int64_t)ns;
+  }
+
+  const char *log_clock_source() noexcept
+  {
+    return anchor().tsc ? "tsc" : "monotonic_coarse";
+  }
+
+  std::string_view LogTimeFormatter::format(std::uint64_t stamp) noexcept
+  {
+    const std::uint64_t ns = log_stamp_unix_ns(stamp);
+    const auto sec = (std::int64_t)(ns / 1000000000ull);
+    if (sec != sec_)
+    {
+      const std::time_t t = (std::time_t)sec;
+      std::tm tm{};
+#if defined(_WIN32)
+      ::gmtime_s(&tm, &t);
+#else
+      ::gmtime_r(&t, &tm);
+#endif
+      std::strftime(buf_, sizeof(buf_), "%Y-%m-%dT%H:%M:%S", &tm);
+      buf_[19] = '.';
+      buf_[26] = 'Z';
+      sec_ = sec;
+    }
+
+    auto us = (unsigned)((ns % 1000000000ull) / 1000);
+    for (int i = 25; i >= 20; --i)
+    {
+      buf_[i] = (char)('0' + us % 10);
+      us /= 10;
+    }
+    return std::string_view(buf_, k_len);
+  }
+} // namespace vix::p2p_http::detail
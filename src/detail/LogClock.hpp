@@ -0,0 +1,66 @@
+/**
+ *
+ *  @file LogClock.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_LOG_CLOCK_HPP
+#define VIX_P2P_HTTP_DETAIL_LOG_CLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Raw timestamp for a log line, a few nanoseconds to take.
+   *
+   * The invariant TSC on x86-64, else CLOCK_MONOTONIC_COARSE. Either is
+   * anchored to CLOCK_REALTIME once, by init_log_clock() or else on first
+   * use; log_stamp_unix_ns() turns a stamp into wall time when it is
+   * rendered.
+   */
+  std::uint64_t log_stamp() noexcept;
+
+  /**
+   * @brief Anchor the clock now (the TSC calibration spins for 2 ms).
+   *
+   * Called at registration, so no log line pays for it.
+   */
+  void init_log_clock() noexcept;
+
+  /** @brief Nanoseconds since the epoch for a log_stamp() value. */
+  std::uint64_t log_stamp_unix_ns(std::uint64_t stamp) noexcept;
+
+  /** @brief "tsc" or "monotonic_coarse". */
+  const char *log_clock_source() noexcept;
+
+  /**
+   * @brief Renders log_stamp() values as "2026-10-19T12:34:56.123456Z".
+   *
+   * Keeps the date part of the last second formatted, so a run of lines
+   * costs one gmtime() per second of log rather than per line.
+   */
+  class LogTimeFormatter
+  {
+  public:
+    static constexpr std::size_t k_len = 27;
+
+    /** @brief Valid until the next call. */
+    std::string_view format(std::uint64_t stamp) noexcept;
+
+  private:
+    std::int64_t sec_ = -1;
+    char buf_[k_len + 1] = {};
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_LOG_CLOCK_HPP
@@ -0,0 +1,330 @@
+/**
+ *
+ *  @file LogFileWriter.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "LogFileWriter.hpp"
+#include "ThreadTuning.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VIX_P2P_HTTP_HAS_LOG_FILES 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vix::p2p_http::detail
+{
+  LogFileWriter::~LogFileWriter()
+  {
+    stop();
+  }
+
+  bool LogFileWriter::start(LogFileConfig cfg, std::string &error)
+  {
+    stop();
+
+    cfg_ = std::move(cfg);
+    if (cfg_.keep < 0)
+      cfg_.keep = 0;
+    if (cfg_.flush_every_ms <= 0)
+      cfg_.flush_every_ms = 200;
+
+    io_ = make_persist_io(cfg_.io, cfg_.io_slots, cfg_.batch_bytes, io_note_);
+    backend_ = io_->name();
+    slot_ = 0;
+
+    if (!open_file(error))
+    {
+      io_.reset();
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = false;
+      pending_.reserve(cfg_.batch_bytes);
+    }
+    writing_.reserve(cfg_.batch_bytes);
+    last_sync_ = std::chrono::steady_clock::now();
+
+    running_.store(true);
+    thread_ = std::thread([this]()
+                          { run(); });
+    return true;
+  }
+
+  void LogFileWriter::stop()
+  {
+    if (!thread_.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    running_.store(false);
+    io_.reset();
+  }
+
+  void LogFileWriter::append(std::string_view line)
+  {
+    if (!running_.load(std::memory_order_relaxed))
+      return;
+
+    const std::uint64_t stamp = log_stamp();
+
+    bool wake = false;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (pending_.size() + LogTimeFormatter::k_len + line.size() + 2 > cfg_.max_pending_bytes)
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      const bool below = pending_.size() < cfg_.batch_bytes;
+      pending_.append(fmt_.format(stamp));
+      pending_.push_back(' ');
+      pending_.append(line);
+      pending_.push_back('\n');
+      wake = below && pending_.size() >= cfg_.batch_bytes;
+    }
+    lines_.fetch_add(1, std::memory_order_relaxed);
+    if (wake)
+      cv_.notify_one();
+  }
+
+  LogFileStats LogFileWriter::stats() const
+  {
+    LogFileStats s;
+    s.lines = lines_.load();
+    s.dropped = dropped_.load();
+    s.bytes_written = bytes_written_.load();
+    s.writes = writes_.load();
+    s.fsyncs = fsyncs_.load();
+    s.rotations = rotations_.load();
+    s.write_errors = write_errors_.load();
+    s.syscalls = syscalls_.load();
+    return s;
+  }
+
+  std::string LogFileWriter::last_error() const
+  {
+    std::lock_guard<std::mutex> lock(error_mu_);
+    return last_error_;
+  }
+
+  std::size_t LogFileWriter::bytes() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    return pending_.capacity() + writing_capacity_.load() + io_bytes_.load();
+  }
+
+  void LogFileWriter::set_error(std::string error)
+  {
+    std::lock_guard<std::mutex> lock(error_mu_);
+    last_error_ = std::move(error);
+  }
+
+  void LogFileWriter::run()
+  {
+    const ThreadPolicyScope policy("log_file_writer");
+
+    const auto flush_every = std::chrono::milliseconds(cfg_.flush_every_ms);
+    const auto fsync_every = std::chrono::milliseconds(cfg_.fsync_every_ms);
+
+    for (;;)
+    {
+      bool stopping = false;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait_for(lock, flush_every, [this]()
+                     { return stop_ || pending_.size() >= cfg_.batch_bytes; });
+        stopping = stop_;
+        writing_.swap(pending_);
+      }
+
+      // A due sync rides on the batch, linked behind its last write.
+      const auto now = std::chrono::steady_clock::now();
+      const bool sync_due = cfg_.fsync_every_ms > 0 && now - last_sync_ >= fsync_every;
+      if (!writing_.empty())
+      {
+        write_out(writing_, sync_due);
+        writing_.clear();
+      }
+      else if (dirty_ && sync_due)
+      {
+        sync();
+      }
+      writing_capacity_.store(writing_.capacity(), std::memory_order_relaxed);
+      syscalls_.store(io_->syscalls(), std::memory_order_relaxed);
+
+      if (cfg_.rotate_every_s > 0 && file_bytes_ > 0 &&
+          now - opened_at_ >= std::chrono::seconds(cfg_.rotate_every_s))
+        rotate();
+
+      if (stopping)
+        break;
+    }
+
+    sync();
+    close_file();
+    syscalls_.store(io_->syscalls(), std::memory_order_relaxed);
+  }
+
+  void LogFileWriter::reap(int err)
+  {
+    if (err == 0)
+      return;
+    write_errors_.fetch_add(1);
+    set_error(std::string("write: ") + std::strerror(err));
+  }
+
+  std::size_t LogFileWriter::next_slot()
+  {
+    const std::size_t slot = slot_;
+    slot_ = (slot_ + 1) % io_->slots();
+    reap(io_->wait(slot));
+    return slot;
+  }
+
+#if defined(VIX_P2P_HTTP_HAS_LOG_FILES)
+  bool LogFileWriter::open_file(std::string &error)
+  {
+    // No O_APPEND: writes carry their offset, as they may complete out of order.
+    fd_ = ::open(cfg_.path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0640);
+    if (fd_ < 0)
+    {
+      error = "open " + cfg_.path + ": " + std::strerror(errno);
+      return false;
+    }
+
+    struct stat st{};
+    file_bytes_ = ::fstat(fd_, &st) == 0 ? (std::uint64_t)st.st_size : 0;
+    opened_at_ = std::chrono::steady_clock::now();
+    io_bytes_.store(io_->slots() * io_->slot_bytes(), std::memory_order_relaxed);
+    return true;
+  }
+
+  // Every write to fd_ must have completed before it is closed.
+  void LogFileWriter::close_file()
+  {
+    if (fd_ < 0)
+      return;
+    reap(io_->drain());
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  void LogFileWriter::sync()
+  {
+    if (fd_ < 0 || !dirty_)
+      return;
+    io_->submit(fd_, next_slot(), 0, 0, true);
+    fsyncs_.fetch_add(1, std::memory_order_relaxed);
+    dirty_ = false;
+    last_sync_ = std::chrono::steady_clock::now();
+  }
+
+  // path -> path.1 -> ... -> path.{keep}; the oldest falls off.
+  void LogFileWriter::rotate()
+  {
+    sync();
+    close_file();
+
+    if (cfg_.keep == 0)
+    {
+      ::unlink(cfg_.path.c_str());
+    }
+    else
+    {
+      const std::string oldest = cfg_.path + "." + std::to_string(cfg_.keep);
+      ::unlink(oldest.c_str());
+      for (int i = cfg_.keep - 1; i >= 1; --i)
+      {
+        const std::string from = cfg_.path + "." + std::to_string(i);
+        const std::string to = cfg_.path + "." + std::to_string(i + 1);
+        ::rename(from.c_str(), to.c_str());
+      }
+      const std::string first = cfg_.path + ".1";
+      ::rename(cfg_.path.c_str(), first.c_str());
+    }
+
+    std::string error;
+    if (!open_file(error))
+    {
+      write_errors_.fetch_add(1);
+      set_error(std::move(error));
+      return;
+    }
+    rotations_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void LogFileWriter::write_out(const std::string &data, bool sync)
+  {
+    if (fd_ < 0)
+    {
+      // A failed rotation left no file; try again before giving up the batch.
+      std::string error;
+      if (!open_file(error))
+      {
+        write_errors_.fetch_add(1);
+        set_error(std::move(error));
+        return;
+      }
+    }
+
+    // Slot-sized chunks; each waits only for its slot's previous write.
+    // Failures surface when the slot is reused (reap()).
+    const std::size_t chunk = io_->slot_bytes();
+    for (std::size_t off = 0; off < data.size(); off += chunk)
+    {
+      const std::size_t len = std::min(chunk, data.size() - off);
+      const bool last = off + len == data.size();
+      const std::size_t slot = next_slot();
+      std::memcpy(io_->slot_data(slot), data.data() + off, len);
+      io_->submit(fd_, slot, len, file_bytes_, sync && last);
+      writes_.fetch_add(1, std::memory_order_relaxed);
+      file_bytes_ += len;
+    }
+
+    bytes_written_.fetch_add(data.size(), std::memory_order_relaxed);
+    dirty_ = !sync;
+    if (sync)
+    {
+      fsyncs_.fetch_add(1, std::memory_order_relaxed);
+      last_sync_ = std::chrono::steady_clock::now();
+    }
+
+    if (cfg_.max_bytes > 0 && file_bytes_ >= cfg_.max_bytes)
+      rotate();
+  }
+#else
+  bool LogFileWriter::open_file(std::string &error)
+  {
+    error = "log files are POSIX only";
+    return false;
+  }
+
+  void LogFileWriter::close_file() {}
+  void LogFileWriter::sync() {}
+  void LogFileWriter::rotate() {}
+  void LogFileWriter::write_out(const std::string &, bool) {}
+#endif
+} // namespace vix::p2p_http::detail
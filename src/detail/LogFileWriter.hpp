@@ -0,0 +1,170 @@
+/**
+ *
+ *  @file LogFileWriter.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_LOG_FILE_WRITER_HPP
+#define VIX_P2P_HTTP_DETAIL_LOG_FILE_WRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "LogClock.hpp"
+#include "PersistIo.hpp"
+
+namespace vix::p2p_http::detail
+{
+  struct LogFileConfig
+  {
+    std::string path;
+
+    /** @brief Rotate once the file reaches this size (0 = never). */
+    std::uint64_t max_bytes = 64ull * 1024 * 1024;
+
+    /** @brief Rotate once the file is this old, in seconds (0 = never). */
+    int rotate_every_s = 0;
+
+    /** @brief Rotated files kept as path.1 .. path.N (newest first). */
+    int keep = 5;
+
+    /** @brief Longest a line waits in memory before it is written. */
+    int flush_every_ms = 200;
+
+    /** @brief fdatasync() cadence in milliseconds (0 = leave it to the kernel). */
+    int fsync_every_ms = 1000;
+
+    /** @brief Pending bytes that wake the writer early. */
+    std::size_t batch_bytes = 256 * 1024;
+
+    /** @brief Pending bytes past which new lines are dropped. */
+    std::size_t max_pending_bytes = 8 * 1024 * 1024;
+
+    /** @brief Write path; Auto prefers io_uring. */
+    PersistIoKind io = PersistIoKind::Auto;
+
+    /** @brief Writes in flight, each up to batch_bytes. */
+    std::size_t io_slots = 4;
+  };
+
+  struct LogFileStats
+  {
+    std::uint64_t lines = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t bytes_written = 0;
+    std::uint64_t writes = 0;
+    std::uint64_t fsyncs = 0;
+    std::uint64_t rotations = 0;
+    std::uint64_t write_errors = 0;
+    std::uint64_t syscalls = 0;
+  };
+
+  /**
+   * @brief Appends lines to a size- and time-rotated file from its own thread.
+   *
+   * Producers only copy the line into a pending buffer under a short lock.
+   * The writer swaps that buffer with its own and copies it into the
+   * PersistIo slots, which are written (and synced, on its own cadence)
+   * without waiting, so disk latency never reaches the threads logging.
+   * All buffers keep their capacity.
+   */
+  class LogFileWriter
+  {
+  public:
+    LogFileWriter() = default;
+    ~LogFileWriter();
+
+    LogFileWriter(const LogFileWriter &) = delete;
+    LogFileWriter &operator=(const LogFileWriter &) = delete;
+
+    /** @brief Open the file and start the writer; false with `error` when it fails. */
+    bool start(LogFileConfig cfg, std::string &error);
+
+    /** @brief Write what is pending, sync, close. */
+    void stop();
+
+    bool running() const noexcept { return running_.load(std::memory_order_relaxed); }
+
+    /** @brief Queue one line, stamped now (same format as GET /logs); a '\n' is added. */
+    void append(std::string_view line);
+
+    LogFileStats stats() const;
+    const std::string &path() const noexcept { return cfg_.path; }
+    std::string last_error() const;
+
+    /** @brief Backend in use ("io_uring", "threads", "blocking"). */
+    const char *backend() const noexcept { return backend_; }
+
+    /** @brief Why the requested backend was not used (empty when it was). */
+    const std::string &backend_note() const noexcept { return io_note_; }
+
+    /** @brief Bytes held by the line buffers and I/O slots (memory budget). */
+    std::size_t bytes() const;
+
+  private:
+    void run();
+    bool open_file(std::string &error);
+    void close_file();
+    void rotate();
+    void write_out(const std::string &data, bool sync);
+    void sync();
+    std::size_t next_slot();
+    void reap(int err);
+    void set_error(std::string error);
+
+    LogFileConfig cfg_;
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::string pending_;
+    LogTimeFormatter fmt_;
+    bool stop_ = false;
+
+    std::unique_ptr<PersistIo> io_;
+    const char *backend_ = "";
+    std::string io_note_;
+
+    // Writer thread only.
+    std::string writing_;
+    std::size_t slot_ = 0;
+    int fd_ = -1;
+    std::uint64_t file_bytes_ = 0;
+    std::chrono::steady_clock::time_point opened_at_{};
+    std::chrono::steady_clock::time_point last_sync_{};
+    bool dirty_ = false;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<std::uint64_t> lines_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> bytes_written_{0};
+    std::atomic<std::uint64_t> writes_{0};
+    std::atomic<std::uint64_t> fsyncs_{0};
+    std::atomic<std::uint64_t> rotations_{0};
+    std::atomic<std::uint64_t> write_errors_{0};
+    std::atomic<std::uint64_t> syscalls_{0};
+    std::atomic<std::size_t> writing_capacity_{0};
+    std::atomic<std::size_t> io_bytes_{0};
+
+    mutable std::mutex error_mu_;
+    std::string last_error_;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_LOG_FILE_WRITER_HPP
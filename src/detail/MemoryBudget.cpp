@@ -0,0 +1,157 @@
+/**
+ *
+ *  @file MemoryBudget.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "MemoryBudget.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  void MemoryBudget::set_limit(std::size_t bytes)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    limit_ = bytes;
+  }
+
+  std::size_t MemoryBudget::limit() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    return limit_;
+  }
+
+  MemoryBudget::Handle MemoryBudget::add(MemoryConsumer c)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    const Handle id = next_id_++;
+
+    Entry e;
+    e.id = id;
+    e.c = std::move(c);
+
+    // Keep entries in shrink order; equal priorities keep registration order.
+    auto pos = std::upper_bound(entries_.begin(), entries_.end(), e.c.priority,
+                                [](int p, const Entry &x)
+                                { return p < x.c.priority; });
+    entries_.insert(pos, std::move(e));
+    return id;
+  }
+
+  void MemoryBudget::remove(Handle h)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [h](const Entry &e)
+                                  { return e.id == h; }),
+                   entries_.end());
+  }
+
+  std::size_t MemoryBudget::used_locked() const
+  {
+    std::size_t total = 0;
+    for (const auto &e : entries_)
+    {
+      if (e.c.usage)
+        total += e.c.usage();
+    }
+    return total;
+  }
+
+  std::size_t MemoryBudget::used() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    return used_locked();
+  }
+
+  std::size_t MemoryBudget::enforce()
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (limit_ == 0)
+      return 0;
+
+    std::size_t total = used_locked();
+
+    if (total <= limit_)
+    {
+      if (!relaxed_ && total < limit_ / 2)
+      {
+        for (const auto &e : entries_)
+        {
+          if (e.c.relax)
+            e.c.relax();
+        }
+        relaxed_ = true;
+      }
+      return 0;
+    }
+
+    const std::size_t low_water = limit_ - limit_ / 8;
+    std::size_t released = 0;
+
+    for (const auto &e : entries_)
+    {
+      if (total <= low_water)
+        break;
+      if (!e.c.shrink)
+        continue;
+
+      const std::size_t freed = e.c.shrink(total - low_water);
+      released += freed;
+      total -= std::min(total, freed);
+    }
+
+    relaxed_ = false;
+    ++shrink_runs_;
+    bytes_released_ += released;
+    return released;
+  }
+
+  J::Json MemoryBudget::report() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+
+    J::Json subs = J::Json::array();
+    std::size_t total = 0;
+    for (const auto &e : entries_)
+    {
+      const std::size_t bytes = e.c.usage ? e.c.usage() : 0;
+      total += bytes;
+      subs.push_back(J::Json{
+          {"name", e.c.name},
+          {"priority", e.c.priority},
+          {"bytes", (long long)bytes},
+          {"shrinkable", static_cast<bool>(e.c.shrink)},
+      });
+    }
+
+    return J::Json{
+        {"ok", true},
+        {"module", "p2p_http"},
+        {"budget_bytes", (long long)limit_},
+        {"used_bytes", (long long)total},
+        {"over_budget", limit_ != 0 && total > limit_},
+        {"shrink_runs", (long long)shrink_runs_},
+        {"bytes_released", (long long)bytes_released_},
+        {"subsystems", std::move(subs)},
+    };
+  }
+
+  MemoryBudget &memory_budget()
+  {
+    static MemoryBudget b;
+    return b;
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,121 @@
+/**
+ *
+ *  @file MemoryBudget.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_MEMORY_BUDGET_HPP
+#define VIX_P2P_HTTP_DETAIL_MEMORY_BUDGET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vix/json/json.hpp>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief A subsystem accounted against the module memory budget.
+   *
+   * Callbacks run with the budget lock held and must not call back into
+   * the budget.
+   */
+  struct MemoryConsumer
+  {
+    std::string name;
+
+    /** @brief Shrink order: lower values give memory back first. */
+    int priority = 0;
+
+    /** @brief Current footprint in bytes. */
+    std::function<std::size_t()> usage;
+
+    /** @brief Release about `want` bytes, return what was freed (null = report only). */
+    std::function<std::size_t(std::size_t want)> shrink;
+
+    /** @brief Lift limits imposed by shrink() once there is headroom (optional). */
+    std::function<void()> relax;
+  };
+
+  /**
+   * @brief Single memory budget shared by the p2p_http subsystems.
+   *
+   * enforce() sums every consumer; above the limit it shrinks consumers in
+   * priority order until usage falls to the low-water mark (7/8 of the
+   * limit). Below half of the limit, consumers are allowed to grow back.
+   * A limit of 0 only accounts.
+   */
+  class MemoryBudget
+  {
+  public:
+    using Handle = std::uint64_t;
+
+    void set_limit(std::size_t bytes);
+    std::size_t limit() const;
+
+    Handle add(MemoryConsumer c);
+    void remove(Handle h);
+
+    /** @brief Apply the budget now; returns the bytes released. */
+    std::size_t enforce();
+
+    /** @brief Sum of every consumer's usage. */
+    std::size_t used() const;
+
+    /** @brief Report for GET /debug/memory. */
+    vix::json::Json report() const;
+
+  private:
+    struct Entry
+    {
+      Handle id = 0;
+      MemoryConsumer c;
+    };
+
+    std::size_t used_locked() const;
+
+    mutable std::mutex mu_;
+    std::vector<Entry> entries_;
+    Handle next_id_ = 1;
+    std::size_t limit_ = 0;
+    bool relaxed_ = true;
+
+    std::uint64_t shrink_runs_ = 0;
+    std::uint64_t bytes_released_ = 0;
+  };
+
+  MemoryBudget &memory_budget();
+
+  /** @brief Registers a consumer for the lifetime of the object. */
+  class MemoryRegistration
+  {
+  public:
+    MemoryRegistration() = default;
+    explicit MemoryRegistration(MemoryConsumer c) : id_(memory_budget().add(std::move(c))) {}
+    ~MemoryRegistration()
+    {
+      if (id_ != 0)
+        memory_budget().remove(id_);
+    }
+
+    MemoryRegistration(const MemoryRegistration &) = delete;
+    MemoryRegistration &operator=(const MemoryRegistration &) = delete;
+
+  private:
+    MemoryBudget::Handle id_ = 0;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_MEMORY_BUDGET_HPP
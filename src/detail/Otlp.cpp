@@ -0,0 +1,271 @@
+/**
+ *
+ *  @file Otlp.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "Otlp.hpp"
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    constexpr unsigned k_varint = 0;
+    constexpr unsigned k_fixed64 = 1;
+    constexpr unsigned k_len = 2;
+
+    // opentelemetry/proto field numbers used below.
+    namespace f
+    {
+      constexpr std::uint32_t request_resource = 1; // resource_metrics / resource_logs
+      constexpr std::uint32_t resource = 1;
+      constexpr std::uint32_t resource_scope_items = 2; // scope_metrics / scope_logs
+      constexpr std::uint32_t resource_attributes = 1;
+      constexpr std::uint32_t scope = 1;
+      constexpr std::uint32_t scope_items = 2; // metrics / log_records
+      constexpr std::uint32_t scope_name = 1;
+      constexpr std::uint32_t scope_version = 2;
+      constexpr std::uint32_t kv_key = 1;
+      constexpr std::uint32_t kv_value = 2;
+      constexpr std::uint32_t any_string = 1;
+
+      constexpr std::uint32_t metric_name = 1;
+      constexpr std::uint32_t metric_description = 2;
+      constexpr std::uint32_t metric_unit = 3;
+      constexpr std::uint32_t metric_gauge = 5;
+      constexpr std::uint32_t metric_sum = 7;
+      constexpr std::uint32_t data_points = 1;
+      constexpr std::uint32_t sum_temporality = 2;
+      constexpr std::uint32_t sum_monotonic = 3;
+      constexpr std::uint32_t point_start_ns = 2;
+      constexpr std::uint32_t point_time_ns = 3;
+      constexpr std::uint32_t point_as_int = 6;
+      constexpr std::uint32_t point_attributes = 7;
+
+      constexpr std::uint32_t log_time_ns = 1;
+      constexpr std::uint32_t log_severity_number = 2;
+      constexpr std::uint32_t log_severity_text = 3;
+      constexpr std::uint32_t log_body = 5;
+      constexpr std::uint32_t log_observed_ns = 11;
+    }
+
+    constexpr std::uint64_t k_temporality_cumulative = 2;
+    constexpr std::uint64_t k_severity_info = 9;
+
+    void key_value(ProtoWriter &w, std::uint32_t field, std::string_view key, std::string_view value)
+    {
+      const std::size_t kv = w.begin(field);
+      w.bytes(f::kv_key, key);
+      const std::size_t any = w.begin(f::kv_value);
+      w.bytes(f::any_string, value);
+      w.end(any);
+      w.end(kv);
+    }
+
+    // Resource { service.name } and the opening of the scope list entry,
+    // shared by both requests. Returns the marks to close in finish().
+    void open_scope(ProtoWriter &w, const OtlpScope &scope, std::size_t &resource_mark, std::size_t &scope_mark)
+    {
+      resource_mark = w.begin(f::request_resource);
+
+      const std::size_t res = w.begin(f::resource);
+      key_value(w, f::resource_attributes, "service.name", scope.service_name);
+      w.end(res);
+
+      scope_mark = w.begin(f::resource_scope_items);
+      const std::size_t is = w.begin(f::scope);
+      w.bytes(f::scope_name, scope.scope_name);
+      if (!scope.scope_version.empty())
+        w.bytes(f::scope_version, scope.scope_version);
+      w.end(is);
+    }
+  }
+
+  void ProtoWriter::raw_varint(std::uint64_t v)
+  {
+    while (v >= 0x80)
+    {
+      out_.push_back(static_cast<char>((v & 0x7f) | 0x80));
+      v >>= 7;
+    }
+    out_.push_back(static_cast<char>(v));
+  }
+
+  void ProtoWriter::tag(std::uint32_t field, unsigned wire_type)
+  {
+    raw_varint((static_cast<std::uint64_t>(field) << 3) | wire_type);
+  }
+
+  void ProtoWriter::varint(std::uint32_t field, std::uint64_t v)
+  {
+    tag(field, k_varint);
+    raw_varint(v);
+  }
+
+  void ProtoWriter::fixed64(std::uint32_t field, std::uint64_t v)
+  {
+    tag(field, k_fixed64);
+    for (int i = 0; i < 8; ++i)
+      out_.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+  }
+
+  void ProtoWriter::bytes(std::uint32_t field, std::string_view s)
+  {
+    tag(field, k_len);
+    raw_varint(s.size());
+    out_.append(s);
+  }
+
+  std::size_t ProtoWriter::begin(std::uint32_t field)
+  {
+    tag(field, k_len);
+    return out_.size();
+  }
+
+  void ProtoWriter::end(std::size_t mark)
+  {
+    std::uint64_t len = out_.size() - mark;
+
+    char prefix[10];
+    std::size_t n = 0;
+    while (len >= 0x80)
+    {
+      prefix[n++] = static_cast<char>((len & 0x7f) | 0x80);
+      len >>= 7;
+    }
+    prefix[n++] = static_cast<char>(len);
+
+    out_.insert(mark, prefix, n);
+  }
+
+  OtlpMetricsEncoder::OtlpMetricsEncoder(std::string &out, const OtlpScope &scope) : w_(out)
+  {
+    open_scope(w_, scope, resource_, scope_);
+  }
+
+  void OtlpMetricsEncoder::begin_metric(std::string_view name, std::string_view unit, std::string_view description, Kind kind)
+  {
+    kind_ = kind;
+    metric_ = w_.begin(f::scope_items);
+    w_.bytes(f::metric_name, name);
+    if (!description.empty())
+      w_.bytes(f::metric_description, description);
+    if (!unit.empty())
+      w_.bytes(f::metric_unit, unit);
+
+    data_ = w_.begin(kind == Kind::Gauge ? f::metric_gauge : f::metric_sum);
+    if (kind == Kind::CumulativeSum)
+    {
+      w_.varint(f::sum_temporality, k_temporality_cumulative);
+      w_.varint(f::sum_monotonic, 1);
+    }
+  }
+
+  void OtlpMetricsEncoder::point(std::uint64_t start_ns, std::uint64_t time_ns, long long value,
+                                 std::string_view attr_key, std::string_view attr_value)
+  {
+    const std::size_t p = w_.begin(f::data_points);
+    if (kind_ == Kind::CumulativeSum)
+      w_.fixed64(f::point_start_ns, start_ns);
+    w_.fixed64(f::point_time_ns, time_ns);
+    w_.fixed64(f::point_as_int, static_cast<std::uint64_t>(value));
+    if (!attr_key.empty())
+      key_value(w_, f::point_attributes, attr_key, attr_value);
+    w_.end(p);
+  }
+
+  void OtlpMetricsEncoder::end_metric()
+  {
+    w_.end(data_);
+    w_.end(metric_);
+  }
+
+  void OtlpMetricsEncoder::finish()
+  {
+    w_.end(scope_);
+    w_.end(resource_);
+  }
+
+  OtlpLogsEncoder::OtlpLogsEncoder(std::string &out, const OtlpScope &scope) : w_(out)
+  {
+    open_scope(w_, scope, resource_, scope_);
+  }
+
+  void OtlpLogsEncoder::record(std::uint64_t time_ns, std::uint64_t observed_ns, std::string_view body)
+  {
+    const std::size_t r = w_.begin(f::scope_items);
+    w_.fixed64(f::log_time_ns, time_ns);
+    w_.varint(f::log_severity_number, k_severity_info);
+    w_.bytes(f::log_severity_text, "INFO");
+    const std::size_t any = w_.begin(f::log_body);
+    w_.bytes(f::any_string, body);
+    w_.end(any);
+    w_.fixed64(f::log_observed_ns, observed_ns);
+    w_.end(r);
+  }
+
+  void OtlpLogsEncoder::finish()
+  {
+    w_.end(scope_);
+    w_.end(resource_);
+  }
+
+  void make_valid_utf8(std::string &s) noexcept
+  {
+    const std::size_t n = s.size();
+    std::size_t i = 0;
+    while (i < n)
+    {
+      const auto c = static_cast<unsigned char>(s[i]);
+      if (c < 0x80)
+      {
+        ++i;
+        continue;
+      }
+
+      std::size_t len = 0;
+      std::uint32_t cp = 0;
+      if ((c & 0xe0) == 0xc0)
+      {
+        len = 2;
+        cp = c & 0x1f;
+      }
+      else if ((c & 0xf0) == 0xe0)
+      {
+        len = 3;
+        cp = c & 0x0f;
+      }
+      else if ((c & 0xf8) == 0xf0)
+      {
+        len = 4;
+        cp = c & 0x07;
+      }
+
+      bool ok = len != 0 && i + len <= n;
+      for (std::size_t k = 1; ok && k < len; ++k)
+      {
+        const auto cc = static_cast<unsigned char>(s[i + k]);
+        ok = (cc & 0xc0) == 0x80;
+        cp = (cp << 6) | (cc & 0x3f);
+      }
+      // Overlong forms, surrogates and values past U+10FFFF are invalid too.
+      static constexpr std::uint32_t k_min[] = {0, 0, 0x80, 0x800, 0x10000};
+      ok = ok && cp >= k_min[len] && cp <= 0x10ffff && (cp < 0xd800 || cp > 0xdfff);
+
+      if (ok)
+      {
+        i += len;
+        continue;
+      }
+      s[i++] = '?';
+    }
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,122 @@
+/**
+ *
+ *  @file Otlp.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_OTLP_HPP
+#define VIX_P2P_HTTP_DETAIL_OTLP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Protobuf wire-format writer appending to a caller-owned buffer.
+   *
+   * Nested messages are written in place: begin() leaves the length out and
+   * end() inserts it once the body is known, so nothing is sized twice and
+   * no temporary is built. Reuse the buffer to keep encoding allocation-free.
+   */
+  class ProtoWriter
+  {
+  public:
+    explicit ProtoWriter(std::string &out) : out_(out) {}
+
+    void varint(std::uint32_t field, std::uint64_t v);
+    void fixed64(std::uint32_t field, std::uint64_t v);
+    void bytes(std::uint32_t field, std::string_view s);
+
+    /** @brief Open a nested message; pass the result to end(). */
+    std::size_t begin(std::uint32_t field);
+    void end(std::size_t mark);
+
+  private:
+    void tag(std::uint32_t field, unsigned wire_type);
+    void raw_varint(std::uint64_t v);
+
+    std::string &out_;
+  };
+
+  /** @brief Resource and instrumentation scope of every OTLP request. */
+  struct OtlpScope
+  {
+    std::string_view service_name;
+    std::string_view scope_name = "vix.p2p_http";
+    std::string_view scope_version;
+  };
+
+  /**
+   * @brief ExportMetricsServiceRequest encoder (OTLP metrics v1).
+   *
+   * One resource and scope; metrics are integer gauges or cumulative
+   * monotonic sums with at most one attribute per data point.
+   */
+  class OtlpMetricsEncoder
+  {
+  public:
+    enum class Kind
+    {
+      Gauge,
+      CumulativeSum,
+    };
+
+    OtlpMetricsEncoder(std::string &out, const OtlpScope &scope);
+
+    void begin_metric(std::string_view name, std::string_view unit, std::string_view description, Kind kind);
+
+    /** @brief `start_ns` is only written for sums. Empty `attr_key`: no attribute. */
+    void point(std::uint64_t start_ns, std::uint64_t time_ns, long long value,
+               std::string_view attr_key = {}, std::string_view attr_value = {});
+
+    void end_metric();
+
+    /** @brief Close the request; `out` then holds the complete payload. */
+    void finish();
+
+  private:
+    ProtoWriter w_;
+    Kind kind_ = Kind::Gauge;
+    std::size_t resource_ = 0;
+    std::size_t scope_ = 0;
+    std::size_t metric_ = 0;
+    std::size_t data_ = 0;
+  };
+
+  /** @brief ExportLogsServiceRequest encoder (OTLP logs v1), INFO records. */
+  class OtlpLogsEncoder
+  {
+  public:
+    OtlpLogsEncoder(std::string &out, const OtlpScope &scope);
+
+    /** @brief `body` must be valid UTF-8 (see make_valid_utf8()). */
+    void record(std::uint64_t time_ns, std::uint64_t observed_ns, std::string_view body);
+
+    void finish();
+
+  private:
+    ProtoWriter w_;
+    std::size_t resource_ = 0;
+    std::size_t scope_ = 0;
+  };
+
+  /**
+   * @brief Replace bytes that are not valid UTF-8 with '?', in place.
+   *
+   * OTLP string fields are proto3 strings; collectors reject a payload
+   * holding invalid UTF-8.
+   */
+  void make_valid_utf8(std::string &s) noexcept;
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_OTLP_HPP
@@ -0,0 +1,623 @@
+/**
+ *
+ *  @file PeerIndex.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "PeerIndex.hpp"
+#include "ArrowIpc.hpp"
+#include "JsonWrite.hpp"
+#include "RowExport.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <unordered_map>
+#include <utility>
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    char hex2(std::uint8_t b) noexcept
+    {
+      b &= 0x0F;
+      return (b < 10) ? char('0' + b) : char('a' + (b - 10));
+    }
+
+    // Writes into `out` so the row's allocator is kept.
+    void short_fp_bytes(const std::vector<std::uint8_t> &v, std::pmr::string &out)
+    {
+      out.clear();
+      if (v.empty())
+        return;
+
+      const std::size_t n = v.size();
+      const std::size_t take = std::min<std::size_t>(4, n);
+
+      out.reserve(take * 2 + 10);
+
+      for (std::size_t i = 0; i < take; ++i)
+      {
+        const std::uint8_t b = v[i];
+        out.push_back(hex2(std::uint8_t(b >> 4)));
+        out.push_back(hex2(b));
+      }
+
+      char digits[24];
+      const auto end = std::to_chars(digits, digits + sizeof(digits), n).ptr;
+      out.append("..(");
+      out.append(digits, end);
+      out.push_back(')');
+    }
+
+    long long ms_since(std::chrono::steady_clock::time_point now,
+                       std::chrono::steady_clock::time_point t) noexcept
+    {
+      if (t.time_since_epoch().count() == 0)
+        return -1;
+      return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(now - t).count();
+    }
+  }
+
+  const char *peer_state_name(vix::p2p::PeerState s) noexcept
+  {
+    switch (s)
+    {
+    case vix::p2p::PeerState::Disconnected: return "disconnected";
+    case vix::p2p::PeerState::Connecting:   return "connecting";
+    case vix::p2p::PeerState::Handshaking:  return "handshaking";
+    case vix::p2p::PeerState::Connected:    return "connected";
+    case vix::p2p::PeerState::Stale:        return "stale";
+    case vix::p2p::PeerState::Closed:       return "closed";
+    default:                                return "unknown";
+    }
+  }
+
+  const char *handshake_stage_name(vix::p2p::HandshakeState::Stage s) noexcept
+  {
+    switch (s)
+    {
+    case vix::p2p::HandshakeState::Stage::None:          return "none";
+    case vix::p2p::HandshakeState::Stage::HelloSent:     return "hello_sent";
+    case vix::p2p::HandshakeState::Stage::HelloReceived: return "hello_received";
+    case vix::p2p::HandshakeState::Stage::AckSent:       return "ack_sent";
+    case vix::p2p::HandshakeState::Stage::AckReceived:   return "ack_received";
+    case vix::p2p::HandshakeState::Stage::Finished:      return "finished";
+    default:                                             return "unknown";
+    }
+  }
+
+  std::optional<vix::p2p::PeerState> parse_peer_state(std::string_view name) noexcept
+  {
+    using S = vix::p2p::PeerState;
+    for (S s : {S::Disconnected, S::Connecting, S::Handshaking, S::Connected, S::Stale, S::Closed})
+    {
+      if (name == peer_state_name(s))
+        return s;
+    }
+    return std::nullopt;
+  }
+
+  std::string peer_endpoint_string(const PeerRow &row, const Interner::Reader &names)
+  {
+    if (!row.has_endpoint)
+      return "";
+
+    const std::string_view scheme = names.view(row.scheme);
+    const std::string_view host = names.view(row.host);
+
+    std::string out;
+    out.reserve(scheme.size() + host.size() + 9);
+    out.append(scheme).append("://").append(host).push_back(':');
+    out += std::to_string(row.port);
+    return out;
+  }
+
+  PeerRows build_peer_rows(const vix::p2p::Node &node,
+                           std::pmr::memory_resource *scratch,
+                           std::pmr::memory_resource *resource)
+  {
+    const auto snap = node.peers_snapshot();
+    const auto now = std::chrono::steady_clock::now();
+
+    // Make output stable: sort by peer_id. Sort pointers into the snapshot
+    // rather than copying (PeerId, Peer) pairs.
+    std::pmr::vector<const std::pair<const vix::p2p::PeerId, vix::p2p::Peer> *> order(scratch);
+    order.reserve(snap.size());
+    for (const auto &kv : snap)
+      order.push_back(&kv);
+
+    std::sort(order.begin(), order.end(),
+              [](const auto *a, const auto *b)
+              {
+                return a->first < b->first;
+              });
+
+    auto &names = interner();
+    const Symbol tcp = names.intern("tcp");
+
+    PeerRows rows(resource);
+    rows.reserve(order.size());
+
+    for (const auto *kv : order)
+    {
+      const auto &p = kv->second;
+
+      PeerRow &r = rows.emplace_back();
+      r.peer_id = names.intern(kv->first);
+      r.state = p.state;
+
+      if (p.endpoint)
+      {
+        r.has_endpoint = true;
+        r.scheme = (p.endpoint->scheme.empty() ? tcp : names.intern(p.endpoint->scheme));
+        r.host = names.intern(p.endpoint->host);
+        r.port = p.endpoint->port;
+      }
+
+      r.secure = p.meta.secure;
+      r.capabilities_count = (long long)p.meta.capabilities.size();
+      short_fp_bytes(p.meta.public_key, r.public_key_fp);
+      short_fp_bytes(p.meta.session_key_32, r.session_key_fp);
+      r.last_seen_ms_ago = ms_since(now, p.meta.last_seen);
+
+      if (p.handshake)
+      {
+        r.has_handshake = true;
+        r.handshake_stage = p.handshake->stage;
+        r.handshake_age_ms = ms_since(now, p.handshake->started_at);
+        r.nonce_a = (long long)p.handshake->nonce_a;
+        r.nonce_b = (long long)p.handshake->nonce_b;
+        r.ts_ms = (long long)p.handshake->ts_ms;
+      }
+    }
+
+    return rows;
+  }
+
+  PeerRows merge_peer_rows(std::pmr::vector<PeerRows> parts, std::pmr::memory_resource *resource)
+  {
+    PeerRows out(resource);
+    if (parts.size() == 1)
+    {
+      // Moves element-wise when the part lives on another resource.
+      out = std::move(parts.front());
+      return out;
+    }
+
+    std::size_t total = 0;
+    for (const auto &p : parts)
+      total += p.size();
+
+    out.reserve(total);
+
+    const auto names = interner().reader();
+
+    // Heap of (part, position) heads; top is the smallest peer_id.
+    struct Head
+    {
+      std::size_t part;
+      std::size_t pos;
+      std::string_view id;
+    };
+
+    auto greater = [](const Head &a, const Head &b)
+    {
+      return a.id != b.id ? a.id > b.id : a.part > b.part;
+    };
+
+    std::pmr::vector<Head> heap(parts.get_allocator().resource());
+    heap.reserve(parts.size());
+    for (std::size_t i = 0; i < parts.size(); ++i)
+    {
+      if (!parts[i].empty())
+        heap.push_back(Head{i, 0, names.view(parts[i][0].peer_id)});
+    }
+    std::make_heap(heap.begin(), heap.end(), greater);
+
+    while (!heap.empty())
+    {
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      Head &h = heap.back();
+
+      auto &part = parts[h.part];
+      out.push_back(std::move(part[h.pos]));
+
+      if (++h.pos < part.size())
+      {
+        h.id = names.view(part[h.pos].peer_id);
+        std::push_heap(heap.begin(), heap.end(), greater);
+      }
+      else
+      {
+        heap.pop_back();
+      }
+    }
+
+    return out;
+  }
+
+  void append_peer_row_json(std::string &out, const PeerRow &r, const Interner::Reader &names)
+  {
+    // Keys in Json::dump() order so the body is unchanged from the DOM version.
+    out.append("{\"capabilities_count\":");
+    append_json_int(out, r.capabilities_count);
+
+    out.append(",\"endpoint\":\"");
+    if (r.has_endpoint)
+    {
+      append_json_escaped(out, names.view(r.scheme));
+      out.append("://");
+      append_json_escaped(out, names.view(r.host));
+      out.push_back(':');
+      append_json_int(out, r.port);
+    }
+    out.push_back('"');
+
+    out.append(",\"handshake_age_ms\":");
+    append_json_int(out, r.handshake_age_ms);
+    out.append(",\"handshake_stage\":\"");
+    out.append(r.has_handshake ? handshake_stage_name(r.handshake_stage) : "none");
+    out.append("\",\"has_endpoint\":");
+    append_json_bool(out, r.has_endpoint);
+    out.append(",\"has_handshake\":");
+    append_json_bool(out, r.has_handshake);
+    out.append(",\"host\":");
+    append_json_string(out, names.view(r.host));
+    out.append(",\"last_seen_ms_ago\":");
+    append_json_int(out, r.last_seen_ms_ago);
+    out.append(",\"nonce_a\":");
+    append_json_int(out, r.nonce_a);
+    out.append(",\"nonce_b\":");
+    append_json_int(out, r.nonce_b);
+    out.append(",\"peer_id\":");
+    append_json_string(out, names.view(r.peer_id));
+    out.append(",\"port\":");
+    append_json_int(out, r.port);
+    out.append(",\"public_key_fp\":");
+    append_json_string(out, r.public_key_fp);
+    out.append(",\"public_key_len\":");
+    append_json_string(out, r.public_key_fp);
+    if (r.runtime != 0)
+    {
+      out.append(",\"runtime\":");
+      append_json_string(out, names.view(r.runtime));
+    }
+    out.append(",\"scheme\":");
+    append_json_string(out, names.view(r.scheme));
+    out.append(",\"secure\":");
+    append_json_bool(out, r.secure);
+    out.append(",\"session_key_len\":");
+    append_json_string(out, r.session_key_fp);
+    out.append(",\"state\":\"");
+    out.append(peer_state_name(r.state));
+    out.append("\",\"ts_ms\":");
+    append_json_int(out, r.ts_ms);
+    out.push_back('}');
+  }
+
+  void append_peer_row_array(std::string &out, const PeerRow &r, const Interner::Reader &names, bool with_runtime)
+  {
+    // Same values and order as append_peer_row_json(), without the keys.
+    out.push_back('[');
+    append_json_int(out, r.capabilities_count);
+
+    out.append(",\"");
+    if (r.has_endpoint)
+    {
+      append_json_escaped(out, names.view(r.scheme));
+      out.append("://");
+      append_json_escaped(out, names.view(r.host));
+      out.push_back(':');
+      append_json_int(out, r.port);
+    }
+    out.append("\",");
+
+    append_json_int(out, r.handshake_age_ms);
+    out.append(",\"");
+    out.append(r.has_handshake ? handshake_stage_name(r.handshake_stage) : "none");
+    out.append("\",");
+    append_json_bool(out, r.has_endpoint);
+    out.push_back(',');
+    append_json_bool(out, r.has_handshake);
+    out.push_back(',');
+    append_json_string(out, names.view(r.host));
+    out.push_back(',');
+    append_json_int(out, r.last_seen_ms_ago);
+    out.push_back(',');
+    append_json_int(out, r.nonce_a);
+    out.push_back(',');
+    append_json_int(out, r.nonce_b);
+    out.push_back(',');
+    append_json_string(out, names.view(r.peer_id));
+    out.push_back(',');
+    append_json_int(out, r.port);
+    out.push_back(',');
+    append_json_string(out, r.public_key_fp);
+    out.push_back(',');
+    append_json_string(out, r.public_key_fp);
+    if (with_runtime)
+    {
+      out.push_back(',');
+      append_json_string(out, names.view(r.runtime));
+    }
+    out.push_back(',');
+    append_json_string(out, names.view(r.scheme));
+    out.push_back(',');
+    append_json_bool(out, r.secure);
+    out.push_back(',');
+    append_json_string(out, r.session_key_fp);
+    out.append(",\"");
+    out.append(peer_state_name(r.state));
+    out.append("\",");
+    append_json_int(out, r.ts_ms);
+    out.push_back(']');
+  }
+
+  std::string peers_body_compact(const PeerRows &rows, const PeerFilter &filter)
+  {
+    constexpr std::size_t k_row_bytes_hint = 192;
+
+    const auto names = interner().reader();
+    const bool with_runtime = std::any_of(rows.begin(), rows.end(), [](const PeerRow &r)
+                                          { return r.runtime != 0; });
+
+    std::string out;
+    out.reserve(384 + rows.size() * k_row_bytes_hint);
+    out.append("{\"columns\":[\"capabilities_count\",\"endpoint\",\"handshake_age_ms\","
+               "\"handshake_stage\",\"has_endpoint\",\"has_handshake\",\"host\","
+               "\"last_seen_ms_ago\",\"nonce_a\",\"nonce_b\",\"peer_id\",\"port\","
+               "\"public_key_fp\",\"public_key_len\",");
+    if (with_runtime)
+      out.append("\"runtime\",");
+    out.append("\"scheme\",\"secure\",\"session_key_len\",\"state\",\"ts_ms\"],"
+               "\"module\":\"p2p_http\",\"ok\":true,\"rows\":[");
+
+    long long total = 0;
+    for (const auto &r : rows)
+    {
+      if (!filter.matches(r))
+        continue;
+      if (total++ > 0)
+        out.push_back(',');
+      append_peer_row_array(out, r, names, with_runtime);
+    }
+
+    out.append("],\"total\":");
+    append_json_int(out, total);
+    out.push_back('}');
+    return out;
+  }
+
+  std::string peers_arrow(const PeerRows &rows, const PeerFilter &filter, std::size_t batch_rows)
+  {
+    // Dictionary-encoded columns, in schema order.
+    enum DictField : std::size_t
+    {
+      k_state = 1,
+      k_scheme = 2,
+      k_stage = 7,
+      k_runtime = 17,
+    };
+
+    // Assigns dictionary indices in order of first appearance.
+    struct Dict
+    {
+      std::vector<std::string_view> values;
+      std::unordered_map<std::string_view, std::int32_t> index;
+
+      std::int32_t add(std::string_view v)
+      {
+        const auto [it, fresh] = index.emplace(v, static_cast<std::int32_t>(values.size()));
+        if (fresh)
+          values.push_back(v);
+        return it->second;
+      }
+    };
+
+    const auto names = interner().reader();
+
+    std::vector<const PeerRow *> picked;
+    picked.reserve(rows.size());
+    bool with_runtime = false;
+    for (const auto &r : rows)
+    {
+      if (!filter.matches(r))
+        continue;
+      picked.push_back(&r);
+      with_runtime = with_runtime || r.runtime != 0;
+    }
+
+    std::vector<ArrowField> fields = {
+        {"peer_id", ArrowType::Utf8},
+        {"state", ArrowType::DictUtf8},
+        {"scheme", ArrowType::DictUtf8},
+        {"host", ArrowType::Utf8},
+        {"port", ArrowType::UInt16},
+        {"has_endpoint", ArrowType::Bool},
+        {"secure", ArrowType::Bool},
+        {"handshake_stage", ArrowType::DictUtf8},
+        {"has_handshake", ArrowType::Bool},
+        {"capabilities_count", ArrowType::Int64},
+        {"public_key_fp", ArrowType::Utf8},
+        {"session_key_fp", ArrowType::Utf8},
+        {"last_seen_ms_ago", ArrowType::Int64},
+        {"handshake_age_ms", ArrowType::Int64},
+        {"nonce_a", ArrowType::Int64},
+        {"nonce_b", ArrowType::Int64},
+        {"ts_ms", ArrowType::Int64},
+    };
+    if (with_runtime)
+      fields.push_back({"runtime", ArrowType::DictUtf8});
+
+    // Dictionaries precede the batches, so index every value up front.
+    Dict state, scheme, stage, runtime;
+    std::vector<std::int32_t> idx_state, idx_scheme, idx_stage, idx_runtime;
+    idx_state.reserve(picked.size());
+    idx_scheme.reserve(picked.size());
+    idx_stage.reserve(picked.size());
+    for (const auto *r : picked)
+    {
+      idx_state.push_back(state.add(peer_state_name(r->state)));
+      idx_scheme.push_back(scheme.add(names.view(r->scheme)));
+      idx_stage.push_back(stage.add(r->has_handshake ? handshake_stage_name(r->handshake_stage) : "none"));
+      if (with_runtime)
+        idx_runtime.push_back(runtime.add(names.view(r->runtime)));
+    }
+
+    std::string out;
+    out.reserve(4096 + picked.size() * 160);
+    ArrowStreamWriter w(out);
+    w.schema(fields);
+    w.dictionary(k_state, state.values);
+    w.dictionary(k_scheme, scheme.values);
+    w.dictionary(k_stage, stage.values);
+    if (with_runtime)
+      w.dictionary(k_runtime, runtime.values);
+
+    std::vector<ArrowColumn> cols;
+    cols.reserve(fields.size());
+    for (const auto &f : fields)
+      cols.emplace_back(f.type);
+
+    batch_rows = batch_rows == 0 ? picked.size() : batch_rows;
+    std::size_t i = 0;
+    do
+    {
+      const std::size_t end = std::min(picked.size(), i + batch_rows);
+      for (auto &c : cols)
+      {
+        c.clear();
+        c.reserve(end - i, (end - i) * 16);
+      }
+
+      for (; i < end; ++i)
+      {
+        const PeerRow &r = *picked[i];
+        cols[0].push_utf8(names.view(r.peer_id));
+        cols[1].push_index(idx_state[i]);
+        cols[2].push_index(idx_scheme[i]);
+        cols[3].push_utf8(names.view(r.host));
+        cols[4].push_uint16(r.port);
+        cols[5].push_bool(r.has_endpoint);
+        cols[6].push_bool(r.secure);
+        cols[7].push_index(idx_stage[i]);
+        cols[8].push_bool(r.has_handshake);
+        cols[9].push_int64(r.capabilities_count);
+        cols[10].push_utf8(r.public_key_fp);
+        cols[11].push_utf8(r.session_key_fp);
+        cols[12].push_int64(r.last_seen_ms_ago);
+        cols[13].push_int64(r.handshake_age_ms);
+        cols[14].push_int64(r.nonce_a);
+        cols[15].push_int64(r.nonce_b);
+        cols[16].push_int64(r.ts_ms);
+        if (with_runtime)
+          cols[k_runtime].push_index(idx_runtime[i]);
+      }
+      w.batch(cols);
+    } while (i < picked.size());
+
+    w.finish();
+    return out;
+  }
+
+  bool export_peers(const PeerRows &rows, const PeerFilter &filter, ExportFormat format, const ChunkSink &sink)
+  {
+    // Rows formatted per intern-table lock.
+    constexpr std::size_t k_block_rows = 256;
+
+    bool with_runtime = false;
+    for (const auto &r : rows)
+    {
+      if (r.runtime != 0 && filter.matches(r))
+      {
+        with_runtime = true;
+        break;
+      }
+    }
+
+    std::vector<std::string_view> columns = {
+        "peer_id", "state", "scheme", "host", "port", "has_endpoint", "secure",
+        "handshake_stage", "has_handshake", "capabilities_count", "public_key_fp",
+        "session_key_fp", "last_seen_ms_ago", "handshake_age_ms", "nonce_a", "nonce_b", "ts_ms"};
+    if (with_runtime)
+      columns.push_back("runtime");
+
+    ExportWriter w(format, std::move(columns), sink);
+
+    std::size_t i = 0;
+    while (i < rows.size())
+    {
+      {
+        const auto names = interner().reader();
+        const std::size_t end = std::min(rows.size(), i + k_block_rows);
+        for (; i < end; ++i)
+        {
+          const PeerRow &r = rows[i];
+          if (!filter.matches(r))
+            continue;
+
+          w.begin_row();
+          w.field_str(names.view(r.peer_id));
+          w.field_str(peer_state_name(r.state));
+          w.field_str(names.view(r.scheme));
+          w.field_str(names.view(r.host));
+          w.field_int(r.port);
+          w.field_bool(r.has_endpoint);
+          w.field_bool(r.secure);
+          w.field_str(r.has_handshake ? handshake_stage_name(r.handshake_stage) : "none");
+          w.field_bool(r.has_handshake);
+          w.field_int(r.capabilities_count);
+          w.field_str(r.public_key_fp);
+          w.field_str(r.session_key_fp);
+          w.field_int(r.last_seen_ms_ago);
+          w.field_int(r.handshake_age_ms);
+          w.field_int(r.nonce_a);
+          w.field_int(r.nonce_b);
+          w.field_int(r.ts_ms);
+          if (with_runtime)
+            w.field_str(names.view(r.runtime));
+          w.end_row();
+        }
+      }
+      if (!w.flush_if_full())
+        return false;
+    }
+    return w.finish();
+  }
+
+  std::string peers_body(const PeerRows &rows, const PeerFilter &filter)
+  {
+    constexpr std::size_t k_row_bytes_hint = 448;
+
+    const auto names = interner().reader();
+
+    std::string out;
+    out.reserve(64 + rows.size() * k_row_bytes_hint);
+    out.append("{\"module\":\"p2p_http\",\"ok\":true,\"peers\":[");
+
+    long long total = 0;
+    for (const auto &r : rows)
+    {
+      if (!filter.matches(r))
+        continue;
+      if (total++ > 0)
+        out.push_back(',');
+      append_peer_row_json(out, r, names);
+    }
+
+    out.append("],\"total\":");
+    append_json_int(out, total);
+    out.push_back('}');
+    return out;
+  }
+} // namespace vix::p2p_http::detail
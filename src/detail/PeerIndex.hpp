@@ -0,0 +1,187 @@
+/**
+ *
+ *  @file PeerIndex.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_PEER_INDEX_HPP
+#define VIX_P2P_HTTP_DETAIL_PEER_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Interner.hpp"
+#include "RowExport.hpp"
+
+#include <vix/p2p/Node.hpp>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief One peer, flattened for serialization.
+   *
+   * Rows are built once from a node snapshot and are independent of the
+   * node afterwards, so they can be cached and shared between requests.
+   * Peer id, scheme and host are interned Symbols.
+   *
+   * Allocator-aware: in a PeerRows the fingerprints use the vector's
+   * resource, so per-request rows stay on the scratch arena.
+   */
+  struct PeerRow
+  {
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    PeerRow() = default;
+    explicit PeerRow(const allocator_type &alloc) : public_key_fp(alloc), session_key_fp(alloc) {}
+    PeerRow(const PeerRow &) = default;
+    PeerRow(PeerRow &&) = default;
+    PeerRow(const PeerRow &other, const allocator_type &alloc) : PeerRow(alloc) { *this = other; }
+    PeerRow(PeerRow &&other, const allocator_type &alloc) : PeerRow(alloc) { *this = std::move(other); }
+    PeerRow &operator=(const PeerRow &) = default;
+    PeerRow &operator=(PeerRow &&) = default;
+
+    Symbol peer_id = 0;
+    vix::p2p::PeerState state = vix::p2p::PeerState::Disconnected;
+
+    bool has_endpoint = false;
+    Symbol scheme = 0;
+    Symbol host = 0;
+    std::uint16_t port = 0;
+
+    bool secure = false;
+    long long capabilities_count = 0;
+    std::pmr::string public_key_fp;
+    std::pmr::string session_key_fp;
+
+    long long last_seen_ms_ago = -1;
+
+    bool has_handshake = false;
+    vix::p2p::HandshakeState::Stage handshake_stage = vix::p2p::HandshakeState::Stage::None;
+    long long handshake_age_ms = -1;
+    long long nonce_a = 0;
+    long long nonce_b = 0;
+    long long ts_ms = 0;
+
+    /** @brief Owning runtime in multi-runtime views (0 = single runtime). */
+    Symbol runtime = 0;
+  };
+
+  /** @brief Peer rows sorted by peer_id. */
+  using PeerRows = std::pmr::vector<PeerRow>;
+
+  /** @brief Append the Symbols a row holds (Interner::collect() roots). */
+  inline void append_row_symbols(const PeerRow &r, std::vector<Symbol> &out)
+  {
+    out.push_back(r.peer_id);
+    out.push_back(r.scheme);
+    out.push_back(r.host);
+    out.push_back(r.runtime);
+  }
+
+  /**
+   * @brief Equality filter on interned columns (GET /peers query).
+   *
+   * Values are resolved to Symbols once with Interner::find(); a value that
+   * was never interned matches nothing.
+   */
+  struct PeerFilter
+  {
+    std::optional<vix::p2p::PeerState> state;
+    std::optional<Symbol> scheme;
+    std::optional<Symbol> host;
+    std::optional<Symbol> runtime;
+
+    bool empty() const noexcept { return !state && !scheme && !host && !runtime; }
+
+    bool matches(const PeerRow &r) const noexcept
+    {
+      return (!state || r.state == *state) &&
+             (!scheme || r.scheme == *scheme) &&
+             (!host || r.host == *host) &&
+             (!runtime || r.runtime == *runtime);
+    }
+  };
+
+  const char *peer_state_name(vix::p2p::PeerState s) noexcept;
+  const char *handshake_stage_name(vix::p2p::HandshakeState::Stage s) noexcept;
+
+  /** @brief Inverse of peer_state_name(). */
+  std::optional<vix::p2p::PeerState> parse_peer_state(std::string_view name) noexcept;
+
+  /** @brief "scheme://host:port", or "" without an endpoint. */
+  std::string peer_endpoint_string(const PeerRow &row, const Interner::Reader &names);
+
+  /**
+   * @brief Snapshot the node and build rows sorted by peer_id.
+   * @param scratch Resource for build temporaries (request arena).
+   * @param resource Resource of the returned rows.
+   */
+  PeerRows build_peer_rows(
+      const vix::p2p::Node &node,
+      std::pmr::memory_resource *scratch = std::pmr::get_default_resource(),
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  /**
+   * @brief K-way merge of per-runtime row sets, each sorted by peer_id.
+   *
+   * Uses a heap over the k sequence heads, so the cost is O(n log k) in the
+   * total row count. Equal peer ids keep the order of `parts`. The heap is
+   * allocated from the resource of `parts`; the result from `resource`.
+   */
+  PeerRows merge_peer_rows(
+      std::pmr::vector<PeerRows> parts,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  /** @brief Append the JSON object for one row (GET /peers item). */
+  void append_peer_row_json(std::string &out, const PeerRow &row, const Interner::Reader &names);
+
+  /**
+   * @brief Append one row as a JSON array, in peers_body_compact() column order.
+   * @param with_runtime Include the runtime column.
+   */
+  void append_peer_row_array(std::string &out, const PeerRow &row, const Interner::Reader &names, bool with_runtime);
+
+  /** @brief Full GET /peers body for the rows matching `filter`. */
+  std::string peers_body(const PeerRows &rows, const PeerFilter &filter = {});
+
+  /**
+   * @brief GET /peers?compact=1 body: the column names once, then one array per row.
+   *
+   * Same values as peers_body(). The runtime column is present only when
+   * some row carries a runtime.
+   */
+  std::string peers_body_compact(const PeerRows &rows, const PeerFilter &filter = {});
+
+  /**
+   * @brief GET /peers.arrow body: Arrow IPC stream of the matching rows.
+   *
+   * state, scheme, handshake_stage and runtime are dictionary-encoded;
+   * the other columns are plain. One record batch per `batch_rows` rows
+   * (0 = a single batch); an empty selection still yields one empty batch.
+   */
+  std::string peers_arrow(const PeerRows &rows, const PeerFilter &filter = {}, std::size_t batch_rows = 65536);
+
+  /**
+   * @brief GET /peers?format=ndjson|csv: the matching rows, written to `sink`.
+   *
+   * Same columns as peers_arrow(). Output goes out in blocks of a few KB
+   * and the intern table is only locked while a block is formatted.
+   * @return false when the sink stopped the export.
+   */
+  bool export_peers(const PeerRows &rows, const PeerFilter &filter, ExportFormat format, const ChunkSink &sink);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_PEER_INDEX_HPP
@@ -0,0 +1,327 @@
+/**
+ *
+ *  @file PeerJournal.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "PeerJournal.hpp"
+#include "JsonWrite.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    // Rough per-row cost of the hash map node plus the key strings.
+    constexpr std::size_t k_row_node_bytes = sizeof(PeerRow) + 48;
+
+    // Waiters re-check for changes (and refresh) at this pace.
+    constexpr auto k_wait_step = std::chrono::milliseconds(250);
+  }
+
+  bool PeerJournal::same(const PeerRow &a, const PeerRow &b) noexcept
+  {
+    return a.state == b.state &&
+           a.has_endpoint == b.has_endpoint &&
+           a.scheme == b.scheme &&
+           a.host == b.host &&
+           a.port == b.port &&
+           a.secure == b.secure &&
+           a.capabilities_count == b.capabilities_count &&
+           a.public_key_fp == b.public_key_fp &&
+           a.session_key_fp == b.session_key_fp &&
+           a.has_handshake == b.has_handshake &&
+           a.handshake_stage == b.handshake_stage &&
+           a.nonce_a == b.nonce_a &&
+           a.nonce_b == b.nonce_b;
+  }
+
+  void PeerJournal::reset(Source source, std::size_t max_changes)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    source_ = std::move(source);
+    max_changes_ = max_changes == 0 ? 1 : max_changes;
+
+    rows_.clear();
+    changes_.clear();
+
+    // A new epoch forces every consumer through a full snapshot, also
+    // across process restarts (wall clock based).
+    const auto now_ms = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    epoch_ = std::max(epoch_ + 1, now_ms);
+    gen_ = 0;
+    floor_ = 0;
+
+    primed_ = false;
+    closed_ = false;
+    refreshed_at_ = {};
+  }
+
+  void PeerJournal::refresh(std::chrono::milliseconds min_age)
+  {
+    Source source;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      const auto now = std::chrono::steady_clock::now();
+      if (refreshing_ || !source_ || (primed_ && now - refreshed_at_ < min_age))
+        return;
+      refreshing_ = true;
+      source = source_;
+    }
+
+    // Snapshot without the lock; readers keep using the previous rows.
+    std::optional<PeerRows> fresh = source();
+
+    std::lock_guard<std::mutex> lock(mu_);
+    refreshing_ = false;
+    refreshed_at_ = std::chrono::steady_clock::now();
+    if (!fresh)
+    {
+      cv_.notify_all();
+      return;
+    }
+
+    std::unordered_map<std::uint64_t, PeerRow> next;
+    next.reserve(fresh->size());
+    for (auto &r : *fresh)
+    {
+      const std::uint64_t key = key_of(r);
+      next.emplace(key, std::move(r));
+    }
+
+    if (!primed_)
+    {
+      primed_ = true;
+      rows_ = std::move(next);
+      gen_ = floor_ = 1;
+      cv_.notify_all();
+      return;
+    }
+
+    const std::uint64_t gen = gen_ + 1;
+    bool changed = false;
+
+    for (const auto &[key, row] : next)
+    {
+      const auto it = rows_.find(key);
+      if (it == rows_.end() || !same(it->second, row))
+      {
+        changes_.push_back(Change{gen, key});
+        changed = true;
+      }
+    }
+    for (const auto &[key, row] : rows_)
+    {
+      (void)row;
+      if (next.find(key) == next.end())
+      {
+        changes_.push_back(Change{gen, key});
+        changed = true;
+      }
+    }
+
+    rows_ = std::move(next);
+    if (changed)
+    {
+      gen_ = gen;
+      trim_locked(max_changes_);
+    }
+    cv_.notify_all();
+  }
+
+  int PeerJournal::delta(std::uint64_t epoch, std::uint64_t since, std::chrono::milliseconds wait, std::string &body,
+                         const std::function<bool()> &stop_waiting)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + wait;
+
+    refresh(k_wait_step);
+
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;)
+    {
+      if (!primed_)
+      {
+        body = R"({"error":"p2p_node_unavailable","ok":false})";
+        return 503;
+      }
+
+      // Unknown epoch or a cursor the journal no longer covers: snapshot.
+      if (epoch != epoch_ || since < floor_ || since > gen_)
+      {
+        snapshot_body_locked(body);
+        return 200;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      if (gen_ > since || closed_ || now >= deadline || (stop_waiting && stop_waiting()))
+        break;
+
+      cv_.wait_until(lock, std::min(deadline, now + k_wait_step));
+
+      lock.unlock();
+      refresh(k_wait_step);
+      lock.lock();
+    }
+
+    delta_body_locked(since, body);
+    return 200;
+  }
+
+  void PeerJournal::release_waiters()
+  {
+    // Under the lock: a waiter is either before its check or in wait_until().
+    std::lock_guard<std::mutex> lock(mu_);
+    cv_.notify_all();
+  }
+
+  void PeerJournal::close()
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+  std::size_t PeerJournal::bytes() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    return rows_.size() * k_row_node_bytes + changes_.size() * sizeof(Change);
+  }
+
+  std::size_t PeerJournal::shrink(std::size_t want)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    const std::size_t drop = std::min(changes_.size(), (want + sizeof(Change) - 1) / sizeof(Change));
+    const std::size_t before = changes_.size();
+    trim_locked(changes_.size() - drop);
+    changes_.shrink_to_fit();
+    return (before - changes_.size()) * sizeof(Change);
+  }
+
+  void PeerJournal::append_symbols(std::vector<Symbol> &out) const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    out.reserve(out.size() + rows_.size() * 4 + changes_.size() * 2);
+    for (const auto &[key, row] : rows_)
+    {
+      (void)key;
+      append_row_symbols(row, out);
+    }
+    // Keys of removed rows are still sent to consumers behind them.
+    for (const Change &c : changes_)
+    {
+      out.push_back(static_cast<Symbol>(c.key >> 32));
+      out.push_back(static_cast<Symbol>(c.key & 0xffffffffu));
+    }
+  }
+
+  void PeerJournal::trim_locked(std::size_t keep)
+  {
+    while (changes_.size() > keep)
+    {
+      floor_ = changes_.front().gen;
+      changes_.pop_front();
+    }
+  }
+
+  void PeerJournal::snapshot_body_locked(std::string &body) const
+  {
+    constexpr std::size_t k_row_bytes_hint = 448;
+
+    const auto names = interner().reader();
+
+    std::vector<const PeerRow *> order;
+    order.reserve(rows_.size());
+    for (const auto &[key, row] : rows_)
+    {
+      (void)key;
+      order.push_back(&row);
+    }
+    std::sort(order.begin(), order.end(), [&](const PeerRow *a, const PeerRow *b)
+              {
+                const auto ia = names.view(a->peer_id);
+                const auto ib = names.view(b->peer_id);
+                return ia != ib ? ia < ib : names.view(a->runtime) < names.view(b->runtime);
+              });
+
+    body.clear();
+    body.reserve(96 + order.size() * k_row_bytes_hint);
+    body.append("{\"epoch\":");
+    append_json_int(body, static_cast<long long>(epoch_));
+    body.append(",\"gen\":");
+    append_json_int(body, static_cast<long long>(gen_));
+    body.append(",\"ok\":true,\"peers\":[");
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+      if (i > 0)
+        body.push_back(',');
+      append_peer_row_json(body, *order[i], names);
+    }
+    body.append("],\"reset\":true}");
+  }
+
+  void PeerJournal::delta_body_locked(std::uint64_t since, std::string &body) const
+  {
+    const auto names = interner().reader();
+
+    // Newest first; a key changed several times is sent once, as it is now.
+    std::unordered_set<std::uint64_t> seen;
+    std::vector<const PeerRow *> upserts;
+    std::vector<std::uint64_t> removed;
+    for (auto it = changes_.rbegin(); it != changes_.rend() && it->gen > since; ++it)
+    {
+      if (!seen.insert(it->key).second)
+        continue;
+
+      const auto row = rows_.find(it->key);
+      if (row != rows_.end())
+        upserts.push_back(&row->second);
+      else
+        removed.push_back(it->key);
+    }
+
+    body.clear();
+    body.reserve(128 + upserts.size() * 448 + removed.size() * 64);
+    body.append("{\"epoch\":");
+    append_json_int(body, static_cast<long long>(epoch_));
+    body.append(",\"gen\":");
+    append_json_int(body, static_cast<long long>(gen_));
+    body.append(",\"ok\":true,\"removed\":[");
+    for (std::size_t i = 0; i < removed.size(); ++i)
+    {
+      if (i > 0)
+        body.push_back(',');
+      const auto runtime = static_cast<Symbol>(removed[i] >> 32);
+      body.append("{\"peer_id\":");
+      append_json_string(body, names.view(static_cast<Symbol>(removed[i] & 0xffffffffu)));
+      if (runtime != 0)
+      {
+        body.append(",\"runtime\":");
+        append_json_string(body, names.view(runtime));
+      }
+      body.push_back('}');
+    }
+    body.append("],\"reset\":false,\"upserts\":[");
+    for (std::size_t i = 0; i < upserts.size(); ++i)
+    {
+      if (i > 0)
+        body.push_back(',');
+      append_peer_row_json(body, *upserts[i], names);
+    }
+    body.append("]}");
+  }
+} // namespace vix::p2p_http::detail
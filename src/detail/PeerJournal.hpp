@@ -0,0 +1,121 @@
+/**
+ *
+ *  @file PeerJournal.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_PEER_JOURNAL_HPP
+#define VIX_P2P_HTTP_DETAIL_PEER_JOURNAL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PeerIndex.hpp"
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Change journal over successive peer snapshots (GET /peers/delta).
+   *
+   * Each refresh diffs a fresh snapshot against the previous one. Rows
+   * whose state, endpoint, handshake or keys changed, and rows that
+   * disappeared, are recorded under one new generation. Relative ages
+   * (last seen, handshake age) alone do not count as a change.
+   *
+   * A consumer holding generation `g` of epoch `e` gets only what changed
+   * after `g`; an unknown epoch or a generation the bounded journal no
+   * longer covers gets a full snapshot instead (reset).
+   */
+  class PeerJournal
+  {
+  public:
+    using Source = std::function<std::optional<PeerRows>()>;
+
+    /** @brief Set the snapshot source and start a new epoch. */
+    void reset(Source source, std::size_t max_changes);
+
+    /** @brief Diff a new snapshot in unless the last one is younger than `min_age`. */
+    void refresh(std::chrono::milliseconds min_age);
+
+    /**
+     * @brief GET /peers/delta body, waiting up to `wait` for a change after `since`.
+     *
+     * The wait also ends once `stop_waiting` returns true; it is checked
+     * on every wake-up, see release_waiters().
+     * @return HTTP status (503 while no snapshot could be taken).
+     */
+    int delta(std::uint64_t epoch, std::uint64_t since, std::chrono::milliseconds wait, std::string &body,
+              const std::function<bool()> &stop_waiting = {});
+
+    /** @brief Wake every waiter so it re-checks `stop_waiting` now (drain). */
+    void release_waiters();
+
+    /** @brief Release waiters and make further waits return at once (shutdown). */
+    void close();
+
+    /** @brief Approximate footprint (memory budget). */
+    std::size_t bytes() const;
+
+    /** @brief Drop the oldest changes; consumers behind them will reset. */
+    std::size_t shrink(std::size_t want);
+
+    /** @brief Append the Symbols held by rows and removed keys (interner roots). */
+    void append_symbols(std::vector<Symbol> &out) const;
+
+  private:
+    struct Change
+    {
+      std::uint64_t gen = 0;
+      std::uint64_t key = 0;
+    };
+
+    // Row identity: (runtime, peer_id) symbols.
+    static std::uint64_t key_of(const PeerRow &r) noexcept
+    {
+      return (static_cast<std::uint64_t>(r.runtime) << 32) | r.peer_id;
+    }
+
+    static bool same(const PeerRow &a, const PeerRow &b) noexcept;
+
+    void snapshot_body_locked(std::string &body) const;
+    void delta_body_locked(std::uint64_t since, std::string &body) const;
+    void trim_locked(std::size_t keep);
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+
+    Source source_;
+    std::size_t max_changes_ = 0;
+
+    std::unordered_map<std::uint64_t, PeerRow> rows_;
+    std::deque<Change> changes_;
+
+    std::uint64_t epoch_ = 0;
+    std::uint64_t gen_ = 0;
+    // Every change after floor_ is still in changes_.
+    std::uint64_t floor_ = 0;
+
+    bool primed_ = false;
+    bool refreshing_ = false;
+    bool closed_ = false;
+    std::chrono::steady_clock::time_point refreshed_at_{};
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_PEER_JOURNAL_HPP
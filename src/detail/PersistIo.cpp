@@ -0,0 +1,511 @@
+/**
+ *
+ *  @file PersistIo.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "PersistIo.hpp"
+#include "ThreadTuning.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VIX_P2P_HTTP_HAS_PERSIST_IO 1
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define VIX_P2P_HTTP_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+#if defined(VIX_P2P_HTTP_HAS_PERSIST_IO)
+    // pwrite() the whole range; 0 or errno.
+    int write_all(int fd, const char *data, std::size_t len, std::uint64_t offset, std::atomic<std::uint64_t> &syscalls)
+    {
+      std::size_t done = 0;
+      while (done < len)
+      {
+        syscalls.fetch_add(1, std::memory_order_relaxed);
+        const ssize_t n = ::pwrite(fd, data + done, len - done, (off_t)(offset + done));
+        if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return errno;
+        }
+        done += (std::size_t)n;
+      }
+      return 0;
+    }
+
+    int data_sync(int fd, std::atomic<std::uint64_t> &syscalls)
+    {
+      syscalls.fetch_add(1, std::memory_order_relaxed);
+#if defined(__APPLE__)
+      return ::fsync(fd) == 0 ? 0 : errno;
+#else
+      return ::fdatasync(fd) == 0 ? 0 : errno;
+#endif
+    }
+#else
+    int write_all(int, const char *, std::size_t, std::uint64_t, std::atomic<std::uint64_t> &)
+    {
+      return ENOSYS;
+    }
+
+    int data_sync(int, std::atomic<std::uint64_t> &)
+    {
+      return ENOSYS;
+    }
+#endif
+
+    // The writer's own thread does the I/O: the reference path.
+    class BlockingIo final : public PersistIo
+    {
+    public:
+      BlockingIo(std::size_t slots, std::size_t slot_bytes)
+          : PersistIo(slots, slot_bytes), errors_(slots, 0) {}
+
+      const char *name() const noexcept override { return "blocking"; }
+
+      void submit(int fd, std::size_t slot, std::size_t len, std::uint64_t offset, bool sync) override
+      {
+        int err = len > 0 ? write_all(fd, slot_data(slot), len, offset, syscalls_) : 0;
+        if (err == 0 && sync)
+          err = data_sync(fd, syscalls_);
+        errors_[slot] = err;
+      }
+
+      int wait(std::size_t slot) override
+      {
+        return std::exchange(errors_[slot], 0);
+      }
+
+    private:
+      std::vector<int> errors_;
+    };
+
+    // Fallback when io_uring is unavailable: a couple of workers take the
+    // blocking calls off the writer thread.
+    class ThreadPoolIo final : public PersistIo
+    {
+    public:
+      ThreadPoolIo(std::size_t slots, std::size_t slot_bytes, std::size_t threads)
+          : PersistIo(slots, slot_bytes), state_(slots)
+      {
+        for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i)
+          workers_.emplace_back([this, i]()
+                                { run(i); });
+      }
+
+      ~ThreadPoolIo() override
+      {
+        {
+          std::lock_guard<std::mutex> lock(mu_);
+          stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto &t : workers_)
+          t.join();
+      }
+
+      const char *name() const noexcept override { return "threads"; }
+
+      void submit(int fd, std::size_t slot, std::size_t len, std::uint64_t offset, bool sync) override
+      {
+        {
+          std::lock_guard<std::mutex> lock(mu_);
+          state_[slot].busy = true;
+          jobs_.push_back(Job{fd, slot, len, offset, sync, ++seq_});
+        }
+        work_cv_.notify_one();
+      }
+
+      int wait(std::size_t slot) override
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        done_cv_.wait(lock, [&]()
+                      { return !state_[slot].busy; });
+        return std::exchange(state_[slot].error, 0);
+      }
+
+    private:
+      struct Job
+      {
+        int fd;
+        std::size_t slot;
+        std::size_t len;
+        std::uint64_t offset;
+        bool sync;
+        std::uint64_t seq;
+      };
+
+      struct SlotState
+      {
+        bool busy = false;
+        int error = 0;
+      };
+
+      void run(std::size_t index)
+      {
+        const ThreadPolicyScope policy("persist_io/" + std::to_string(index));
+        for (;;)
+        {
+          Job job{};
+          {
+            std::unique_lock<std::mutex> lock(mu_);
+            work_cv_.wait(lock, [this]()
+                          { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty())
+              return;
+            job = jobs_.front();
+            jobs_.pop_front();
+            running_.push_back(job.seq);
+          }
+
+          int err = job.len > 0 ? write_all(job.fd, slot_data(job.slot), job.len, job.offset, syscalls_) : 0;
+          if (err == 0 && job.sync)
+          {
+            // Jobs are taken in order, so the earlier ones are all running
+            // on other workers: wait for them, they never wait for us.
+            {
+              std::unique_lock<std::mutex> lock(mu_);
+              done_cv_.wait(lock, [&]()
+                            { return std::none_of(running_.begin(), running_.end(), [&](std::uint64_t s)
+                                                  { return s < job.seq; }); });
+            }
+            err = data_sync(job.fd, syscalls_);
+          }
+
+          {
+            std::lock_guard<std::mutex> lock(mu_);
+            state_[job.slot].busy = false;
+            state_[job.slot].error = err;
+            running_.erase(std::find(running_.begin(), running_.end(), job.seq));
+          }
+          done_cv_.notify_all();
+        }
+      }
+
+      std::mutex mu_;
+      std::condition_variable work_cv_;
+      std::condition_variable done_cv_;
+      std::deque<Job> jobs_;
+      std::vector<std::uint64_t> running_;
+      std::uint64_t seq_ = 0;
+      std::vector<SlotState> state_;
+      std::vector<std::thread> workers_;
+      bool stop_ = false;
+    };
+
+#if defined(VIX_P2P_HTTP_HAS_IO_URING)
+    int sys_io_uring_setup(unsigned entries, io_uring_params *p)
+    {
+      return (int)::syscall(__NR_io_uring_setup, entries, p);
+    }
+
+    int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+      return (int)::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+    }
+
+    int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args)
+    {
+      return (int)::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+    }
+
+    // Raw io_uring, no liburing: one ring, the slots registered as fixed
+    // buffers, WRITE_FIXED linked to a draining FSYNC(DATASYNC). Only the
+    // writer thread touches the ring, so there is no locking.
+    class IoUringIo final : public PersistIo
+    {
+    public:
+      IoUringIo(std::size_t slots, std::size_t slot_bytes)
+          : PersistIo(slots, slot_bytes), state_(slots) {}
+
+      ~IoUringIo() override
+      {
+        if (ring_fd_ < 0)
+          return;
+        if (ready_)
+          drain();
+        if (sqes_)
+          ::munmap(sqes_, sqes_bytes_);
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+          ::munmap(cq_ptr_, cq_bytes_);
+        if (sq_ptr_)
+          ::munmap(sq_ptr_, sq_bytes_);
+        ::close(ring_fd_);
+      }
+
+      // 0, or errno of the step that failed.
+      int init()
+      {
+        // Two entries per slot (write + sync) covers every slot in flight.
+        io_uring_params p{};
+        ring_fd_ = sys_io_uring_setup((unsigned)(slots_ * 2), &p);
+        if (ring_fd_ < 0)
+          return errno;
+
+        sq_bytes_ = p.sq_off.array + p.sq_entries * sizeof(std::uint32_t);
+        cq_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+          sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+
+        sq_ptr_ = ::mmap(nullptr, sq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED)
+        {
+          sq_ptr_ = nullptr;
+          return errno;
+        }
+        cq_ptr_ = single ? sq_ptr_
+                         : ::mmap(nullptr, cq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED)
+        {
+          cq_ptr_ = nullptr;
+          return errno;
+        }
+        sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+          return errno;
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<char *>(sq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+
+        auto *cq = static_cast<char *>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+        // Registered once: the kernel pins the pages and skips the per-I/O
+        // page mapping that plain writes pay.
+        std::vector<iovec> iov(slots_);
+        for (std::size_t i = 0; i < slots_; ++i)
+        {
+          iov[i].iov_base = slot_data(i);
+          iov[i].iov_len = slot_bytes_;
+        }
+        if (sys_io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, iov.data(), (unsigned)iov.size()) != 0)
+          return errno;
+        ready_ = true;
+        return 0;
+      }
+
+      const char *name() const noexcept override { return "io_uring"; }
+
+      void submit(int fd, std::size_t slot, std::size_t len, std::uint64_t offset, bool sync) override
+      {
+        SlotState &st = state_[slot];
+        st.error = 0;
+        st.len = len;
+
+        unsigned tail = *sq_tail_;
+        auto push = [&](io_uring_sqe &e)
+        {
+          const unsigned idx = tail & sq_mask_;
+          sqes_[idx] = e;
+          sq_array_[idx] = idx;
+          ++tail;
+          ++st.pending;
+        };
+
+        if (len > 0)
+        {
+          io_uring_sqe w{};
+          w.opcode = IORING_OP_WRITE_FIXED;
+          w.fd = fd;
+          w.off = offset;
+          w.addr = reinterpret_cast<std::uint64_t>(slot_data(slot));
+          w.len = (std::uint32_t)len;
+          w.buf_index = (std::uint16_t)slot;
+          w.flags = sync ? IOSQE_IO_LINK : 0;
+          w.user_data = slot * 2;
+          push(w);
+        }
+        if (sync)
+        {
+          io_uring_sqe f{};
+          f.opcode = IORING_OP_FSYNC;
+          f.fd = fd;
+          f.fsync_flags = IORING_FSYNC_DATASYNC;
+          // DRAIN: also wait for the writes of other slots still in flight.
+          f.flags = IOSQE_IO_DRAIN;
+          f.user_data = slot * 2 + 1;
+          push(f);
+        }
+
+        unsubmitted_ += tail - *sq_tail_;
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+        enter(0);
+      }
+
+      int wait(std::size_t slot) override
+      {
+        SlotState &st = state_[slot];
+        reap();
+        while (st.pending > 0)
+        {
+          if (enter(1) < 0 && errno != EINTR)
+          {
+            // The ring itself failed; nothing more will complete.
+            st.error = errno;
+            st.pending = 0;
+            break;
+          }
+          reap();
+        }
+        return std::exchange(st.error, 0);
+      }
+
+    private:
+      struct SlotState
+      {
+        unsigned pending = 0;
+        std::size_t len = 0;
+        int error = 0;
+      };
+
+      // Submits what the kernel has not taken yet; entries it refused
+      // (EAGAIN, EBUSY) go again with the next call.
+      int enter(unsigned min_complete)
+      {
+        syscalls_.fetch_add(1, std::memory_order_relaxed);
+        const int rc = sys_io_uring_enter(ring_fd_, unsubmitted_, min_complete,
+                                          min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (rc > 0)
+          unsubmitted_ -= std::min<unsigned>(unsubmitted_, (unsigned)rc);
+        return rc;
+      }
+
+      void reap()
+      {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+          const io_uring_cqe &c = cqes_[head & cq_mask_];
+          SlotState &st = state_[c.user_data / 2];
+          const bool is_write = (c.user_data & 1) == 0;
+          if (st.error == 0)
+          {
+            if (c.res < 0)
+              st.error = -c.res;
+            else if (is_write && (std::size_t)c.res != st.len)
+              st.error = EIO; // short write (disk full)
+          }
+          if (st.pending > 0)
+            --st.pending;
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      }
+
+      std::vector<SlotState> state_;
+      bool ready_ = false;
+      unsigned unsubmitted_ = 0;
+
+      int ring_fd_ = -1;
+      void *sq_ptr_ = nullptr;
+      void *cq_ptr_ = nullptr;
+      std::size_t sq_bytes_ = 0;
+      std::size_t cq_bytes_ = 0;
+      std::size_t sqes_bytes_ = 0;
+      io_uring_sqe *sqes_ = nullptr;
+      unsigned *sq_tail_ = nullptr;
+      unsigned *sq_array_ = nullptr;
+      unsigned sq_mask_ = 0;
+      unsigned *cq_head_ = nullptr;
+      unsigned *cq_tail_ = nullptr;
+      unsigned cq_mask_ = 0;
+      io_uring_cqe *cqes_ = nullptr;
+    };
+#endif
+
+    constexpr std::size_t k_pool_threads = 2;
+  }
+
+  bool parse_persist_io(std::string_view text, PersistIoKind &out) noexcept
+  {
+    if (text.empty() || text == "auto")
+      out = PersistIoKind::Auto;
+    else if (text == "io_uring")
+      out = PersistIoKind::IoUring;
+    else if (text == "threads")
+      out = PersistIoKind::Threads;
+    else if (text == "blocking")
+      out = PersistIoKind::Blocking;
+    else
+      return false;
+    return true;
+  }
+
+  PersistIo::PersistIo(std::size_t slots, std::size_t slot_bytes)
+      : slots_(std::max<std::size_t>(slots, 1)),
+        slot_bytes_(std::max<std::size_t>(slot_bytes, 4096)),
+        data_(new char[slots_ * slot_bytes_])
+  {
+  }
+
+  int PersistIo::drain()
+  {
+    int first = 0;
+    for (std::size_t i = 0; i < slots_; ++i)
+    {
+      const int err = wait(i);
+      if (first == 0)
+        first = err;
+    }
+    return first;
+  }
+
+  std::unique_ptr<PersistIo> make_persist_io(PersistIoKind kind, std::size_t slots, std::size_t slot_bytes,
+                                             std::string &note)
+  {
+    note.clear();
+    if (kind == PersistIoKind::Blocking)
+      return std::make_unique<BlockingIo>(slots, slot_bytes);
+
+    if (kind == PersistIoKind::Auto || kind == PersistIoKind::IoUring)
+    {
+#if defined(VIX_P2P_HTTP_HAS_IO_URING)
+      auto ring = std::make_unique<IoUringIo>(slots, slot_bytes);
+      if (const int err = ring->init(); err == 0)
+        return ring;
+      else
+        note = std::string("io_uring unavailable (") + std::strerror(err) + "), using threads";
+#else
+      note = "io_uring not compiled in, using threads";
+#endif
+    }
+    return std::make_unique<ThreadPoolIo>(slots, slot_bytes, k_pool_threads);
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,98 @@
+/**
+ *
+ *  @file PersistIo.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_PERSIST_IO_HPP
+#define VIX_P2P_HTTP_DETAIL_PERSIST_IO_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace vix::p2p_http::detail
+{
+  enum class PersistIoKind
+  {
+    /** @brief io_uring when the kernel allows it, else Threads. */
+    Auto,
+    IoUring,
+    Threads,
+    /** @brief pwrite()/fdatasync() on the calling thread. */
+    Blocking,
+  };
+
+  /** @brief "auto", "io_uring", "threads" or "blocking"; false when unknown. */
+  bool parse_persist_io(std::string_view text, PersistIoKind &out) noexcept;
+
+  /**
+   * @brief Write path of the persistence writers.
+   *
+   * The backend owns `slots()` buffers of `slot_bytes()` each. A writer
+   * fills a slot, submit()s it, and moves on to the next one; wait() on a
+   * slot returns once its previous submission completed, so the buffer can
+   * be reused. Writes carry their file offset, so completion order does not
+   * matter.
+   */
+  class PersistIo
+  {
+  public:
+    virtual ~PersistIo() = default;
+
+    virtual const char *name() const noexcept = 0;
+
+    std::size_t slots() const noexcept { return slots_; }
+    std::size_t slot_bytes() const noexcept { return slot_bytes_; }
+    char *slot_data(std::size_t slot) noexcept { return data_.get() + slot * slot_bytes_; }
+
+    /**
+     * @brief Queue `len` bytes of `slot` at `offset`, then a data sync when
+     * `sync`.
+     *
+     * The sync starts once this write and every earlier submission
+     * completed, so it covers them all. `len` 0 with `sync` queues the sync
+     * alone. The slot must be free.
+     */
+    virtual void submit(int fd, std::size_t slot, std::size_t len, std::uint64_t offset, bool sync) = 0;
+
+    /** @brief Wait for `slot`; 0, or the errno of its first failed operation. */
+    virtual int wait(std::size_t slot) = 0;
+
+    /** @brief Wait for every slot. Returns the first error seen, as wait(). */
+    int drain();
+
+    /** @brief Kernel entries made (writes, syncs or ring submissions). */
+    std::uint64_t syscalls() const noexcept { return syscalls_.load(std::memory_order_relaxed); }
+
+  protected:
+    PersistIo(std::size_t slots, std::size_t slot_bytes);
+
+    std::size_t slots_;
+    std::size_t slot_bytes_;
+    std::unique_ptr<char[]> data_;
+    std::atomic<std::uint64_t> syscalls_{0};
+  };
+
+  /**
+   * @brief Build the backend for `kind`.
+   *
+   * IoUring falls back to Threads when io_uring is not compiled in or the
+   * kernel refuses it (old kernel, seccomp, io_uring_disabled); `note`
+   * then says why. Never returns null.
+   */
+  std::unique_ptr<PersistIo> make_persist_io(PersistIoKind kind, std::size_t slots, std::size_t slot_bytes,
+                                             std::string &note);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_PERSIST_IO_HPP
@@ -0,0 +1,83 @@
+/**
+ *
+ *  @file RouteMetrics.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "RouteMetrics.hpp"
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    RouteCounters g_routes[static_cast<std::size_t>(RouteId::Count)];
+    std::atomic<std::uint64_t> g_in_flight{0};
+    std::atomic<bool> g_draining{false};
+  }
+
+  const char *route_name(RouteId id) noexcept
+  {
+    switch (id)
+    {
+    case RouteId::Ping:    return "ping";
+    case RouteId::Status:  return "status";
+    case RouteId::Ready:   return "ready";
+    case RouteId::Peers:   return "peers";
+    case RouteId::Connect: return "connect";
+    case RouteId::Logs:    return "logs";
+    case RouteId::Config:  return "config";
+    case RouteId::Admin:   return "admin";
+    case RouteId::Debug:   return "debug";
+    default:               return "unknown";
+    }
+  }
+
+  RouteCounters &route_counters(RouteId id) noexcept
+  {
+    return g_routes[static_cast<std::size_t>(id)];
+  }
+
+  std::uint64_t in_flight() noexcept
+  {
+    return g_in_flight.load(std::memory_order_relaxed);
+  }
+
+  bool draining() noexcept
+  {
+    return g_draining.load(std::memory_order_acquire);
+  }
+
+  void set_draining(bool on) noexcept
+  {
+    g_draining.store(on, std::memory_order_release);
+  }
+
+  InFlight::InFlight(RouteId id) noexcept
+      : c_(route_counters(id)), start_(std::chrono::steady_clock::now())
+  {
+    g_in_flight.fetch_add(1, std::memory_order_relaxed);
+    c_.requests.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  InFlight::~InFlight()
+  {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start_)
+                        .count();
+    c_.total_us.fetch_add(static_cast<std::uint64_t>(us), std::memory_order_relaxed);
+    g_in_flight.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void InFlight::reject() noexcept
+  {
+    c_.rejected.fetch_add(1, std::memory_order_relaxed);
+  }
+} // namespace vix::p2p_http::detail
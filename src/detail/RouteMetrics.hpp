@@ -0,0 +1,82 @@
+/**
+ *
+ *  @file RouteMetrics.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_ROUTE_METRICS_HPP
+#define VIX_P2P_HTTP_DETAIL_ROUTE_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace vix::p2p_http::detail
+{
+  /** @brief Routes tracked by the module metrics. */
+  enum class RouteId : std::uint8_t
+  {
+    Ping,
+    Status,
+    Ready,
+    Peers,
+    Connect,
+    Logs,
+    Config,
+    Admin,
+    Debug,
+    Count
+  };
+
+  /** @brief Stable metric name for a route. */
+  const char *route_name(RouteId id) noexcept;
+
+  /** @brief Lock-free per-route counters. */
+  struct RouteCounters
+  {
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> rejected{0};
+    std::atomic<std::uint64_t> total_us{0};
+  };
+
+  RouteCounters &route_counters(RouteId id) noexcept;
+
+  /** @brief Requests currently executing a p2p_http handler. */
+  std::uint64_t in_flight() noexcept;
+
+  bool draining() noexcept;
+  void set_draining(bool on) noexcept;
+
+  /**
+   * @brief RAII in-flight tracker placed at the top of each handler.
+   *
+   * Counts the request, keeps the in-flight gauge and accumulates the
+   * handler latency on exit.
+   */
+  class InFlight
+  {
+  public:
+    explicit InFlight(RouteId id) noexcept;
+    ~InFlight();
+
+    InFlight(const InFlight &) = delete;
+    InFlight &operator=(const InFlight &) = delete;
+
+    /** @brief Mark the request as rejected (drain, rate limit, ...). */
+    void reject() noexcept;
+
+  private:
+    RouteCounters &c_;
+    std::chrono::steady_clock::time_point start_;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_ROUTE_METRICS_HPP
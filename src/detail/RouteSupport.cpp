@@ -0,0 +1,174 @@
+/**
+ *
+ *  @file RouteSupport.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "RouteSupport.hpp"
+#include "RouteMetrics.hpp"
+#include "RouteTable.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#if defined(VIX_P2P_HTTP_WITH_MIDDLEWARE)
+#include <vix/middleware/app/adapter.hpp>
+#include <vix/middleware/app/presets.hpp>
+#include <vix/middleware/middleware.hpp>
+#endif
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  std::string base_prefix(const P2PHttpOptions &opt)
+  {
+    return opt.prefix.empty() ? std::string{"/p2p"} : opt.prefix;
+  }
+
+  std::string join_prefix(std::string base, std::string path)
+  {
+    if (!base.empty() && base.front() != '/')
+      base.insert(base.begin(), '/');
+    while (base.size() > 1 && base.back() == '/')
+      base.pop_back();
+
+    if (!path.empty() && path.front() != '/')
+      path.insert(path.begin(), '/');
+    while (path.size() > 1 && path.back() == '/')
+      path.pop_back();
+
+    if (base.empty())
+      return path.empty() ? std::string{"/"} : path;
+
+    if (path.empty() || path == "/")
+      return base;
+
+    return base + path;
+  }
+
+  // Fallback auth (no middleware): module-local.
+  bool legacy_auth_or_401(
+      const P2PHttpOptions &opt,
+      vix::http::Request &req,
+      vix::http::ResponseWrapper &res)
+  {
+    if (!opt.auth_legacy)
+    {
+      res.status(401).json(J::obj({
+          "ok",
+          false,
+          "error",
+          "unauthorized",
+          "hint",
+          "auth required",
+      }));
+      return false;
+    }
+
+    return opt.auth_legacy(req, res);
+  }
+
+  void reply_draining(vix::http::ResponseWrapper &res)
+  {
+    RouteReply out;
+    reply_draining(out);
+    send_reply(res, out);
+  }
+
+  bool legacy_route_guard(
+      const P2PHttpOptions &opt,
+      RouteOptions ro,
+      vix::http::Request &req,
+      vix::http::ResponseWrapper &res)
+  {
+    if (ro.reject_when_draining && draining())
+    {
+      reply_draining(res);
+      return false;
+    }
+    if (ro.require_auth)
+    {
+      if (!legacy_auth_or_401(opt, req, res))
+        return false;
+    }
+    if (ro.heavy)
+      res.header("x-vix-route-heavy", "1");
+    return true;
+  }
+
+#if defined(VIX_P2P_HTTP_WITH_MIDDLEWARE)
+  // Route-level middleware install.
+  void install_route_middlewares(
+      vix::App &app,
+      const std::string &path,
+      vix::p2p_http::RouteOptions ro,
+      const P2PHttpOptions &opt,
+      std::optional<RouteId> id)
+  {
+    using namespace vix::middleware::app;
+
+    if (!ro.heavy && !ro.require_auth && !ro.reject_when_draining)
+      return;
+
+    // Drain check, auth hook and heavy tag in one Context middleware.
+    auto guard_ctx = [opt, ro, id](vix::mw::Context &ctx, vix::mw::Next next) mutable
+    {
+      // Same counters the handler's InFlight would have updated.
+      auto count_rejected = [id]()
+      {
+        if (id)
+          InFlight(*id).reject();
+      };
+
+      if (ro.reject_when_draining && draining())
+      {
+        count_rejected();
+        reply_draining(ctx.res());
+        return;
+      }
+
+      if (ro.require_auth)
+      {
+        if (!opt.auth_ctx)
+        {
+          count_rejected();
+          ctx.res().status(401).json(J::obj({
+              "ok",
+              false,
+              "error",
+              "unauthorized",
+              "hint",
+              "auth required",
+          }));
+          return;
+        }
+
+        const bool ok = opt.auth_ctx(ctx);
+        if (!ok)
+        {
+          count_rejected();
+          return;
+        }
+      }
+
+      if (ro.heavy)
+        ctx.res().header("x-vix-route-heavy", "1");
+
+      next();
+    };
+
+    install_exact(app, path, adapt_ctx(guard_ctx));
+  }
+#endif
+} // namespace vix::p2p_http::detail
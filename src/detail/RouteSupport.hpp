@@ -0,0 +1,84 @@
+/**
+ *
+ *  @file RouteSupport.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_ROUTE_SUPPORT_HPP
+#define VIX_P2P_HTTP_DETAIL_ROUTE_SUPPORT_HPP
+
+#include <optional>
+#include <string>
+
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+#include <vix/p2p_http/RouteOptions.hpp>
+
+#include "RouteMetrics.hpp"
+
+namespace vix
+{
+  class App;
+}
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Resolve the route prefix (defaults to "/p2p").
+   */
+  std::string base_prefix(const P2PHttpOptions &opt);
+
+  /**
+   * @brief Join a base prefix and a route path, normalizing slashes.
+   */
+  std::string join_prefix(std::string base, std::string path);
+
+  /**
+   * @brief Fallback auth (no middleware): reply 401 when no legacy hook is set.
+   */
+  bool legacy_auth_or_401(
+      const P2PHttpOptions &opt,
+      vix::http::Request &req,
+      vix::http::ResponseWrapper &res);
+
+  /**
+   * @brief Reply 503 to new work while the node is draining.
+   */
+  void reply_draining(vix::http::ResponseWrapper &res);
+
+  /**
+   * @brief Apply route options inline when middleware is not available.
+   *
+   * Rejects drainable routes while draining, runs the legacy auth hook
+   * and tags heavy routes. Returns false when the request has already
+   * been answered.
+   */
+  bool legacy_route_guard(
+      const P2PHttpOptions &opt,
+      RouteOptions ro,
+      vix::http::Request &req,
+      vix::http::ResponseWrapper &res);
+
+#if defined(VIX_P2P_HTTP_WITH_MIDDLEWARE)
+  /**
+   * @brief Route-level middleware install (drain check + auth hook + heavy tag).
+   *
+   * The handler never runs for a request turned away here, so with `id`
+   * set the middleware counts it as a request and a rejection itself.
+   */
+  void install_route_middlewares(
+      vix::App &app,
+      const std::string &path,
+      RouteOptions ro,
+      const P2PHttpOptions &opt,
+      std::optional<RouteId> id = std::nullopt);
+#endif
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_ROUTE_SUPPORT_HPP
@@ -0,0 +1,195 @@
+/**
+ *
+ *  @file RouteTable.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "RouteTable.hpp"
+#include "LocalHttp.hpp"
+#include "RouteSupport.hpp"
+#include "RouteUnits.hpp"
+
+#include <vix/app/App.hpp>
+#include <vix/http/RequestHandler.hpp>
+#include <vix/http/Response.hpp>
+#include <vix/json/json.hpp>
+
+#include <memory>
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    class AppRequest final : public RouteRequest
+    {
+    public:
+      explicit AppRequest(vix::http::Request &req) : req_(req), body_(req.body()) {}
+
+      std::string query(const char *name) const override { return req_.query_value(name, ""); }
+      const std::string &body() const override { return body_; }
+
+    private:
+      vix::http::Request &req_;
+      std::string body_;
+    };
+
+    class SocketRequest final : public RouteRequest
+    {
+    public:
+      explicit SocketRequest(const LocalRequest &req) : req_(req) {}
+
+      std::string query(const char *name) const override { return req_.query_value(name); }
+      const std::string &body() const override { return req_.body; }
+
+    private:
+      const LocalRequest &req_;
+    };
+
+  }
+
+  // The App sends whole bodies: a streamed reply is gathered here.
+  void send_reply(vix::http::ResponseWrapper &res, RouteReply &out)
+  {
+    for (const auto &[name, value] : out.headers)
+      res.header(name, value);
+
+    std::string body = std::move(out.body);
+    if (out.stream)
+      out.stream([&body](std::string_view block)
+                 { body.append(block); return true; });
+
+    res.status(out.status).type(out.type);
+    res.send(std::move(body));
+  }
+
+  namespace
+  {
+    void to_local_reply(RouteReply &out, RouteId id, LocalResponse &res)
+    {
+      res.status = out.status;
+      res.type = std::move(out.type);
+      res.body = std::move(out.body);
+      res.headers = std::move(out.headers);
+      if (out.stream)
+      {
+        res.stream = [stream = std::move(out.stream), id](const LocalChunkWriter &write)
+        {
+          InFlight streaming(id);
+          stream(write);
+        };
+      }
+    }
+
+    template <typename Handler>
+    void app_route(vix::App &app, const std::string &method, const std::string &path, Handler h)
+    {
+      if (method == "POST")
+        app.post(path, std::move(h));
+      else if (method == "PATCH")
+        app.patch(path, std::move(h));
+      else if (method == "PUT")
+        app.put(path, std::move(h));
+      else
+        app.get(path, std::move(h));
+    }
+  }
+
+  void reply_json(RouteReply &out, int status, const J::Json &body)
+  {
+    out.status = status;
+    out.type = "application/json";
+    out.body = body.dump();
+  }
+
+  void reply_draining(RouteReply &out)
+  {
+    out.headers.emplace_back("retry-after", "1");
+    reply_json(out, 503, J::Json{
+                             {"ok", false},
+                             {"error", "draining"},
+                             {"hint", "node is draining, retry on another node"},
+                         });
+  }
+
+  void reply_route_disabled(RouteReply &out)
+  {
+    reply_json(out, 404, J::Json{{"ok", false}, {"error", "route_disabled"}});
+  }
+
+  void mount_route(Registration &reg, RouteSpec spec)
+  {
+    auto s = std::make_shared<const RouteSpec>(std::move(spec));
+
+    {
+      const P2PHttpOptions opt = reg.opt;
+      app_route(reg.app, s->method, s->path, [s, opt](vix::http::Request &req, vix::http::ResponseWrapper &res)
+                {
+        InFlight track(s->id);
+        if (s->touch)
+          lazy_touch();
+#if !defined(VIX_P2P_HTTP_WITH_MIDDLEWARE)
+        if (!legacy_route_guard(opt, s->ro, req, res))
+        {
+          track.reject();
+          return;
+        }
+#else
+        (void)opt;
+#endif
+
+        RouteReply out;
+        if (s->enabled && !s->enabled(*live_config()))
+          reply_route_disabled(out);
+        else
+        {
+          const AppRequest r(req);
+          s->handler(r, out);
+          if (out.rejected)
+            track.reject();
+        }
+        send_reply(res, out); });
+
+#if defined(VIX_P2P_HTTP_WITH_MIDDLEWARE)
+      install_route_middlewares(reg.app, s->path, s->ro, reg.opt, s->id);
+#endif
+    }
+
+    if (!reg.socket)
+      return;
+
+    reg.socket->route(s->method, s->path, [s](const LocalRequest &req, LocalResponse &res)
+                      {
+      InFlight track(s->id);
+      if (s->touch)
+        lazy_touch();
+
+      RouteReply out;
+      if (s->ro.reject_when_draining && draining())
+      {
+        track.reject();
+        reply_draining(out);
+      }
+      else if (s->enabled && !s->enabled(*live_config()))
+        reply_route_disabled(out);
+      else
+      {
+        if (s->ro.heavy)
+          out.headers.emplace_back("x-vix-route-heavy", "1");
+        const SocketRequest r(req);
+        s->handler(r, out);
+        if (out.rejected)
+          track.reject();
+      }
+      to_local_reply(out, s->id, res); });
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,106 @@
+/**
+ *
+ *  @file RouteTable.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_ROUTE_TABLE_HPP
+#define VIX_P2P_HTTP_DETAIL_ROUTE_TABLE_HPP
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vix/http/RequestHandler.hpp>
+#include <vix/p2p_http/RouteOptions.hpp>
+
+#include "LiveConfig.hpp"
+#include "RouteMetrics.hpp"
+#include "RowExport.hpp"
+
+namespace vix::p2p_http::detail
+{
+  class Registration;
+
+  /** @brief Request as a route handler sees it, on the App or the admin socket. */
+  class RouteRequest
+  {
+  public:
+    virtual ~RouteRequest() = default;
+
+    /** @brief Decoded query parameter, "" when absent. */
+    virtual std::string query(const char *name) const = 0;
+
+    virtual const std::string &body() const = 0;
+  };
+
+  /** @brief Reply filled by a route handler; each listener sends it its own way. */
+  struct RouteReply
+  {
+    int status = 200;
+    std::string type = "application/json";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    /**
+     * @brief Body produced in blocks, used instead of `body` when set.
+     *
+     * Streamed as chunks on the admin socket; the App sends whole bodies,
+     * so it gathers the blocks first. Runs after the handler returned.
+     */
+    std::function<bool(const ChunkSink &)> stream;
+
+    /** @brief Turned away before doing any work (counted as rejected). */
+    bool rejected = false;
+  };
+
+  using RouteHandler = std::function<void(const RouteRequest &, RouteReply &)>;
+
+  /**
+   * @brief One route, mounted on every listener from the same definition.
+   *
+   * The wrapper counts the request, answers 503 on drainable routes while
+   * draining, checks auth (App only: the socket file mode is its access
+   * control) and the live toggle, then runs `handler`.
+   */
+  struct RouteSpec
+  {
+    std::string method = "GET";
+    std::string path;
+    RouteId id = RouteId::Ping;
+    RouteOptions ro;
+
+    /** @brief Call lazy_touch() first (routes that read logs or runtime state). */
+    bool touch = false;
+
+    /** @brief PATCH /config toggle; 404 route_disabled while it is off (null = always on). */
+    bool (*enabled)(const LiveConfig &) = nullptr;
+
+    RouteHandler handler;
+  };
+
+  /** @brief Mount `spec` on the registration's App and on its admin socket, if any. */
+  void mount_route(Registration &reg, RouteSpec spec);
+
+  /** @brief Send a reply on the App (a stream is gathered first). */
+  void send_reply(vix::http::ResponseWrapper &res, RouteReply &out);
+
+  /** @brief 503 draining reply, with retry-after and a hint. */
+  void reply_draining(RouteReply &out);
+
+  /** @brief Route toggled off through PATCH /config (it stays mounted). */
+  void reply_route_disabled(RouteReply &out);
+
+  /** @brief Reply with a JSON document. */
+  void reply_json(RouteReply &out, int status, const vix::json::Json &body);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_ROUTE_TABLE_HPP
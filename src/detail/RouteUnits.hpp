@@ -0,0 +1,191 @@
+/**
+ *
+ *  @file RouteUnits.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_ROUTE_UNITS_HPP
+#define VIX_P2P_HTTP_DETAIL_ROUTE_UNITS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <vix/json/json.hpp>
+#include <vix/p2p/P2P.hpp>
+#include <vix/p2p_http/Features.hpp>
+#include <vix/p2p_http/P2PHttp.hpp>
+#include <vix/p2p_http/P2PHttpOptions.hpp>
+
+#include "RowExport.hpp"
+
+namespace vix
+{
+  class App;
+}
+
+namespace vix::p2p_http::detail
+{
+  class LocalHttpServer;
+
+  // Runtimes served by the routes: one unnamed entry for registerRoutes(),
+  // or the named set given to registerRuntimes().
+  using RuntimeSet = std::vector<NamedRuntime>;
+  using RuntimeSetPtr = std::shared_ptr<const RuntimeSet>;
+
+  /**
+   * @brief One registration, handed to each selected route unit in turn.
+   *
+   * Units live in their own translation units (P2PHttp{Core,Logs,Peers,
+   * Admin,Otlp,Statsd,LogFile}.cpp). The core never names the others:
+   * they plug into it through UnitHooks, so an unselected unit is not
+   * linked in.
+   */
+  class Registration
+  {
+  public:
+    Registration(vix::App &a, RuntimeSetPtr r, const P2PHttpOptions &o, bool per_rt);
+
+    vix::App &app;
+    RuntimeSetPtr rts;
+    P2PHttpOptions opt;
+
+    /** @brief Resolved prefix ("/p2p" by default). */
+    std::string base;
+
+    /** @brief registerRuntimes(): also mount {prefix}/rt/{name}/... routes. */
+    bool per_runtime = false;
+
+    /** @brief Admin socket to add routes to; null when it is disabled. */
+    LocalHttpServer *socket = nullptr;
+  };
+
+  /** @brief A file of GET /admin/bundle; `produce` runs after the capture. */
+  struct BundleFile
+  {
+    std::string name;
+
+    /** @brief Manifest entry: key and row count (-1: not captured). */
+    std::string manifest_key;
+    long long count = -1;
+
+    /** @brief Null: listed in the manifest only. */
+    std::function<bool(const ChunkSink &)> produce;
+  };
+
+  /**
+   * @brief Callbacks a route unit installs into the core.
+   *
+   * Installed once per unit with a static lifetime; every member is optional.
+   */
+  struct UnitHooks
+  {
+    /** @brief Buffer for lines of the module itself (the logs unit's ring). */
+    std::function<void(std::string)> log;
+
+    /** @brief Sees every module line before it is routed (exporters). */
+    std::function<void(std::string_view)> tap;
+
+    /** @brief Stats ticker iteration, after the history sample (emitters). */
+    std::function<void(const RuntimeSet &)> tick;
+
+    /** @brief Lazy mode: a request touched logs or runtime state. */
+    std::function<void()> touch;
+
+    /** @brief Lazy mode: the ticker idled down; drop what can be rebuilt. */
+    std::function<void()> idle;
+
+    std::function<void(const RuntimeSet &)> warm_up;
+
+    /** @brief Extra GET /status fields. */
+    std::function<void(vix::json::Json &)> status;
+
+    std::function<void()> shutdown;
+
+    /** @brief Drain switched on or off (release parked long polls). */
+    std::function<void(bool)> drain;
+
+    /** @brief Capture this unit's part of GET /admin/bundle. */
+    std::function<void(const RuntimeSet &, std::vector<BundleFile> &)> bundle;
+  };
+
+  /** @brief Units plugging into the core, in hook order. */
+  enum class Unit
+  {
+    Peers,
+    Logs,
+    Otlp,
+    Statsd,
+    LogFile,
+    Count,
+  };
+
+  void install_unit(Unit unit, const UnitHooks *hooks);
+
+  // ---- core services (P2PHttpCore.cpp) --------------------------------
+
+  /**
+   * @brief Module log line: external sink, else the logs unit's ring.
+   *
+   * Unit taps see the line first, whichever way it goes.
+   */
+  void log_line(std::string line);
+
+  /** @brief As log_line(), but `opt->log_sink` comes first when set. */
+  void push_log(const P2PHttpOptions *opt, std::string line);
+
+  /** @brief Lazy mode: called by the routes that read logs or runtime state. */
+  void lazy_touch();
+  bool lazy_enabled();
+
+  /** @brief True once lazy_idle_ms passed without lazy_touch(). */
+  bool lazy_idle_expired();
+
+  /** @brief Run the units' idle hooks (stats ticker, when it idles down). */
+  void lazy_release();
+
+  /** @brief Run the units' tick hooks (stats ticker, every iteration). */
+  void tick_units(const RuntimeSet &set);
+
+  void add_stats(vix::p2p::RuntimeStats &sum, const vix::p2p::RuntimeStats &st);
+  vix::p2p::RuntimeStats total_stats(const RuntimeSet &set);
+
+  /**
+   * @brief Hash of the runtimes' counters and the drain flag.
+   *
+   * Changes when peers connect, drop or handshake; tells whether a body
+   * built at warm-up still describes the node.
+   */
+  std::uint64_t runtime_change_mark(const RuntimeSet &set);
+
+  /** @brief GET /status body. */
+  std::string build_status_body(const RuntimeSet &set);
+
+  /** @brief GET /admin/bundle files contributed by the installed units. */
+  std::vector<BundleFile> capture_unit_bundles(const RuntimeSet &set);
+
+  long long steady_now_ms();
+  long long wall_now_ms();
+
+  bool parse_u64(const std::string &text, std::uint64_t &out);
+
+  /**
+   * @brief ?format= of /peers and /logs.
+   *
+   * "" or "json" keeps the JSON reply (`exporting` false), ndjson/csv select
+   * a line export. 400 with `body` when unknown.
+   */
+  int export_format_from_query(const std::string &text, bool &exporting, ExportFormat &format, std::string &body);
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_ROUTE_UNITS_HPP
@@ -0,0 +1,149 @@
+/**
+ *
+ *  @file RowExport.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "RowExport.hpp"
+#include "JsonWrite.hpp"
+
+#include <utility>
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    // RFC 4180: quote fields holding a separator, quote or line break.
+    void append_csv(std::string &out, std::string_view s)
+    {
+      if (s.find_first_of(",\"\r\n") == std::string_view::npos)
+      {
+        out.append(s);
+        return;
+      }
+
+      out.push_back('"');
+      for (const char c : s)
+      {
+        if (c == '"')
+          out.push_back('"');
+        out.push_back(c);
+      }
+      out.push_back('"');
+    }
+  }
+
+  bool parse_export_format(std::string_view text, ExportFormat &out) noexcept
+  {
+    if (text == "ndjson")
+      out = ExportFormat::Ndjson;
+    else if (text == "csv")
+      out = ExportFormat::Csv;
+    else
+      return false;
+    return true;
+  }
+
+  const char *export_content_type(ExportFormat f) noexcept
+  {
+    return f == ExportFormat::Csv ? "text/csv; charset=utf-8" : "application/x-ndjson";
+  }
+
+  ExportWriter::ExportWriter(ExportFormat format, std::vector<std::string_view> columns, ChunkSink sink,
+                             std::size_t flush_bytes)
+      : format_(format),
+        columns_(std::move(columns)),
+        sink_(std::move(sink)),
+        flush_bytes_(flush_bytes)
+  {
+    buf_.reserve(flush_bytes_ + 1024);
+
+    if (format_ == ExportFormat::Csv)
+    {
+      for (std::size_t i = 0; i < columns_.size(); ++i)
+      {
+        if (i)
+          buf_.push_back(',');
+        append_csv(buf_, columns_[i]);
+      }
+      buf_.append("\r\n");
+    }
+  }
+
+  void ExportWriter::begin_row()
+  {
+    col_ = 0;
+    if (format_ == ExportFormat::Ndjson)
+      buf_.push_back('{');
+  }
+
+  void ExportWriter::separator()
+  {
+    if (format_ == ExportFormat::Csv)
+    {
+      if (col_)
+        buf_.push_back(',');
+    }
+    else
+    {
+      if (col_)
+        buf_.push_back(',');
+      append_json_string(buf_, col_ < columns_.size() ? columns_[col_] : std::string_view{});
+      buf_.push_back(':');
+    }
+    ++col_;
+  }
+
+  void ExportWriter::field_str(std::string_view v)
+  {
+    separator();
+    if (format_ == ExportFormat::Csv)
+      append_csv(buf_, v);
+    else
+      append_json_string(buf_, v);
+  }
+
+  void ExportWriter::field_int(long long v)
+  {
+    separator();
+    append_json_int(buf_, v);
+  }
+
+  void ExportWriter::field_bool(bool v)
+  {
+    separator();
+    append_json_bool(buf_, v);
+  }
+
+  void ExportWriter::end_row()
+  {
+    buf_.append(format_ == ExportFormat::Csv ? "\r\n" : "}\n");
+    ++rows_;
+  }
+
+  bool ExportWriter::flush()
+  {
+    if (ok_ && !buf_.empty())
+      ok_ = sink_(buf_);
+    buf_.clear();
+    return ok_;
+  }
+
+  bool ExportWriter::flush_if_full()
+  {
+    return buf_.size() < flush_bytes_ ? ok_ : flush();
+  }
+
+  bool ExportWriter::finish()
+  {
+    return flush();
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,91 @@
+/**
+ *
+ *  @file RowExport.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_ROW_EXPORT_HPP
+#define VIX_P2P_HTTP_DETAIL_ROW_EXPORT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vix::p2p_http::detail
+{
+  /** @brief Line-oriented export layouts (?format=). */
+  enum class ExportFormat
+  {
+    Ndjson,
+    Csv,
+  };
+
+  /** @brief Parses "ndjson" or "csv". */
+  bool parse_export_format(std::string_view text, ExportFormat &out) noexcept;
+
+  /** @brief Content type for the layout. */
+  const char *export_content_type(ExportFormat f) noexcept;
+
+  /** @brief Receives output blocks; returns false to stop (client gone). */
+  using ChunkSink = std::function<bool(std::string_view)>;
+
+  /**
+   * @brief Row-at-a-time NDJSON/CSV writer over a ChunkSink.
+   *
+   * Rows are appended to a small buffer that is handed to the sink once it
+   * passes `flush_bytes`, so memory stays bounded whatever the row count.
+   * Fields are written in the column order given to the constructor; CSV
+   * gets a header line, NDJSON one object per line.
+   */
+  class ExportWriter
+  {
+  public:
+    ExportWriter(ExportFormat format, std::vector<std::string_view> columns, ChunkSink sink,
+                 std::size_t flush_bytes = 16 * 1024);
+
+    void begin_row();
+    void field_str(std::string_view v);
+    void field_int(long long v);
+    void field_bool(bool v);
+    void end_row();
+
+    /**
+     * @brief Pass the buffer to the sink once it is full.
+     *
+     * Call between rows, outside any lock that writers of the source need:
+     * the sink may block on a slow client.
+     * @return false once the sink refused a block.
+     */
+    bool flush_if_full();
+
+    /** @brief Pass what is left to the sink. */
+    bool finish();
+
+    bool ok() const noexcept { return ok_; }
+    std::size_t rows() const noexcept { return rows_; }
+
+  private:
+    void separator();
+    bool flush();
+
+    ExportFormat format_;
+    std::vector<std::string_view> columns_;
+    ChunkSink sink_;
+    std::size_t flush_bytes_;
+    std::string buf_;
+    std::size_t col_ = 0;
+    std::size_t rows_ = 0;
+    bool ok_ = true;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_ROW_EXPORT_HPP
@@ -0,0 +1,89 @@
+/**
+ *
+ *  @file ScratchArena.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "ScratchArena.hpp"
+
+#include <atomic>
+#include <memory>
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    std::atomic<std::uint64_t> g_spills{0};
+
+    // new/delete, counting every upstream allocation.
+    class SpillResource final : public std::pmr::memory_resource
+    {
+    private:
+      void *do_allocate(std::size_t bytes, std::size_t align) override
+      {
+        g_spills.fetch_add(1, std::memory_order_relaxed);
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+      }
+
+      void do_deallocate(void *p, std::size_t bytes, std::size_t align) override
+      {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+      }
+
+      bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+      {
+        return this == &other;
+      }
+    };
+
+    SpillResource g_spill_resource;
+
+    struct ThreadBlock
+    {
+      std::unique_ptr<std::byte[]> bytes;
+      bool in_use = false;
+    };
+
+    thread_local ThreadBlock t_block;
+
+    bool claim_block() noexcept
+    {
+      if (t_block.in_use)
+        return false;
+      if (!t_block.bytes)
+        t_block.bytes.reset(new (std::nothrow) std::byte[ScratchArena::k_block_bytes]);
+      if (!t_block.bytes)
+        return false;
+      t_block.in_use = true;
+      return true;
+    }
+  }
+
+  ScratchArena::ScratchArena()
+      : owns_block_(claim_block()),
+        mono_(owns_block_
+                  ? std::pmr::monotonic_buffer_resource(t_block.bytes.get(), k_block_bytes, &g_spill_resource)
+                  : std::pmr::monotonic_buffer_resource(&g_spill_resource))
+  {
+  }
+
+  ScratchArena::~ScratchArena()
+  {
+    mono_.release();
+    if (owns_block_)
+      t_block.in_use = false;
+  }
+
+  std::uint64_t scratch_spills() noexcept
+  {
+    return g_spills.load(std::memory_order_relaxed);
+  }
+} // namespace vix::p2p_http::detail
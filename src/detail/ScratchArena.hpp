@@ -0,0 +1,56 @@
+/**
+ *
+ *  @file ScratchArena.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_SCRATCH_ARENA_HPP
+#define VIX_P2P_HTTP_DETAIL_SCRATCH_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Per-request monotonic arena over a reusable thread-local block.
+   *
+   * Handler temporaries (sort order, formatted endpoints, ...) are carved
+   * from a 64 KiB block owned by the worker thread and released in one step
+   * when the arena goes out of scope. Only requests that outgrow the block
+   * reach the heap; those spills are counted.
+   *
+   * Nested arenas on the same thread fall back to a heap-backed monotonic
+   * resource instead of sharing the block.
+   */
+  class ScratchArena
+  {
+  public:
+    static constexpr std::size_t k_block_bytes = 64 * 1024;
+
+    ScratchArena();
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    std::pmr::memory_resource *resource() noexcept { return &mono_; }
+
+  private:
+    bool owns_block_;
+    std::pmr::monotonic_buffer_resource mono_;
+  };
+
+  /** @brief Upstream allocations made by arenas that outgrew their block. */
+  std::uint64_t scratch_spills() noexcept;
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_SCRATCH_ARENA_HPP
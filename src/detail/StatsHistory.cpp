@@ -0,0 +1,93 @@
+/**
+ *
+ *  @file StatsHistory.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "StatsHistory.hpp"
+
+#include <algorithm>
+
+namespace vix::p2p_http::detail
+{
+  void StatsHistory::push(const StatsSample &s)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (ring_.size() < cap_)
+    {
+      ring_.push_back(s);
+      return;
+    }
+    ring_[head_] = s;
+    head_ = (head_ + 1) % cap_;
+  }
+
+  std::vector<StatsSample> StatsHistory::snapshot() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<StatsSample> out;
+    out.reserve(ring_.size());
+    for (std::size_t i = 0; i < ring_.size(); ++i)
+      out.push_back(ring_[(head_ + i) % ring_.size()]);
+    return out;
+  }
+
+  void StatsHistory::set_capacity(std::size_t cap)
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    configured_ = (cap == 0 ? 1 : cap);
+    resize_locked(std::min(configured_, budget_cap_));
+  }
+
+  std::size_t StatsHistory::bytes() const
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    return ring_.capacity() * sizeof(StatsSample);
+  }
+
+  std::size_t StatsHistory::shrink(std::size_t want)
+  {
+    constexpr std::size_t k_min_samples = 16;
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (cap_ <= k_min_samples)
+      return 0;
+
+    const std::size_t before = ring_.capacity() * sizeof(StatsSample);
+    const std::size_t drop = std::min(cap_ - k_min_samples, want / sizeof(StatsSample) + 1);
+    budget_cap_ = cap_ - drop;
+    resize_locked(budget_cap_);
+    ring_.shrink_to_fit();
+
+    const std::size_t after = ring_.capacity() * sizeof(StatsSample);
+    return before > after ? before - after : 0;
+  }
+
+  void StatsHistory::relax()
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    budget_cap_ = static_cast<std::size_t>(-1);
+    resize_locked(configured_);
+  }
+
+  void StatsHistory::resize_locked(std::size_t cap)
+  {
+    cap = (cap == 0 ? 1 : cap);
+
+    // Linearize oldest-first, then keep the newest samples that fit.
+    std::rotate(ring_.begin(), ring_.begin() + static_cast<std::ptrdiff_t>(head_), ring_.end());
+    head_ = 0;
+    if (ring_.size() > cap)
+      ring_.erase(ring_.begin(), ring_.begin() + static_cast<std::ptrdiff_t>(ring_.size() - cap));
+
+    cap_ = cap;
+  }
+} // namespace vix::p2p_http::detail
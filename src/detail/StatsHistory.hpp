@@ -0,0 +1,68 @@
+/**
+ *
+ *  @file StatsHistory.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_STATS_HISTORY_HPP
+#define VIX_P2P_HTTP_DETAIL_STATS_HISTORY_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <vix/p2p/P2P.hpp>
+
+namespace vix::p2p_http::detail
+{
+  /** @brief Summed runtime counters at one tick. */
+  struct StatsSample
+  {
+    /** @brief Wall clock, milliseconds since the epoch. */
+    long long ts_ms = 0;
+    vix::p2p::RuntimeStats stats{};
+  };
+
+  /**
+   * @brief Fixed-size ring of the latest stats samples.
+   *
+   * Filled by the stats ticker on every tick, so its span is
+   * capacity * stats_every_ms. Read by the diagnostic bundle.
+   */
+  class StatsHistory
+  {
+  public:
+    explicit StatsHistory(std::size_t cap = 600) : cap_(cap == 0 ? 1 : cap), configured_(cap_) {}
+
+    void push(const StatsSample &s);
+
+    /** @brief Samples, oldest first. */
+    std::vector<StatsSample> snapshot() const;
+
+    void set_capacity(std::size_t cap);
+
+    // Memory budget hooks, as for the log ring.
+    std::size_t bytes() const;
+    std::size_t shrink(std::size_t want);
+    void relax();
+
+  private:
+    void resize_locked(std::size_t cap);
+
+    std::size_t cap_;
+    std::size_t configured_;
+    std::size_t budget_cap_ = static_cast<std::size_t>(-1);
+    mutable std::mutex mu_;
+    std::vector<StatsSample> ring_;
+    std::size_t head_ = 0;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_STATS_HISTORY_HPP
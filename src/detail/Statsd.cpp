@@ -0,0 +1,243 @@
+/**
+ *
+ *  @file Statsd.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "Statsd.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VIX_P2P_HTTP_HAS_UDP_SOCKETS 1
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace vix::p2p_http::detail
+{
+  StatsdPacker::StatsdPacker(std::size_t max_datagram)
+      : max_(std::max<std::size_t>(max_datagram, 64))
+  {
+  }
+
+  void StatsdPacker::reset() noexcept
+  {
+    buf_.clear();
+    ends_.clear();
+  }
+
+  void StatsdPacker::add(std::initializer_list<std::string_view> name, long long value, char type)
+  {
+    line_.clear();
+    for (const std::string_view part : name)
+    {
+      if (part.empty())
+        continue;
+      if (!line_.empty())
+        line_.push_back('.');
+      line_.append(part);
+    }
+
+    char num[24];
+    const auto r = std::to_chars(num, num + sizeof(num), value);
+    line_.push_back(':');
+    line_.append(num, r.ptr);
+    line_.push_back('|');
+    line_.push_back(type);
+
+    // Open a new datagram when the line does not fit in the current one.
+    // A line longer than max_ still goes out, alone.
+    const std::size_t start = ends_.empty() ? 0 : ends_.back();
+    const std::size_t used = buf_.size() - start;
+    if (ends_.empty() || used + 1 + line_.size() > max_)
+    {
+      buf_.append(line_);
+      ends_.push_back(buf_.size());
+      return;
+    }
+
+    buf_.push_back('\n');
+    buf_.append(line_);
+    ends_.back() = buf_.size();
+  }
+
+  std::string_view StatsdPacker::datagram(std::size_t i) const noexcept
+  {
+    const std::size_t begin = i == 0 ? 0 : ends_[i - 1];
+    return std::string_view(buf_).substr(begin, ends_[i] - begin);
+  }
+
+  UdpSender::~UdpSender()
+  {
+    close();
+  }
+
+#if defined(VIX_P2P_HTTP_HAS_UDP_SOCKETS)
+  bool UdpSender::open(const std::string &host, int port, std::string &error)
+  {
+    close();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *res = nullptr;
+    const std::string service = std::to_string(port);
+    if (const int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &res); rc != 0)
+    {
+      error = std::string("resolve_failed: ") + ::gai_strerror(rc);
+      return false;
+    }
+
+    error = "connect_failed";
+    for (addrinfo *ai = res; ai; ai = ai->ai_next)
+    {
+      const int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0)
+        continue;
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+      if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+      {
+        fd_ = fd;
+        break;
+      }
+      error = std::string("connect_failed: ") + std::strerror(errno);
+      ::close(fd);
+    }
+    ::freeaddrinfo(res);
+
+    if (fd_ >= 0)
+      error.clear();
+    return fd_ >= 0;
+  }
+
+  void UdpSender::close() noexcept
+  {
+    if (fd_ >= 0)
+      ::close(fd_);
+    fd_ = -1;
+  }
+
+  UdpSendResult UdpSender::send(const StatsdPacker &packer)
+  {
+    UdpSendResult r;
+    const std::size_t n = packer.datagrams();
+    if (fd_ < 0)
+    {
+      r.dropped = n;
+      r.error = "not_open";
+      return r;
+    }
+
+    std::size_t i = 0;
+    bool refused_once = false;
+    auto fail = [&](int err)
+    {
+      // ECONNREFUSED reports an ICMP error from an earlier datagram (no
+      // agent listening then); the current one was not sent, retry it once.
+      if (err == EINTR)
+        return;
+      if (err == ECONNREFUSED && !refused_once)
+      {
+        refused_once = true;
+        return;
+      }
+      if (r.error.empty())
+        r.error = std::strerror(err);
+      // EAGAIN: socket buffer full. Anything else: drop this one and go on.
+      if (err == EAGAIN || err == EWOULDBLOCK)
+      {
+        r.dropped += n - i;
+        i = n;
+      }
+      else
+      {
+        ++r.dropped;
+        ++i;
+      }
+    };
+
+#if defined(__linux__)
+    constexpr std::size_t k_batch = 64;
+    mmsghdr msgs[k_batch];
+    iovec iov[k_batch];
+
+    while (i < n)
+    {
+      const std::size_t count = std::min(k_batch, n - i);
+      for (std::size_t k = 0; k < count; ++k)
+      {
+        const std::string_view d = packer.datagram(i + k);
+        iov[k].iov_base = const_cast<char *>(d.data());
+        iov[k].iov_len = d.size();
+        msgs[k] = mmsghdr{};
+        msgs[k].msg_hdr.msg_iov = &iov[k];
+        msgs[k].msg_hdr.msg_iovlen = 1;
+      }
+
+      ++r.syscalls;
+      const int rc = ::sendmmsg(fd_, msgs, (unsigned)count, MSG_DONTWAIT);
+      if (rc < 0)
+      {
+        fail(errno);
+        continue;
+      }
+      for (int k = 0; k < rc; ++k)
+        r.bytes += msgs[k].msg_len;
+      r.sent += (std::size_t)rc;
+      i += (std::size_t)rc;
+    }
+#else
+    int flags = 0;
+#if defined(MSG_DONTWAIT)
+    flags |= MSG_DONTWAIT;
+#endif
+    while (i < n)
+    {
+      const std::string_view d = packer.datagram(i);
+      ++r.syscalls;
+      const ssize_t rc = ::send(fd_, d.data(), d.size(), flags);
+      if (rc < 0)
+      {
+        fail(errno);
+        continue;
+      }
+      r.bytes += (std::size_t)rc;
+      ++r.sent;
+      ++i;
+    }
+#endif
+    return r;
+  }
+#else
+  bool UdpSender::open(const std::string &, int, std::string &error)
+  {
+    error = "udp sockets are not supported on this platform";
+    return false;
+  }
+
+  void UdpSender::close() noexcept {}
+
+  UdpSendResult UdpSender::send(const StatsdPacker &packer)
+  {
+    UdpSendResult r;
+    r.dropped = packer.datagrams();
+    r.error = "not_open";
+    return r;
+  }
+#endif
+} // namespace vix::p2p_http::detail
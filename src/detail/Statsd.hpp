@@ -0,0 +1,99 @@
+/**
+ *
+ *  @file Statsd.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_STATSD_HPP
+#define VIX_P2P_HTTP_DETAIL_STATSD_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Packs StatsD lines into datagrams of at most `max_datagram` bytes.
+   *
+   * All datagrams share one buffer and are separated by recorded offsets;
+   * lines within a datagram are joined by '\n'. The buffer keeps its
+   * capacity across reset(), so a warm packer does not allocate.
+   */
+  class StatsdPacker
+  {
+  public:
+    explicit StatsdPacker(std::size_t max_datagram = 1432);
+
+    void reset() noexcept;
+
+    /**
+     * @brief Append "a.b.c:value|type"; empty name parts are skipped.
+     *
+     * `type` is 'c' (counter delta) or 'g' (gauge). Gauges must not be
+     * negative: StatsD reads a signed gauge as an adjustment.
+     */
+    void add(std::initializer_list<std::string_view> name, long long value, char type);
+
+    std::size_t datagrams() const noexcept { return ends_.size(); }
+    std::string_view datagram(std::size_t i) const noexcept;
+
+    /** @brief Payload bytes over all datagrams. */
+    std::size_t bytes() const noexcept { return buf_.size(); }
+
+  private:
+    std::size_t max_;
+    std::string buf_;
+    std::string line_;
+    std::vector<std::size_t> ends_;
+  };
+
+  /** @brief Result of one UdpSender::send(). */
+  struct UdpSendResult
+  {
+    std::size_t sent = 0;
+    std::size_t dropped = 0;
+    std::size_t bytes = 0;
+    std::size_t syscalls = 0;
+
+    /** @brief errno text of the first failure (empty when none). */
+    std::string error;
+  };
+
+  /**
+   * @brief Connected, non-blocking UDP socket sending packed datagrams.
+   *
+   * On Linux each send() hands every datagram to the kernel with
+   * sendmmsg(), 64 per call; elsewhere it is one send() per datagram.
+   * A full socket buffer never blocks: what does not fit is dropped.
+   */
+  class UdpSender
+  {
+  public:
+    UdpSender() = default;
+    ~UdpSender();
+
+    UdpSender(const UdpSender &) = delete;
+    UdpSender &operator=(const UdpSender &) = delete;
+
+    bool open(const std::string &host, int port, std::string &error);
+    void close() noexcept;
+    bool is_open() const noexcept { return fd_ >= 0; }
+
+    UdpSendResult send(const StatsdPacker &packer);
+
+  private:
+    int fd_ = -1;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_STATSD_HPP
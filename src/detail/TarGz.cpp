@@ -0,0 +1,202 @@
+/**
+ *
+ *  @file TarGz.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "TarGz.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    constexpr std::size_t k_block = 512;
+    constexpr char k_zero_block[k_block] = {};
+
+    // Right-aligned, zero-padded octal in `width - 1` digits plus NUL.
+    void put_octal(char *field, std::size_t width, std::uint64_t v)
+    {
+      field[width - 1] = '\0';
+      for (std::size_t i = width - 1; i-- > 0;)
+      {
+        field[i] = static_cast<char>('0' + (v & 7));
+        v >>= 3;
+      }
+    }
+  }
+
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+  struct TarGzWriter::Codec
+  {
+    z_stream zs{};
+    std::size_t used = 0;
+  };
+
+  bool tar_gz_compressed() noexcept { return true; }
+#else
+  struct TarGzWriter::Codec
+  {
+  };
+
+  bool tar_gz_compressed() noexcept { return false; }
+#endif
+
+  TarGzWriter::TarGzWriter(ChunkSink sink, std::size_t out_bytes)
+      : sink_(std::move(sink)),
+        codec_(std::make_unique<Codec>()),
+        out_bytes_(out_bytes == 0 ? 16 * 1024 : out_bytes)
+  {
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+    buf_.resize(out_bytes_);
+    // windowBits 15 + 16: gzip wrapper instead of zlib's.
+    ok_ = deflateInit2(&codec_->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+#else
+    buf_.reserve(out_bytes_);
+#endif
+  }
+
+  TarGzWriter::~TarGzWriter()
+  {
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+    deflateEnd(&codec_->zs);
+#endif
+  }
+
+  bool TarGzWriter::drain()
+  {
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+    const std::size_t n = codec_->used;
+    codec_->used = 0;
+#else
+    const std::size_t n = buf_.size();
+#endif
+    if (ok_ && n > 0)
+    {
+      out_ += n;
+      ok_ = sink_(std::string_view(buf_.data(), n));
+    }
+#if !defined(VIX_P2P_HTTP_WITH_ZLIB)
+    buf_.clear();
+#endif
+    return ok_;
+  }
+
+  bool TarGzWriter::put(const void *data, std::size_t n)
+  {
+    if (!ok_)
+      return false;
+    in_ += n;
+
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+    auto &zs = codec_->zs;
+    zs.next_in = static_cast<Bytef *>(const_cast<void *>(data));
+    zs.avail_in = static_cast<uInt>(n);
+    while (zs.avail_in > 0)
+    {
+      zs.next_out = reinterpret_cast<Bytef *>(buf_.data() + codec_->used);
+      zs.avail_out = static_cast<uInt>(out_bytes_ - codec_->used);
+      if (deflate(&zs, Z_NO_FLUSH) == Z_STREAM_ERROR)
+        return ok_ = false;
+      codec_->used = out_bytes_ - zs.avail_out;
+      if (codec_->used == out_bytes_ && !drain())
+        return false;
+    }
+    return ok_;
+#else
+    buf_.append(static_cast<const char *>(data), n);
+    return buf_.size() < out_bytes_ ? ok_ : drain();
+#endif
+  }
+
+  bool TarGzWriter::begin(std::string_view name, std::uint64_t size, long long mtime_s)
+  {
+    if (!ok_ || entry_left_ != 0 || name.empty() || name.size() > 100)
+      return ok_ = false;
+
+    char h[k_block] = {};
+    std::memcpy(h, name.data(), name.size());
+    std::memcpy(h + 100, "0000644", 8); // mode
+    std::memcpy(h + 108, "0000000", 8); // uid
+    std::memcpy(h + 116, "0000000", 8); // gid
+    put_octal(h + 124, 12, size);
+    put_octal(h + 136, 12, static_cast<std::uint64_t>(std::max(0LL, mtime_s)));
+    std::memset(h + 148, ' ', 8); // checksum counts as spaces
+    h[156] = '0';                 // regular file
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+
+    unsigned sum = 0;
+    for (const char c : h)
+      sum += static_cast<unsigned char>(c);
+    put_octal(h + 148, 7, sum);
+    h[155] = ' ';
+
+    entry_size_ = size;
+    entry_left_ = size;
+    return put(h, sizeof(h));
+  }
+
+  bool TarGzWriter::write(std::string_view data)
+  {
+    if (data.size() > entry_left_)
+      return ok_ = false;
+    entry_left_ -= data.size();
+    return put(data.data(), data.size());
+  }
+
+  bool TarGzWriter::end()
+  {
+    if (entry_left_ != 0)
+      return ok_ = false;
+
+    const std::size_t pad = static_cast<std::size_t>((k_block - entry_size_ % k_block) % k_block);
+    entry_size_ = 0;
+    return pad == 0 ? ok_ : put(k_zero_block, pad);
+  }
+
+  bool TarGzWriter::add(std::string_view name, std::string_view data, long long mtime_s)
+  {
+    return begin(name, data.size(), mtime_s) && write(data) && end();
+  }
+
+  bool TarGzWriter::finish()
+  {
+    if (!put(k_zero_block, k_block) || !put(k_zero_block, k_block))
+      return false;
+
+#if defined(VIX_P2P_HTTP_WITH_ZLIB)
+    auto &zs = codec_->zs;
+    zs.avail_in = 0;
+    for (;;)
+    {
+      zs.next_out = reinterpret_cast<Bytef *>(buf_.data() + codec_->used);
+      zs.avail_out = static_cast<uInt>(out_bytes_ - codec_->used);
+      const int rc = deflate(&zs, Z_FINISH);
+      if (rc == Z_STREAM_ERROR)
+        return ok_ = false;
+      codec_->used = out_bytes_ - zs.avail_out;
+      if (rc == Z_STREAM_END)
+        break;
+      if (!drain())
+        return false;
+    }
+#endif
+    return drain();
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,86 @@
+/**
+ *
+ *  @file TarGz.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_TAR_GZ_HPP
+#define VIX_P2P_HTTP_DETAIL_TAR_GZ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "RowExport.hpp"
+
+namespace vix::p2p_http::detail
+{
+  /** @brief True when archives are gzip-compressed (built with zlib). */
+  bool tar_gz_compressed() noexcept;
+
+  /**
+   * @brief Streaming ustar writer, gzip-compressed when zlib is available.
+   *
+   * Entries are written as they come and compressed output is handed to
+   * the sink in blocks of `out_bytes`; nothing else is retained. Each
+   * entry declares its size up front, as tar requires.
+   */
+  class TarGzWriter
+  {
+  public:
+    explicit TarGzWriter(ChunkSink sink, std::size_t out_bytes = 16 * 1024);
+    ~TarGzWriter();
+
+    TarGzWriter(const TarGzWriter &) = delete;
+    TarGzWriter &operator=(const TarGzWriter &) = delete;
+
+    /**
+     * @brief Start a regular file entry; exactly `size` bytes must follow.
+     * @param mtime_s Modification time, seconds since the epoch.
+     */
+    bool begin(std::string_view name, std::uint64_t size, long long mtime_s);
+    bool write(std::string_view data);
+
+    /** @brief Close the entry (pads it to the block size). */
+    bool end();
+
+    /** @brief begin() + write() + end(). */
+    bool add(std::string_view name, std::string_view data, long long mtime_s);
+
+    /** @brief End-of-archive blocks and compressor trailer. */
+    bool finish();
+
+    /** @brief False once the sink refused output or an entry size was wrong. */
+    bool ok() const noexcept { return ok_; }
+
+    std::uint64_t bytes_in() const noexcept { return in_; }
+    std::uint64_t bytes_out() const noexcept { return out_; }
+
+  private:
+    struct Codec;
+
+    bool put(const void *data, std::size_t n);
+    bool drain();
+
+    ChunkSink sink_;
+    std::unique_ptr<Codec> codec_;
+    std::string buf_;
+    std::size_t out_bytes_;
+    std::uint64_t entry_left_ = 0;
+    std::uint64_t entry_size_ = 0;
+    std::uint64_t in_ = 0;
+    std::uint64_t out_ = 0;
+    bool ok_ = true;
+  };
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_TAR_GZ_HPP
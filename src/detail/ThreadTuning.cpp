@@ -0,0 +1,213 @@
+/**
+ *
+ *  @file ThreadTuning.cpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+
+#include "ThreadTuning.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace J = vix::json;
+
+namespace vix::p2p_http::detail
+{
+  namespace
+  {
+    struct Applied
+    {
+      std::vector<int> cpus;
+      int nice = 0;
+      bool sched_batch = false;
+      std::string error;
+    };
+
+    // A thread inside a ThreadPolicyScope: it has not exited yet, so its
+    // handle is valid for as long as it is listed (under g_policy_mu).
+    struct Live
+    {
+      std::string name;
+#if defined(__linux__)
+      pthread_t handle{};
+      id_t tid = 0;
+#endif
+      Applied applied;
+    };
+
+    std::mutex g_policy_mu;
+    ThreadPolicy g_policy;
+    std::map<std::uint64_t, Live> g_live;
+    std::uint64_t g_next_live = 0;
+
+#if defined(__linux__)
+    bool pin_thread(pthread_t thread, const std::vector<int> &cpus, std::string *error)
+    {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (int cpu : cpus)
+      {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+        {
+          if (error)
+            *error = "cpu out of range: " + std::to_string(cpu);
+          return false;
+        }
+        CPU_SET(cpu, &set);
+      }
+
+      const int rc = pthread_setaffinity_np(thread, sizeof(set), &set);
+      if (rc != 0)
+      {
+        if (error)
+          *error = std::string("pthread_setaffinity_np: ") + std::strerror(rc);
+        return false;
+      }
+      return true;
+    }
+#endif
+
+    // Applies `p` to `t` (any thread, not only the caller) and reads back
+    // what the kernel kept.
+    Applied apply_to(const ThreadPolicy &p, const Live &t)
+    {
+      Applied a;
+
+#if defined(__linux__)
+      std::string error;
+      if (!p.cpus.empty() && !pin_thread(t.handle, p.cpus, &error))
+        a.error = error;
+
+      if (p.sched_batch)
+      {
+        sched_param sp{};
+        const int rc = pthread_setschedparam(t.handle, SCHED_BATCH, &sp);
+        if (rc != 0 && a.error.empty())
+          a.error = std::string("SCHED_BATCH: ") + std::strerror(rc);
+      }
+
+      // Per-thread on Linux: the "process" priority of a tid is the thread's.
+      if (p.nice != 0 && ::setpriority(PRIO_PROCESS, t.tid, p.nice) != 0 && a.error.empty())
+        a.error = std::string("setpriority: ") + std::strerror(errno);
+
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      if (pthread_getaffinity_np(t.handle, sizeof(set), &set) == 0)
+      {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+          if (CPU_ISSET(cpu, &set))
+            a.cpus.push_back(cpu);
+        }
+      }
+
+      errno = 0;
+      a.nice = ::getpriority(PRIO_PROCESS, t.tid);
+
+      int policy = 0;
+      sched_param sp{};
+      a.sched_batch = (pthread_getschedparam(t.handle, &policy, &sp) == 0 && policy == SCHED_BATCH);
+#else
+      (void)t;
+      if (!p.cpus.empty())
+        a.error = "thread affinity is not supported on this platform";
+      if ((p.sched_batch || p.nice != 0) && a.error.empty())
+        a.error = "thread priority is not supported on this platform";
+#endif
+      return a;
+    }
+  }
+
+  bool pin_current_thread(const std::vector<int> &cpus, std::string *error)
+  {
+    if (cpus.empty())
+      return true;
+
+#if defined(__linux__)
+    return pin_thread(pthread_self(), cpus, error);
+#else
+    if (error)
+      *error = "thread affinity is not supported on this platform";
+    return false;
+#endif
+  }
+
+  void set_thread_policy(ThreadPolicy p)
+  {
+    std::lock_guard<std::mutex> lk(g_policy_mu);
+    g_policy = std::move(p);
+    for (auto &[id, t] : g_live)
+      t.applied = apply_to(g_policy, t);
+  }
+
+  ThreadPolicy thread_policy()
+  {
+    std::lock_guard<std::mutex> lk(g_policy_mu);
+    return g_policy;
+  }
+
+  ThreadPolicyScope::ThreadPolicyScope(std::string name)
+  {
+    Live t;
+    t.name = std::move(name);
+#if defined(__linux__)
+    t.handle = pthread_self();
+    t.tid = static_cast<id_t>(::syscall(SYS_gettid));
+#endif
+
+    std::lock_guard<std::mutex> lk(g_policy_mu);
+    t.applied = apply_to(g_policy, t);
+    id_ = ++g_next_live;
+    g_live.emplace(id_, std::move(t));
+  }
+
+  ThreadPolicyScope::~ThreadPolicyScope()
+  {
+    std::lock_guard<std::mutex> lk(g_policy_mu);
+    g_live.erase(id_);
+  }
+
+  J::Json thread_policy_json()
+  {
+    std::lock_guard<std::mutex> lk(g_policy_mu);
+
+    J::Json threads = J::Json::object();
+    for (const auto &[id, t] : g_live)
+    {
+      const Applied &a = t.applied;
+      threads[t.name] = J::Json{
+          {"cpus", a.cpus},
+          {"nice", a.nice},
+          {"sched_batch", a.sched_batch},
+          {"error", a.error},
+      };
+    }
+
+    return J::Json{
+        {"cpus", g_policy.cpus},
+        {"nice", g_policy.nice},
+        {"sched_batch", g_policy.sched_batch},
+        {"applied", std::move(threads)},
+    };
+  }
+} // namespace vix::p2p_http::detail
@@ -0,0 +1,79 @@
+/**
+ *
+ *  @file ThreadTuning.hpp
+ *  @author Gaspard Kirira
+ *
+ *  Copyright 2025, Gaspard Kirira.  All rights reserved.
+ *  https://github.com/vixcpp/vix
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Vix.cpp
+ *
+ */
+#ifndef VIX_P2P_HTTP_DETAIL_THREAD_TUNING_HPP
+#define VIX_P2P_HTTP_DETAIL_THREAD_TUNING_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vix/json/json.hpp>
+
+namespace vix::p2p_http::detail
+{
+  /**
+   * @brief Pin the calling thread to `cpus` (no-op when empty).
+   *
+   * Threads created afterwards by this thread inherit the mask on Linux.
+   * Returns false with `error` set when the mask cannot be applied or the
+   * platform has no thread affinity API.
+   */
+  bool pin_current_thread(const std::vector<int> &cpus, std::string *error = nullptr);
+
+  /** @brief Placement and priority for the module's own threads. */
+  struct ThreadPolicy
+  {
+    std::vector<int> cpus;
+    int nice = 0;
+    bool sched_batch = false;
+  };
+
+  /**
+   * @brief Set the module policy and apply it to every running module thread.
+   *
+   * Threads started before registration (e.g. KvStore sync) get it here;
+   * later ones get it from their ThreadPolicyScope. A field left empty or
+   * zero leaves running threads as they are.
+   */
+  void set_thread_policy(ThreadPolicy p);
+
+  ThreadPolicy thread_policy();
+
+  /**
+   * @brief Applies the module policy to the calling thread while it runs.
+   *
+   * Placed first thing in each p2p_http thread (ticker, watcher, admin
+   * socket, KV sync, ...). The thread is listed until the scope ends, so
+   * set_thread_policy() reaches it too. The affinity, nice value and
+   * scheduling class read back from the kernel are reported under `name`
+   * in /status.
+   */
+  class ThreadPolicyScope
+  {
+  public:
+    explicit ThreadPolicyScope(std::string name);
+    ~ThreadPolicyScope();
+
+    ThreadPolicyScope(const ThreadPolicyScope &) = delete;
+    ThreadPolicyScope &operator=(const ThreadPolicyScope &) = delete;
+
+  private:
+    std::uint64_t id_ = 0;
+  };
+
+  /** @brief Configured policy and what each running thread actually got. */
+  vix::json::Json thread_policy_json();
+} // namespace vix::p2p_http::detail
+
+#endif // VIX_P2P_HTTP_DETAIL_THREAD_TUNING_HPP